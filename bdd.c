@@ -0,0 +1,460 @@
+/*
+   Description::
+
+   Reduced ordered binary decision diagrams.
+
+   The nodes are managed as in zdd.c: they are kept in a single array
+   and addressed by their index, a node is created only if there is
+   no node with the same variable and children, and the nodes which
+   are not reachable from the functions in use are freed from time to
+   time by a mark and sweep collection (see collectBDD).
+
+   The operations are computed by the usual recursion on the top
+   variable, and their results are cached with the operation and the
+   arguments as a key.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "common.h"
+#include "bdd.h"
+
+
+/* Code */
+
+#define BDD_TERMINAL  0x7FFFFFFFU    /* Variable of the terminal nodes */
+#define BDD_FREE      0xFFFFFFFFU    /* Variable of the free nodes */
+#define BDD_MARK      0x80000000U    /* Nodes reached by a collection */
+
+/* End of a bucket and of the free list */
+#define BDD_NONE      BDD_FALSE
+
+/* Operations in the cache. The cofactors also encode the variable. */
+#define BDD_OP_AND        1U
+#define BDD_OP_OR         2U
+#define BDD_OP_DIFF       3U
+#define BDD_OP_NOT        4U
+#define BDD_OP_COFACTOR   8U    /* + 2*var + value */
+
+static inline size_t hashBDD(uint32_t var,BDDNode lo,BDDNode hi) {
+  uint64_t h = (uint64_t)var * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)lo * 0xC2B2AE3D27D4EB4FULL;
+  h ^= (uint64_t)hi * 0x165667B19E3779F9ULL;
+  return (size_t)(h ^ (h >> 29));
+}
+
+static inline Boolean isterminalBDD(BDDNode f) {
+  return f==BDD_FALSE || f==BDD_TRUE;
+}
+
+static inline uint32_t topBDD(const BDD *b,BDDNode f) {
+  return b->nodes[f].var;
+}
+
+
+/* Put all the nodes in use in the unique table again, e.g. after it
+   has been resized. */
+static void rehashBDD(BDD *b) {
+
+  for(size_t i=0;i<b->bucket_number;i++) b->buckets[i]=BDD_NONE;
+
+  for(size_t i=2;i<b->used;i++) {
+    BDDEntry *e=&b->nodes[i];
+    if (e->var==BDD_FREE) continue;
+    size_t k=hashBDD(e->var,e->lo,e->hi) & (b->bucket_number-1);
+    e->next = b->buckets[k];
+    b->buckets[k] = (BDDNode)i;
+  }
+}
+
+
+BDD *newBDD(size_t variables) {
+
+  assert(variables < BDD_TERMINAL/2);
+
+  BDD *b=(BDD*)malloc(sizeof(BDD));
+  assert(b);
+
+  b->variables = variables;
+
+  b->allocation = BDD_MIN_ALLOCATION;
+  b->nodes = (BDDEntry*)malloc(b->allocation*sizeof(BDDEntry));
+  assert(b->nodes);
+
+  /* The two terminals */
+  for(size_t i=0;i<2;i++) {
+    b->nodes[i].var  = BDD_TERMINAL;
+    b->nodes[i].lo   = (BDDNode)i;
+    b->nodes[i].hi   = (BDDNode)i;
+    b->nodes[i].next = BDD_NONE;
+  }
+  b->used = 2;
+  b->size = 2;
+  b->peak = 2;
+  b->free_list = BDD_NONE;
+
+  b->bucket_number = BDD_MIN_ALLOCATION;
+  b->buckets = (BDDNode*)malloc(b->bucket_number*sizeof(BDDNode));
+  assert(b->buckets);
+  rehashBDD(b);
+
+  b->cache = (BDDCacheEntry*)calloc(b->bucket_number,sizeof(BDDCacheEntry));
+  assert(b->cache);
+
+  b->collect_threshold = BDD_MIN_ALLOCATION;
+
+  return b;
+}
+
+
+void disposeBDD(BDD *b) {
+
+  assert(b);
+  free(b->cache);
+  free(b->buckets);
+  free(b->nodes);
+  free(b);
+}
+
+
+Boolean isconsistentBDD(const BDD *b) {
+
+  assert(b);
+  assert(b->nodes);
+  assert(b->buckets);
+  assert(b->size <= b->used);
+  assert(b->used <= b->allocation);
+  assert((b->bucket_number & (b->bucket_number-1))==0);
+
+#ifdef BDD_DEBUG
+  size_t counter=2;
+  for(size_t i=2;i<b->used;i++) {
+    const BDDEntry *e=&b->nodes[i];
+    if (e->var==BDD_FREE) continue;
+    counter++;
+    /* Reduced, and the variables grow from the root */
+    if (e->lo==e->hi) return FALSE;
+    if (e->var >= b->variables) return FALSE;
+    if (e->var >= b->nodes[e->lo].var) return FALSE;
+    if (e->var >= b->nodes[e->hi].var) return FALSE;
+  }
+  if (counter!=b->size) return FALSE;
+#endif
+  return TRUE;
+}
+
+
+/* The node with the given variable and children, which is created
+   if there is none. The array of nodes may move. */
+static BDDNode get_nodeBDD(BDD *b,uint32_t var,BDDNode lo,BDDNode hi) {
+
+  assert(var < b->variables);
+  assert(var < topBDD(b,lo));
+  assert(var < topBDD(b,hi));
+
+  /* The variable does not matter */
+  if (lo==hi) return lo;
+
+  size_t k=hashBDD(var,lo,hi) & (b->bucket_number-1);
+  for(BDDNode f=b->buckets[k]; f!=BDD_NONE; f=b->nodes[f].next) {
+    const BDDEntry *e=&b->nodes[f];
+    if (e->var==var && e->lo==lo && e->hi==hi) return f;
+  }
+
+  BDDNode f;
+  if (b->free_list!=BDD_NONE) {
+    f = b->free_list;
+    b->free_list = b->nodes[f].next;
+  } else {
+    if (b->used == b->allocation) {
+      if (b->allocation >= BDD_TERMINAL) {
+        fprintf(stderr,
+                "Error in search procedure: too many nodes "
+                "for the decision diagram.");
+        exit(EXIT_FAILURE);
+      }
+      b->allocation *= 2;
+      b->nodes = (BDDEntry*)realloc(b->nodes,b->allocation*sizeof(BDDEntry));
+      assert(b->nodes);
+    }
+    f = (BDDNode)(b->used++);
+  }
+
+  b->nodes[f].var  = var;
+  b->nodes[f].lo   = lo;
+  b->nodes[f].hi   = hi;
+  b->nodes[f].next = b->buckets[k];
+  b->buckets[k] = f;
+
+  b->size++;
+  b->peak = MAX(b->peak,b->size);
+
+  /* Keep the buckets short, and the cache as large */
+  if (b->size > 2*b->bucket_number) {
+    b->bucket_number *= 2;
+    b->buckets = (BDDNode*)realloc(b->buckets,b->bucket_number*sizeof(BDDNode));
+    assert(b->buckets);
+    rehashBDD(b);
+    free(b->cache);
+    b->cache = (BDDCacheEntry*)calloc(b->bucket_number,sizeof(BDDCacheEntry));
+    assert(b->cache);
+  }
+
+  return f;
+}
+
+
+/* Cached results. The cache may be reallocated by get_nodeBDD, so the
+   entry is looked up again to store a result. */
+static inline Boolean lookup_cacheBDD(const BDD *b,uint32_t op,BDDNode f,BDDNode g,BDDNode *result) {
+
+  const BDDCacheEntry *c=&b->cache[hashBDD(op,f,g) & (b->bucket_number-1)];
+  if (c->op!=op || c->a!=f || c->b!=g) return FALSE;
+  *result=c->result;
+  return TRUE;
+}
+
+static inline void store_cacheBDD(BDD *b,uint32_t op,BDDNode f,BDDNode g,BDDNode result) {
+
+  BDDCacheEntry *c=&b->cache[hashBDD(op,f,g) & (b->bucket_number-1)];
+  c->op=op;
+  c->a=f;
+  c->b=g;
+  c->result=result;
+}
+
+
+BDDNode varBDD(BDD *b,uint32_t var) {
+  return get_nodeBDD(b,var,BDD_FALSE,BDD_TRUE);
+}
+
+
+BDDNode notBDD(BDD *b,BDDNode f) {
+
+  if (f==BDD_FALSE) return BDD_TRUE;
+  if (f==BDD_TRUE)  return BDD_FALSE;
+
+  BDDNode r;
+  if (lookup_cacheBDD(b,BDD_OP_NOT,f,BDD_FALSE,&r)) return r;
+
+  BDDEntry e=b->nodes[f];   /* A copy, since the array may move */
+  BDDNode lo=notBDD(b,e.lo);
+  BDDNode hi=notBDD(b,e.hi);
+  r=get_nodeBDD(b,e.var,lo,hi);
+
+  store_cacheBDD(b,BDD_OP_NOT,f,BDD_FALSE,r);
+  return r;
+}
+
+
+/* The binary operations, by recursion on the top variable */
+static BDDNode applyBDD(BDD *b,uint32_t op,BDDNode f,BDDNode g) {
+
+  switch(op) {
+  case BDD_OP_AND:
+    if (f==BDD_FALSE || g==BDD_FALSE) return BDD_FALSE;
+    if (f==BDD_TRUE || f==g) return g;
+    if (g==BDD_TRUE) return f;
+    if (f > g) { BDDNode t=f; f=g; g=t; }   /* Commutes */
+    break;
+  case BDD_OP_OR:
+    if (f==BDD_TRUE || g==BDD_TRUE) return BDD_TRUE;
+    if (f==BDD_FALSE || f==g) return g;
+    if (g==BDD_FALSE) return f;
+    if (f > g) { BDDNode t=f; f=g; g=t; }   /* Commutes */
+    break;
+  case BDD_OP_DIFF:
+    if (f==BDD_FALSE || g==BDD_TRUE || f==g) return BDD_FALSE;
+    if (g==BDD_FALSE) return f;
+    if (f==BDD_TRUE) return notBDD(b,g);
+    break;
+  default:
+    assert(0);
+  }
+
+  BDDNode r;
+  if (lookup_cacheBDD(b,op,f,g,&r)) return r;
+
+  BDDEntry ef=b->nodes[f];
+  BDDEntry eg=b->nodes[g];
+  uint32_t var= (ef.var < eg.var) ? ef.var : eg.var;
+
+  BDDNode f0 = (ef.var==var) ? ef.lo : f;
+  BDDNode f1 = (ef.var==var) ? ef.hi : f;
+  BDDNode g0 = (eg.var==var) ? eg.lo : g;
+  BDDNode g1 = (eg.var==var) ? eg.hi : g;
+
+  BDDNode lo=applyBDD(b,op,f0,g0);
+  BDDNode hi=applyBDD(b,op,f1,g1);
+  r=get_nodeBDD(b,var,lo,hi);
+
+  store_cacheBDD(b,op,f,g,r);
+  return r;
+}
+
+BDDNode andBDD(BDD *b,BDDNode f,BDDNode g)  { return applyBDD(b,BDD_OP_AND,f,g); }
+BDDNode orBDD(BDD *b,BDDNode f,BDDNode g)   { return applyBDD(b,BDD_OP_OR,f,g); }
+BDDNode diffBDD(BDD *b,BDDNode f,BDDNode g) { return applyBDD(b,BDD_OP_DIFF,f,g); }
+
+
+BDDNode cofactorBDD(BDD *b,BDDNode f,uint32_t var,Boolean value) {
+
+  assert(var < b->variables);
+
+  BDDEntry e=b->nodes[f];
+  if (e.var > var) return f;      /* Terminals included */
+  if (e.var == var) return value ? e.hi : e.lo;
+
+  uint32_t op=BDD_OP_COFACTOR + 2*var + (value ? 1 : 0);
+  BDDNode r;
+  if (lookup_cacheBDD(b,op,f,BDD_FALSE,&r)) return r;
+
+  BDDNode lo=cofactorBDD(b,e.lo,var,value);
+  BDDNode hi=cofactorBDD(b,e.hi,var,value);
+  r=get_nodeBDD(b,e.var,lo,hi);
+
+  store_cacheBDD(b,op,f,BDD_FALSE,r);
+  return r;
+}
+
+
+BDDNode cubeBDD(BDD *b,const uint8_t *values) {
+
+  BDDNode r=BDD_TRUE;
+  for(size_t i=b->variables;i-- > 0;) {
+    r = values[i] ? get_nodeBDD(b,(uint32_t)i,BDD_FALSE,r)
+                  : get_nodeBDD(b,(uint32_t)i,r,BDD_FALSE);
+  }
+  return r;
+}
+
+
+Boolean satoneBDD(const BDD *b,BDDNode f,uint8_t *values) {
+
+  if (f==BDD_FALSE) return FALSE;
+
+  memset(values,0,b->variables);
+  while(!isterminalBDD(f)) {
+    const BDDEntry *e=&b->nodes[f];
+    /* A node has a satisfiable child, since it is reduced */
+    if (e->lo!=BDD_FALSE) { f=e->lo; }
+    else                  { values[e->var]=1; f=e->hi; }
+  }
+  assert(f==BDD_TRUE);
+  return TRUE;
+}
+
+
+/* The count `c' times two to the `e' */
+static inline double scaleBDD(double c,uint32_t e) {
+  while(e-- > 0) c *= 2.0;
+  return c;
+}
+
+/* Number of assignments of the variables from the one of `f' on.
+   The counts are kept in `memo', negative for the nodes not counted. */
+static double satcount_nodeBDD(const BDD *b,BDDNode f,double *memo) {
+
+  if (f==BDD_FALSE) return 0.0;
+  if (f==BDD_TRUE)  return 1.0;
+  if (memo[f] >= 0.0) return memo[f];
+
+  const BDDEntry *e=&b->nodes[f];
+  uint32_t lovar = isterminalBDD(e->lo) ? (uint32_t)b->variables : topBDD(b,e->lo);
+  uint32_t hivar = isterminalBDD(e->hi) ? (uint32_t)b->variables : topBDD(b,e->hi);
+
+  memo[f] = scaleBDD(satcount_nodeBDD(b,e->lo,memo),lovar-e->var-1)
+          + scaleBDD(satcount_nodeBDD(b,e->hi,memo),hivar-e->var-1);
+  return memo[f];
+}
+
+double satcountBDD(BDD *b,BDDNode f) {
+
+  assert(isconsistentBDD(b));
+
+  if (f==BDD_FALSE) return 0.0;
+  if (f==BDD_TRUE)  return scaleBDD(1.0,(uint32_t)b->variables);
+
+  double *memo=(double*)malloc(b->used*sizeof(double));
+  assert(memo);
+  for(size_t i=0;i<b->used;i++) memo[i]=-1.0;
+
+  double count=scaleBDD(satcount_nodeBDD(b,f,memo),topBDD(b,f));
+  free(memo);
+  return count;
+}
+
+
+/* Mark the nodes of the diagram of `f', and count the new ones */
+static size_t markBDD(BDD *b,BDDNode f) {
+
+  if (isterminalBDD(f)) return 0;
+  if (b->nodes[f].var & BDD_MARK) return 0;
+  b->nodes[f].var |= BDD_MARK;
+  return 1 + markBDD(b,b->nodes[f].lo) + markBDD(b,b->nodes[f].hi);
+}
+
+static void unmarkBDD(BDD *b,BDDNode f) {
+
+  if (isterminalBDD(f)) return;
+  if (!(b->nodes[f].var & BDD_MARK)) return;
+  b->nodes[f].var &= ~BDD_MARK;
+  unmarkBDD(b,b->nodes[f].lo);
+  unmarkBDD(b,b->nodes[f].hi);
+}
+
+
+size_t nodecountBDD(BDD *b,BDDNode f) {
+
+  assert(isconsistentBDD(b));
+
+  size_t count=markBDD(b,f);
+  unmarkBDD(b,f);
+  return count+2;
+}
+
+
+void collectBDD(BDD *b,const BDDNode *roots,size_t n) {
+
+  assert(isconsistentBDD(b));
+
+  if (b->size < b->collect_threshold) return;
+
+  for(size_t i=0;i<n;i++) markBDD(b,roots[i]);
+
+  /* Sweep: the free nodes have the mark as well, but their variable
+     is BDD_FREE */
+  b->free_list = BDD_NONE;
+  b->size = 2;
+  for(size_t i=b->used;i-- > 2;) {
+    BDDEntry *e=&b->nodes[i];
+    if (e->var!=BDD_FREE && (e->var & BDD_MARK)) {
+      e->var &= ~BDD_MARK;
+      b->size++;
+    } else {
+      e->var = BDD_FREE;
+      e->next = b->free_list;
+      b->free_list = (BDDNode)i;
+    }
+  }
+  rehashBDD(b);
+
+  /* The cached results may have been freed */
+  memset(b->cache,0,b->bucket_number*sizeof(BDDCacheEntry));
+
+  b->collect_threshold = MAX(2*b->size,BDD_MIN_ALLOCATION);
+  assert(isconsistentBDD(b));
+}
+
+
+size_t memoryBDD(const BDD *b) {
+
+  assert(b);
+  return b->allocation*sizeof(BDDEntry)
+    + b->bucket_number*(sizeof(BDDNode)+sizeof(BDDCacheEntry));
+}
@@ -0,0 +1,114 @@
+/*
+   Description::
+
+   Reduced ordered binary decision diagrams, for sets of assignments
+   to boolean variables, e.g. sets of pebble configurations.
+
+*/
+
+
+/* Preamble */
+#ifndef  BDD_H
+#define  BDD_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "common.h"
+
+
+/* Code */
+
+/* A function is given by the index of the root of its diagram. The
+   variables are numbered from 0, and they are tested from the root
+   in increasing order. */
+typedef uint32_t BDDNode;
+
+#define BDD_FALSE  ((BDDNode)0)
+#define BDD_TRUE   ((BDDNode)1)
+
+/* Each node tests a variable: the function is `lo' when it is false,
+   and `hi' when it is true, and the two are different. Nodes are
+   shared through a unique table of chained buckets. */
+typedef struct {
+
+  uint32_t var;       /* Or a mark of the terminal and free nodes */
+  BDDNode  lo;
+  BDDNode  hi;
+  BDDNode  next;      /* Next node of the bucket, or of the free list */
+
+} BDDEntry;
+
+/* The results of the operations are kept in a cache, which may forget
+   them. It has as many entries as the unique table has buckets. */
+typedef struct {
+  uint32_t op;
+  BDDNode  a,b,result;
+} BDDCacheEntry;
+
+typedef struct {
+
+  size_t    variables;      /* Number of variables */
+
+  BDDEntry *nodes;
+  size_t    allocation;     /* Room in the array of nodes */
+  size_t    used;           /* Nodes ever allocated in the array */
+  size_t    size;           /* Nodes in use, terminals included */
+  size_t    peak;           /* Largest size so far */
+  BDDNode   free_list;
+
+  BDDNode  *buckets;        /* Unique table */
+  size_t    bucket_number;  /* A power of two */
+
+  BDDCacheEntry *cache;
+
+  size_t    collect_threshold;
+
+} BDD;
+
+/* The arrays of the diagram start at BDD_MIN_ALLOCATION nodes. The
+   unused nodes are freed once there are twice as many nodes as the
+   ones left by the last collection, and at least BDD_MIN_ALLOCATION. */
+#define BDD_MIN_ALLOCATION  (0x1UL << 12)
+
+extern BDD *newBDD(size_t variables);
+extern void disposeBDD(BDD *b);
+
+extern Boolean isconsistentBDD(const BDD *b);
+
+/* The function of the variable `var', i.e. of its positive literal */
+extern BDDNode varBDD(BDD *b,uint32_t var);
+
+extern BDDNode notBDD(BDD *b,BDDNode f);
+extern BDDNode andBDD(BDD *b,BDDNode f,BDDNode g);
+extern BDDNode orBDD(BDD *b,BDDNode f,BDDNode g);
+
+/* f and not g */
+extern BDDNode diffBDD(BDD *b,BDDNode f,BDDNode g);
+
+/* The function `f' with the variable `var' set to `value' */
+extern BDDNode cofactorBDD(BDD *b,BDDNode f,uint32_t var,Boolean value);
+
+/* The assignment of all the variables given by `values' */
+extern BDDNode cubeBDD(BDD *b,const uint8_t *values);
+
+/* Fill `values' with an assignment which satisfies `f', with the
+   variables not tested along the way set to false.
+
+   @return FALSE if `f' is unsatisfiable */
+extern Boolean satoneBDD(const BDD *b,BDDNode f,uint8_t *values);
+
+/* Number of assignments of all the variables which satisfy `f' */
+extern double satcountBDD(BDD *b,BDDNode f);
+
+/* Number of nodes of the diagram of `f', terminals included */
+extern size_t nodecountBDD(BDD *b,BDDNode f);
+
+/* Free the nodes which are not in the diagrams of the `n' functions
+   in `roots', if the diagram has grown enough since the last
+   collection. Other functions must not be used afterwards. */
+extern void collectBDD(BDD *b,const BDDNode *roots,size_t n);
+
+/* Bytes of memory held by the diagrams */
+extern size_t memoryBDD(const BDD *b);
+
+#endif /* BDD_H */
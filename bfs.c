@@ -4,6 +4,10 @@
   Implementation of  a Breadth-First-Search  for the Black-White  or a
   Reversible Pebbling of a directed acyclic graph.
 
+  This file is compiled once for each width of the configurations
+  (see bittuple.h), and bfs_pebbling_strategy chooses the build
+  according to the size of the graph.
+
   @file 
   
 */
@@ -12,79 +16,30 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "common.h"
 #include "dag.h"
 #include "dsbasic.h"
 #include "pebbling.h"
+#include "configuration.h"
 #include "hashtable.h"
+#include "zdd.h"
 #include "statistics.h"
+#include "bfs.h"
 
-extern void print_dot_PebbleConfiguration(const DAG *g, const PebbleConfiguration *peb,
-                                          char *name,char* options);
+/* Symbols of the build for the current width */
+#define CheckRuntimeConsistency       WIDTH_SYMBOL(CheckRuntimeConsistency)
+#define finalize_persistent_pebbling  WIDTH_SYMBOL(finalize_persistent_pebbling)
+#define finalize_pebbling             WIDTH_SYMBOL(finalize_pebbling)
+#define finalize_reversible_pebbling  WIDTH_SYMBOL(finalize_reversible_pebbling)
 
 
 /**************************************
  * Utilities for pebbling dictionary
  **************************************/
 
-/*
- * The size of the hash is just a bold assumption. I definitely need a
- * serious hash map implementation.
- *
- */
-#define HASH_TABLE_SPACE_SIZE    CONFIG_HASHSIZE
-
-/*
- * To use  the dictionary  with PebbleConfiguration  we must  tell the
- * dictionary how to hash them.
- *
- */
-size_t hashPebbleConfiguration(void *data) {
-  assert(data);
-  PebbleConfiguration *ptr=(PebbleConfiguration *)data;
-
-#if BLACK_WHITE_PEBBLING
-  return  (size_t)(ptr->white_pebbled * 0x9e3779b9 + ptr->black_pebbled);
-#else
-  return  (size_t)(ptr->black_pebbled * 0x9e3779b9);
-#endif
-
-}
-
-/*
- * An "equality"  function for  pebbling configurations. We  just want
- * configuration to match if the pebble  set is the same (and the sink
- * has  been touched).   We  DON'T want  to  differentiate because  of
- * pebbling cost,  since the collistion is  what we use to  update the
- * cost function.
- *
- */
-Boolean  samePebbleConfiguration(void *A,void *B) {
-
-  assert(A);
-  assert(B);
-
-  PebbleConfiguration *pA,*pB;
-  pA=(PebbleConfiguration*)A;
-  pB=(PebbleConfiguration*)B;
-
-  if (pA->black_pebbled != pB->black_pebbled) return FALSE;
-
-#if BLACK_WHITE_PEBBLING
-  if (pA->white_pebbled != pB->white_pebbled) return FALSE;
-#endif
-
-  if (pA->sink_touched  != pB->sink_touched ) return FALSE;
-  return TRUE;
-}
-
-void  freePebbleConfiguration(void *data) {
-  assert(data);
-  dispose_PebbleConfiguration((PebbleConfiguration *)data);
-}
-
-
 /*
  * Runtime consistency checks. 
  *
@@ -104,51 +59,90 @@ Boolean CheckRuntimeConsistency(DAG *g,Dict *dict) {
   assert(dict);
   assert(isconsistent_DAG(g));
   assert(isconsistentDict(dict));
-  assert(g->size < BITTUPLE_SIZE);
+  assert(g->size <= BITTUPLE_SIZE);
 
 #ifdef HASHTABLE_DEBUG
 
   if (!isconsistentDict(dict)) return FALSE;
 
-  LinkedList cur,*l;
-  int cnt;
-  unsigned long long int tot_cnt=0;
+  /* Chech if all elements are appropriate pebblings */
+  for(size_t i=0;i<dict->allocation;i++) {
+    if (dict->slots[i].index==NO_RECORD) continue;
+    if (!isconsistent_PebbleRecord(g,atAR(dict->records,dict->slots[i].index))) return FALSE;
+  }
+  histogramDict(stderr,dict);
+
+#endif  /* HASHTABLE_DEBUG */
+  
+  return TRUE;
+}
+
 
-  /* Hash map hops histogram */
-  unsigned long long int histogram[40];
-  for(int i=0;i<40;i++) { histogram[i]=0; }
+/* Configurations waiting in the BFS queue, together with the index
+   of their record. */
+typedef struct {
+  PebbleConfiguration conf;
+  RecordIndex         index;
+} QueuedConfiguration;
 
-  /* Count the elements in each bucket */
-  for(size_t i=0;i<dict->size;i++) {
 
-    l=dict->buckets[i];
-    cnt=0;
+/* The configurations at the front of the queue are expanded in
+   batches of BFS_BATCH. Their neighbors are collected in a buffer
+   and the dictionary slots they need are prefetched, so that the
+   memory accesses of the queries overlap. The queries are then
+   resolved in the same order as neighbors are generated. */
+#define BFS_BATCH 16
 
-    /* Chech if all elements are appropriate pebblings */
-    for(resetSL(l);iscursorvalidSL(l);nextSL(l)) {
-      cnt++;
-      isconsistent_PebbleConfiguration(g,getSL(l));
+typedef struct {
+  PebbleConfiguration conf;
+  size_t              key;      /* hashDict(&conf) */
+  RecordIndex         parent;   /* Record of the expanded configuration */
+  Vertex              vertex;   /* Vertex of the move */
+  BitTuple            sleep;    /* Sleep set, see expand_with_sleep_sets */
+} Offspring;
 
-      /* No two equal configurations in the bucket */
-      forkcursorSL(l,&cur);
-      nextSL(&cur);
-      while(iscursorvalidSL(&cur)) {
-        if (dict->eq_function(getSL(l),getSL(&cur))) return FALSE;
-        nextSL(&cur);
-      }
-      
-    }
-    if (cnt<39) histogram[cnt]++;
-    else histogram[39]++;
-    tot_cnt += cnt;
+
+/* Store the compact form of a configuration in the arena, and return
+   its index. */
+static inline RecordIndex save_configuration(Arena *A,const PebbleConfiguration *c) {
+
+  if (sizeAR(A) >= NO_RECORD) {
+    fprintf(stderr,
+            "Error in search procedure: too many configurations "
+            "for the optimized data structures.");
+    exit(EXIT_FAILURE);
   }
-  fprintf(stderr,"Hashed elemenents: %15llu\n",tot_cnt);
-  for(int i=0;i<39;i++) { fprintf(stderr," %2d  = % 15llu\n",i,histogram[i]); }
-  fprintf(stderr," ... = % 15llu\n",histogram[39]);
+  pack_PebbleConfiguration((PebbleRecord*)allocAR(A),c);
+  return (RecordIndex)(sizeAR(A)-1);
+}
 
-#endif  /* HASHTABLE_DEBUG */
-  
-  return TRUE;
+
+/* Index of the record of the configuration which precedes the one
+   at `index' in the pebbling, or NO_RECORD for the initial one. */
+static RecordIndex previous_record(const DAG *g,const Dict *dict,RecordIndex index) {
+
+  const PebbleRecord *r=atAR(dict->records,index);
+
+#if MOVE_LOG
+  PebbleRecord previous;
+
+  if (r->flags & RECORD_INITIAL) return NO_RECORD;
+
+  /* The previous configuration has been visited, so it is in the
+     dictionary. */
+  undo_PebbleRecord(g,&previous,r);
+  index=lookupDict(dict,&previous);
+  assert(index!=NO_RECORD);
+  return index;
+#else
+  return r->previous_configuration;
+#endif
+}
+
+/* Vertex changed by the move which leads to the configuration at
+   `index' */
+static inline Vertex changed_vertex(const Dict *dict,RecordIndex index) {
+  return ((const PebbleRecord*)atAR(dict->records,index))->last_changed_vertex;
 }
 
 
@@ -174,29 +168,38 @@ Boolean CheckRuntimeConsistency(DAG *g,Dict *dict) {
    
    @param dag the graph we are pebbling
 
-   @param final a pointer to the final configuration found by the BFS.
+   @param dict the dictionary of the configurations visited by the BFS.
+
+   @param final the index of the record of the final configuration.
 
    OUTPUT:
 
    @return Pebbling the finalized pebbling.
 */
 Pebbling *finalize_persistent_pebbling(const DAG *graph,
-                                       PebbleConfiguration *final) {
+                                       const Dict *dict,
+                                       RecordIndex final) {
   assert(graph);
-  assert(final);
+  assert(dict);
+  assert(final < sizeAR(dict->records));
 
-  PebbleConfiguration *ptr=NULL;
+#if BLACK_WHITE_PEBBLING
+  const PebbleRecord *last=atAR(dict->records,final);
+#endif
+  const PebbleRecord *ptr=NULL;
+  RecordIndex idx,prev;
   Pebbling *solution=NULL;
   size_t length=0;
   int    cost =0;
   Vertex i=0;
   
   /* compute the length of the pebbling, without clean up */
-  ptr = final;
-  while(ptr!=NULL) {
+  idx = final;
+  while(idx!=NO_RECORD) {
+    ptr = atAR(dict->records,idx);
     length++;
-    cost = MAX(cost,configurationcost(graph, ptr));
-    ptr=ptr->previous_configuration;
+    cost = MAX(cost,recordcost(ptr));
+    idx = previous_record(graph,dict,idx);
   }
   length -= 1; /* initial conf is not a step */
 
@@ -204,7 +207,7 @@ Pebbling *finalize_persistent_pebbling(const DAG *graph,
   /* there may be black pebbles left to clean up which translates into
      white placement after reversing the pebbling.
    */
-  length += final->pebbles;
+  length += bt_popcount(last->black_pebbled);
 #endif 
   
   /* solution to be filled */
@@ -218,16 +221,14 @@ Pebbling *finalize_persistent_pebbling(const DAG *graph,
   /* Preamble phase: place some white pebbles, which correspond to the
      black pebbles cleaned at the end of the original pebbling. */
   for(Vertex v=0;v<graph->size;v++) {
-    if (isblack(v,graph,final)) { solution->steps[i]=v; ++i; }
+    if (bt_get(last->black_pebbled,v)) { solution->steps[i]=v; ++i; }
   }
 #endif
   
   /* Reverse the actual pebbling */
-  assert(i == final->pebbles);
-  ptr = final;
-  while(ptr->previous_configuration!=NULL) {
-    solution->steps[i] = ptr->last_changed_vertex;
-    ptr=ptr->previous_configuration;
+  assert(i == (Vertex)recordcost(atAR(dict->records,final)));
+  for(idx=final; (prev=previous_record(graph,dict,idx))!=NO_RECORD; idx=prev) {
+    solution->steps[i] = changed_vertex(dict,idx);
     i++;
   }
 
@@ -245,34 +246,41 @@ Pebbling *finalize_persistent_pebbling(const DAG *graph,
 
    @param dag the graph we are pebbling
 
-   @param final a pointer to the final configuration found by the BFS.
+   @param dict the dictionary of the configurations visited by the BFS.
+
+   @param final the index of the record of the final configuration.
    
    @return Pebbling the finalized pebbling.
 */
 Pebbling *finalize_pebbling(const DAG *graph,
-                                       PebbleConfiguration *final) {
+                            const Dict *dict,
+                            RecordIndex final) {
   assert(graph);
-  assert(final);
+  assert(dict);
+  assert(final < sizeAR(dict->records));
 
 #if REVERSIBLE_PEBBLING
   assert(0);
 #endif
 
-  PebbleConfiguration *ptr=NULL;
+  const PebbleRecord *last=atAR(dict->records,final);
+  const PebbleRecord *ptr=NULL;
+  RecordIndex idx,prev;
   Pebbling *solution=NULL;
   size_t length=0;
   int cost = 0;
   Vertex i=0;
 
   /* compute the length of the pebbling, without clean up */
-  ptr = final;
-  while(ptr!=NULL) {
+  idx = final;
+  while(idx!=NO_RECORD) {
+    ptr = atAR(dict->records,idx);
     length++;
-    cost = MAX(cost,configurationcost(graph, ptr));
-    ptr=ptr->previous_configuration;
+    cost = MAX(cost,recordcost(ptr));
+    idx = previous_record(graph,dict,idx);
   }
   length -= 1; /* initial conf is not a step */
-  length += final->pebbles; /* clean up black pebbles */
+  length += bt_popcount(last->black_pebbled); /* clean up black pebbles */
 
   /* solution to be filled */
   solution = new_Pebbling(length);
@@ -281,11 +289,9 @@ Pebbling *finalize_pebbling(const DAG *graph,
 
   /* Load the steps in the solution vector
      (steps are in reverse order) */
-  i = length - final->pebbles;
-  ptr = final;
-  while(ptr->previous_configuration!=NULL) {
-    solution->steps[--i] = ptr->last_changed_vertex;
-    ptr=ptr->previous_configuration;
+  i = length - bt_popcount(last->black_pebbled);
+  for(idx=final; (prev=previous_record(graph,dict,idx))!=NO_RECORD; idx=prev) {
+    solution->steps[--i] = changed_vertex(dict,idx);
   }
   assert(i==0);
 
@@ -293,7 +299,7 @@ Pebbling *finalize_pebbling(const DAG *graph,
      pebbling placements at the beginning. */
   i=length;
   for(Vertex v=0;v<graph->size;v++) {
-    if (isblack(v,graph,final)) { solution->steps[--i]=v; }
+    if (bt_get(last->black_pebbled,v)) { solution->steps[--i]=v; }
   }
 
 
@@ -307,20 +313,25 @@ Pebbling *finalize_pebbling(const DAG *graph,
 
    @param dag the graph we are pebbling
 
-   @param final a pointer to the final configuration found by the BFS.
+   @param dict the dictionary of the configurations visited by the BFS.
+
+   @param final the index of the record of the final configuration.
    
    @return Pebbling the finalized pebbling.
 */
 Pebbling *finalize_reversible_pebbling(const DAG *graph,
-                                       PebbleConfiguration *final) {
+                                       const Dict *dict,
+                                       RecordIndex final) {
   assert(graph);
-  assert(final);
+  assert(dict);
+  assert(final < sizeAR(dict->records));
 
 #if !REVERSIBLE_PEBBLING
   assert(0);
 #endif
 
-  PebbleConfiguration *ptr=NULL;
+  const PebbleRecord *ptr=NULL;
+  RecordIndex idx,prev;
   Pebbling *solution=NULL;
   size_t length=0;
   int cost = 0;
@@ -328,11 +339,12 @@ Pebbling *finalize_reversible_pebbling(const DAG *graph,
   Vertex j=0;
 
   /* compute the length of the pebbling */
-  ptr = final;
-  while(ptr!=NULL) {
+  idx = final;
+  while(idx!=NO_RECORD) {
+    ptr = atAR(dict->records,idx);
     length++;
-    cost = MAX(cost,configurationcost(graph, ptr));
-    ptr=ptr->previous_configuration;
+    cost = MAX(cost,recordcost(ptr));
+    idx = previous_record(graph,dict,idx);
   }
   length -= 1;
   length *= 2;
@@ -346,11 +358,9 @@ Pebbling *finalize_reversible_pebbling(const DAG *graph,
      (steps are in reverse order) */
   i = length/2;
   j = length/2;
-  ptr = final;
-  while(ptr->previous_configuration!=NULL) {
-    solution->steps[--i] = ptr->last_changed_vertex;
-    solution->steps[j++] = ptr->last_changed_vertex;
-    ptr=ptr->previous_configuration;
+  for(idx=final; (prev=previous_record(graph,dict,idx))!=NO_RECORD; idx=prev) {
+    solution->steps[--i] = changed_vertex(dict,idx);
+    solution->steps[j++] = changed_vertex(dict,idx);
   }
   assert(i==0);
   assert(j==length);
@@ -361,132 +371,263 @@ Pebbling *finalize_reversible_pebbling(const DAG *graph,
 
 
 
-/**
-   Explore the space of pebbling strategies.
-
-   We employ a simple breadth-first-search exploration in the graph of
-   pebbling configurations, checking if a final configuration
-   (e.g. sink has been touched and there are no white pebbles) is
-   reachable. The space is explored by looking for pebbling with at
-   most N pebbles.
-   
-   Persistent black-white pebbling is actually measured by placing a
-   white pebble on the sink and by trying to complete the
-   pebbling. Then the resulting pebbling is reversed.
-   
-   Since  we are  going  to  explore many  configurations,  we try  to
-   represent  a  configuration  with the  smallest  memory  footprint.
-   Furthermore  there  will   be  a  lot  of  useless   or  non  valid
-   configurations, thus we produce configurations on demand.  We use a
-   dictionary to keep track of previously visited configurations.
-
-   N.B. As a future option: we could use a ZDD  for keeping track of
-   visited configurations.
-   
-   INPUT:
+/* Kinds of breadth-first search */
+#define BFS_ONESHOT    0   /* A single round with a given bound */
+#define BFS_RESUMABLE  1   /* Rounds with increasing bounds */
+#define BFS_MINIMAX    2   /* Rounds with bounds 1,2,3,... up to a cap */
 
-   @param DAG the graph  to pebble (with few vertices  and a single
-   sink).
+/* State of a breadth-first search. The search can be resumed with a
+   larger bound on the number of pebbles: the visited configurations
+   are kept, and the search continues from the configurations which
+   had some move blocked by the previous bound. */
+typedef struct {
 
-   @param upper_bound: the maximum number of pebbles in the
-   configurations, if such number is not sufficient, the the
-   computation will fail gracefully without finding the pebbling.
+  DAG     *g;
+  Boolean  persistent_pebbling;
+  unsigned int upper_bound;   /* Bound of the last round of search */
 
-   @param persisten_pebbling: whether we count the black white
-   pebbling number for a pebbling which leaves a black pebble in the
-   sink.
+  /* The visited configurations are stored in compact form in the
+     arena, and are indexed by the dictionary. The queues keep the
+     configurations to be processed in full form, together with the
+     index of their record. */
+  Arena   *A;
+  Dict    *D;
+  Queue   *Q;
+  Queue   *blocked;           /* NULL if the search is not resumable */
 
-   OUTPUT:
+  Offspring *buffer;          /* Neighbors of a batch */
 
-   The output is given as a sequence of vertices, because at any point
-   in a pebbling, there is a unique minimal move that can be performed
-   on a vertex, given its status.
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+  RecordIndex final;          /* Final configuration, if found */
 
-   If there is  a pebble on the vertex, such  pebble shoud be removed.
-   If there is  not, then either a  white or a black  pebble should be
-   added.  In  case both  are allowed,  it is always  better to  add a
-   black one.
+  const int *cancel;          /* The search stops when it is set, if not NULL */
 
-   Notice  that in  case of  black-white or  reversible pebbling,  any
-   pebbling  induces  a dual  pebbling  with  a reversed  sequence  of
-   vertices.  Thus the  output of this function can  be interpreted in
-   both directions.
-   
-   @return a pebbling if exists, NULL otherwise.
+  /* Sleep sets of the records, if the search uses the partial order
+     reduction, or NULL. The records from `level_start' on are in the
+     level being generated. */
+  Arena      *sleep;
+  RecordIndex level_start;
+  Vertex     *order;          /* Moves of a configuration, in order */
 
- */
-Pebbling *bfs_pebbling_strategy(DAG *g,
-                                           unsigned int upper_bound,
-                                           Boolean persistent_pebbling) {
+} BFSSearch;
 
-  /* PROLOGUE ----------------------------------- */
-  if (g->size > BITTUPLE_SIZE) {
-    fprintf(stderr,
-            "Error in search procedure: the graph is too "
-            "big for the optimized data structures.");
-    exit(EXIT_FAILURE);
-  }
 
-  if (g->sink_number!=1) {
-    fprintf(stderr,
-            "Error in search procedure: the graph has more than "
-            "one sink vertex.");
-    exit(EXIT_FAILURE);
-  }
+/* Set up the search from the initial configuration. The dictionary
+   is sized for the configurations within `max_bound' pebbles, except
+   in a minimax search, where the bound is just a cap and the
+   dictionary grows with the rounds. */
+static BFSSearch *new_BFSSearch(DAG *g,
+                                unsigned int max_bound,
+                                Boolean persistent_pebbling,
+                                int kind) {
 
-  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
 
-  
 #if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
   persistent_pebbling = 0;
 #endif
-  
-  /* Collect statistic on the running */
-  STATS_CREATE(Stat);
 
-  /* END OF PROLOGUE ----------------------------------- */
-  
+  BFSSearch *s=(BFSSearch*)malloc(sizeof(BFSSearch));
+  assert(s);
 
-  /* Data structures for BFS */
-  PebbleConfiguration *initial=new_PebbleConfiguration();
-  Queue               *Q=newSL();
-  Dict *D = newDict(HASH_TABLE_SPACE_SIZE);
+  s->g = g;
+  s->persistent_pebbling = persistent_pebbling;
+  s->upper_bound = 0;
+
+  s->A = newAR(sizeof(PebbleRecord));
+  s->D = newDict(kind==BFS_MINIMAX ? 0 : estimate_configurations(g,max_bound),s->A);
+  s->Q = newQ(sizeof(QueuedConfiguration));
+  s->blocked = (kind!=BFS_ONESHOT) ? newQ(sizeof(QueuedConfiguration)) : NULL;
+
+  /* Each configuration has at most one neighbor per vertex */
+  s->buffer=(Offspring*)malloc(BFS_BATCH*g->size*sizeof(Offspring));
+  assert(s->buffer);
+
+  if (persistent_pebbling)
+    s->isfinal = isfinal_persistent;
+  else 
+    s->isfinal = isfinal_visiting;
+  s->final = NO_RECORD;
+  s->cancel = NULL;
+  s->sleep = NULL;
+  s->order = NULL;
 
-  /* Dictionary setup */
-  DictQueryResult res;
-  D->key_function = hashPebbleConfiguration;
-  D->eq_function  = samePebbleConfiguration;
-  D->dispose_function = freePebbleConfiguration;
-  
   /* Initial configuration for the BFS */
-  enqueue  (Q,initial);
-  writeDict(D,&res,initial);
+  DictQueryResult res;
+  QueuedConfiguration *nptr = (QueuedConfiguration*)enqueueQ(s->Q);
+  init_PebbleConfiguration(g,&nptr->conf);
 #if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
-  if (persistent_pebbling) {  init_persistent_pebbling(g, initial); }
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &nptr->conf); }
 #endif
+  assert(!s->isfinal(g,&nptr->conf));
+  nptr->index = save_configuration(s->A,&nptr->conf);
+  writeDict(s->D,&res,&nptr->conf,nptr->index);
+  s->level_start = (RecordIndex)sizeAR(s->A);
 
+  /* Consistency test of data structures */
+  assert(isconsistentDict(s->D));
+  assert(isconsistentQ(s->Q));
 
-  PebbleConfiguration *ptr  =NULL;    /* Configuration to be processed */
-  PebbleConfiguration *nptr =NULL;    /* Configuration to be queued for later processing (maybe) */
-  PebbleConfiguration *final=NULL;    /* final configuration */
+  return s;
+}
 
-  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *); /*pointer to final configuration tester.*/ 
 
-  if (persistent_pebbling)
-    isfinal = isfinal_persistent;
-  else 
-    isfinal = isfinal_visiting;
-  
-  /* Consistency test of data structures */
-  assert(isconsistentDict(D));
-  assert(isconsistentSL(Q));
+static void dispose_BFSSearch(BFSSearch *s) {
+
+  assert(s);
+
+#ifdef HASHTABLE_DEBUG
+  assert(!CheckRuntimeConsistency(s->g,s->D));
+#endif
+
+  disposeQ(s->Q);
+  if (s->blocked) disposeQ(s->blocked);
+  free(s->buffer);
+  if (s->sleep) disposeAR(s->sleep);
+  free(s->order);
+  disposeDict(s->D);
+  disposeAR(s->A);
+  free(s);
+}
+
+
+/* Partial order reduction
+
+   Two moves on vertices which are not adjacent commute: they reach
+   the same configuration in both orders, and neither one disables
+   the other, unless both are placements and there is room for a
+   single pebble more. Of the orders of independent moves the search
+   may explore just one, by sleep sets. The sleep set of a
+   configuration holds the moves which need not be taken from it,
+   because what they reach is reached by taking them earlier. When a
+   move is taken, the neighbor gets the moves of the sleep set, and
+   the moves taken before it from the same configuration, which are
+   independent from it. A configuration reached again in the level
+   where it was first reached keeps the moves in both sleep sets.
+
+   The moves are taken in the order which the heuristics of
+   next_PebbleConfiguration keep between two consecutive independent
+   moves: removals first, from the largest vertex, then placements
+   from the smallest one. So the order kept by the sleep sets is
+   never cut by the heuristics. */
+
+/* Sleep set of the neighbor reached from `c' by the move on `v' */
+static inline BitTuple sleep_after(const DAG *g,const PebbleConfiguration *c,
+                                   BitTuple sleep,Vertex v,unsigned int upper_bound) {
+
+  bt_reset(&sleep,v);
+  bt_andnotwords(&sleep,PRED_BITMASK(g,v),g->bitmask_words);
+  bt_andnotwords(&sleep,SUCC_BITMASK(g,v),g->bitmask_words);
+
+  /* After a placement which fills the bound, no placement commutes */
+  if (!ispebbled(v,g,c) && c->pebbles+2 > upper_bound) {
+#if BLACK_WHITE_PEBBLING
+    sleep = bt_and(sleep,bt_or(c->black_pebbled,c->white_pebbled));
+#else
+    sleep = bt_and(sleep,c->black_pebbled);
+#endif
+  }
+  return sleep;
+}
+
+/* Neighbors of a queued configuration by the legal moves which are
+   not in its sleep set.
+
+   @return the number of neighbors written in `out' */
+static size_t expand_with_sleep_sets(BFSSearch *s,const QueuedConfiguration *ptr,
+                                     BitTuple moves,unsigned int upper_bound,
+                                     Offspring *out) {
+
+  const DAG *g=s->g;
+  const PebbleConfiguration *c=&ptr->conf;
+  BitTuple sleep=*(const BitTuple*)atAR(s->sleep,ptr->index);
+  Vertex  *order=s->order;
+  size_t   n=0,removals,buffered=0;
+  Vertex   v;
+
+#if BLACK_WHITE_PEBBLING
+  BitTuple pebbled=bt_or(c->black_pebbled,c->white_pebbled);
+#else
+  BitTuple pebbled=c->black_pebbled;
+#endif
+  BitTuple t;
+
+  for(t=bt_and(moves,pebbled); !bt_iszero(t); bt_reset(&t,v)) { v=bt_lowest(t); order[n++]=v; }
+  removals=n;
+  for(size_t i=0;i<removals/2;i++) {
+    v=order[i]; order[i]=order[removals-1-i]; order[removals-1-i]=v;
+  }
+  for(t=bt_andnot(moves,pebbled); !bt_iszero(t); bt_reset(&t,v)) { v=bt_lowest(t); order[n++]=v; }
+
+  for(size_t i=0;i<n;i++) {
+
+    v=order[i];
+    if (bt_get(sleep,v)) continue;
+
+    Offspring *next=&out[buffered];
+    if (!next_PebbleConfiguration(v,g,c,upper_bound,&next->conf)) continue;
 
-  STATS_SET(Stat,first_queuing,1);
-  STATS_SET(Stat,queued,1);
-  STATS_SET(Stat,dict_size,D->size);
+    next->sleep  = sleep_after(g,c,sleep,v,upper_bound);
+    next->key    = hashDict(&next->conf);
+    next->parent = ptr->index;
+    next->vertex = v;
+    prefetchDict(s->D,next->key);
+    buffered++;
 
-  /* The breadth-first-search on the space of pebbling configurations.*/
-  for(resetSL(Q); !isemptySL(Q); pop(Q)) {
+    bt_set(&sleep,v);      /* Taken before the next moves */
+  }
+  return buffered;
+}
+
+
+/* The breadth-first-search on the space of pebbling configurations,
+   with at most `upper_bound' pebbles. If the search is resumed, it
+   starts from the configurations blocked by the previous bound. A
+   cancelled search stops between two batches.
+
+   @return TRUE if a final configuration has been found */
+static Boolean explore_BFSSearch(BFSSearch *s,unsigned int upper_bound) {
+
+  assert(s);
+  assert(s->final==NO_RECORD);
+  assert(upper_bound >= s->upper_bound);
+
+  DAG   *g = s->g;
+  Dict  *D = s->D;
+  Queue *Q = s->Q;
+  Offspring *buffer = s->buffer;
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *) = s->isfinal;
+
+  DictQueryResult res;
+
+  QueuedConfiguration *ptr  =NULL;    /* Configuration to be processed */
+  QueuedConfiguration *nptr =NULL;    /* Configuration to be queued for later processing */
+  Offspring           *next =NULL;    /* Neighbor configuration */
+  BitTuple             moves;         /* Vertices with a legal move yet to be explored */
+  Vertex               v;
+  size_t               buffered;
+
+  /* Collect statistic on the running */
+  STATS_CREATE(Stat);
+
+  /* The previous round exhausted the queue, so the search continues
+     from the configurations blocked by the bound. */
+  if (s->blocked && upper_bound > s->upper_bound && isemptyQ(Q)) {
+    s->Q       = s->blocked;
+    s->blocked = Q;
+    Q          = s->Q;
+  }
+  s->upper_bound = upper_bound;
+
+  STATS_SET(Stat,first_queuing,lengthQ(Q));
+  STATS_SET(Stat,queued,lengthQ(Q));
+  STATS_SET(Stat,dict_size,D->allocation);
+
+  while(!isemptyQ(Q)) {
+
+    if (s->cancel && ATOMIC_LOAD(s->cancel)) break;
 
     if (STATS_TIMER_OFF) {
       STATS_CLOCK_UPDATE(Stat);
@@ -498,38 +639,87 @@ Pebbling *bfs_pebbling_strategy(DAG *g,
       STATS_TIMER_RESET();
     }
 
-    /* Get an element from the queue */
-    ptr=(PebbleConfiguration*)getSL(Q);
-    assert(isconsistent_PebbleConfiguration(g,ptr));
-    assert(!isfinal(g,ptr));
-    STATS_INC(Stat,processed);
+    /* Expand a batch of elements from the queue */
+    buffered=0;
+    for(size_t b=0; b<BFS_BATCH && !isemptyQ(Q); b++,popQ(Q)) {
+
+      ptr=(QueuedConfiguration*)frontQ(Q);
+
+      /* With sleep sets a batch does not span two levels, so that
+         the records of the next level are known */
+      if (s->sleep && ptr->index >= s->level_start) {
+        if (b>0) break;
+        s->level_start = (RecordIndex)sizeAR(s->A);
+      }
+
+      assert(isconsistent_PebbleConfiguration(g,&ptr->conf));
+      assert(!isfinal(g,&ptr->conf));
+      STATS_INC(Stat,processed);
+
+      /* Collect all configurations reachable in one step. Only the
+         vertices with a legal move are considered, in increasing
+         order. */
+      moves=legalmoves(g,&ptr->conf,upper_bound);
+
+      /* Keep aside the configurations with moves which need more
+         pebbles, for a later round */
+      if (s->blocked && ptr->conf.pebbles >= upper_bound &&
+          !bt_equal(moves,legalmoves(g,&ptr->conf,upper_bound+1))) {
+        *(QueuedConfiguration*)enqueueQ(s->blocked) = *ptr;
+        STATS_INC(Stat,above_upper_bound);
+      }
+
+      if (s->sleep) {
+        size_t k=expand_with_sleep_sets(s,ptr,moves,upper_bound,&buffer[buffered]);
+        STATS_ADD(Stat,offspring,k);
+        buffered+=k;
+        continue;
+      }
+
+      for(; !bt_iszero(moves); bt_reset(&moves,v)) {
+
+        v=bt_lowest(moves);
+        next=&buffer[buffered];
+
+        if (!next_PebbleConfiguration(v,g,&ptr->conf,upper_bound,&next->conf))
+          continue; /* Step corresponding to vertex v is invalid/useless */
 
-    /* Explore all configurations reachable in one step.  */
-    for(Vertex v=0;v<g->size;v++) {
+        STATS_INC(Stat,offspring);
 
-      nptr=next_PebbleConfiguration(v,g,ptr,upper_bound);
-      if (nptr==NULL) continue; /* Step corresponding to vertex v is invalid/useless */
+        next->key    = hashDict(&next->conf);
+        next->parent = ptr->index;
+        next->vertex = v;
+        prefetchDict(D,next->key);
+        buffered++;
+      }
+    }
 
-      STATS_INC(Stat,offspring);
+    /* Find out which neighbors have already been encountered (check
+       in the dictionary) */
+    for(size_t i=0; i<buffered; i++) {
 
-      /* Find out if it has already been encountered (check in the dictionary) */
-      queryDict(D,&res,nptr);
+      next=&buffer[i];
+      keyed_queryDict(D,&res,&next->conf,next->key);
       STATS_INC(Stat,dict_queries);
       STATS_ADD(Stat,dict_hops,res.hops);
 
-      if (res.value==NULL)  {  /* A configuration never encountered before */
+      if (res.index==NO_RECORD)  {  /* A configuration never encountered before */
 
-        nptr->previous_configuration = ptr;  /* It's origin */
-        nptr->last_changed_vertex = v;
+        next->conf.previous_configuration = next->parent;  /* It's origin */
+        next->conf.last_changed_vertex = next->vertex;
 
-        unsafe_noquery_writeDict(D,&res,nptr); /* Mark as encountered (put in the dictionary) */
+        nptr = (QueuedConfiguration*)enqueueQ(Q);  /* Put in queue for later processing */
+        nptr->conf  = next->conf;
+        nptr->index = save_configuration(s->A,&next->conf);
+        if (s->sleep) *(BitTuple*)allocAR(s->sleep) = next->sleep;
 
-        if (isfinal(g,nptr)) {               /* Is it the end of the search? */
-          final=nptr;
+        unsafe_noquery_writeDict(D,&res,nptr->index); /* Mark as encountered (put in the dictionary) */
+
+        if (isfinal(g,&next->conf)) {               /* Is it the end of the search? */
+          s->final=nptr->index;
           goto epilogue;
         }
 
-        enqueue(Q,nptr);                       /* Put in queue for later processing */
         STATS_INC(Stat,queued);
         STATS_INC(Stat,first_queuing);
 
@@ -537,46 +727,1619 @@ Pebbling *bfs_pebbling_strategy(DAG *g,
         STATS_INC(Stat,dict_writes);
 
       } else {                                 /* Already encountered. No new information. */
+        if (s->sleep && res.index >= s->level_start) {
+          BitTuple *sleep=(BitTuple*)atAR(s->sleep,res.index);
+          *sleep = bt_and(*sleep,next->sleep);
+        }
         STATS_INC(Stat,suboptimal);
-        dispose_PebbleConfiguration(nptr);
       }
 
     } /* End of neighborhood exploration */
 
   }/* queue of configurations is empty, end of BFS */
 
-
-  Pebbling *solution=NULL;
-  
 epilogue:
-  
-  /* To get a formally correct pebbling we need to give final touch. */
-  if (persistent_pebbling) {
-
-    solution = final ? finalize_persistent_pebbling(g,final) : NULL ;
-
-  } else {
-#if REVERSIBLE_PEBBLING
-    solution = final ? finalize_reversible_pebbling(g,final) : NULL ;
-#else
-    solution = final ? finalize_pebbling(g,final) : NULL ;
-#endif
-  }
 
-  
   STATS_REPORT(Stat,"\nFINAL REPORT (clk. %llu): upper bound=%u:\n\n",
                STATS_GET(Stat,clock),
                upper_bound);
 
-#ifdef HASHTABLE_DEBUG
-  assert(!CheckRuntimeConsistency(g,D));
-#endif
+  return s->final!=NO_RECORD;
+}
 
 
-  /* Free the memory of the data structures */
-  if (Q) disposeSL(Q);
-  disposeDict(D);
+/* Level-synchronous parallel search
 
-  return solution;
+   Each level of the breadth-first search (i.e. the configurations in
+   the queue when the level starts) is processed in three phases.
+
+   1. The level is split in chunks of PARALLEL_CHUNK configurations,
+      which the worker threads expand. The dictionary is not
+      modified in this phase, so the workers query it without locks
+      and discard the neighbors visited in the previous levels. The
+      other neighbors of a chunk are kept in its own buffer, in the
+      order they are generated.
+
+   2. The same configuration is usually reached several times in the
+      level. The configurations are split in shards by their hash,
+      and each worker scans the buffers in order for the
+      configurations of its shard, marking all but the first
+      occurrence of each one.
+
+   3. The configurations left are new, and they are inserted in the
+      dictionary and in the queue, in the order of the level.
+
+   The first occurrence of each new configuration, in the order of
+   the level, is the one inserted by the serial search. Hence the
+   records, their order and the pebbling found are the same. */
+#define PARALLEL_CHUNK 256
+
+typedef struct {
+
+  const BFSSearch *s;
+  unsigned int upper_bound;
+  unsigned int shards;
+
+  const QueuedConfiguration *level;   /* Configurations of the level */
+  size_t level_size;
+
+  size_t chunks;
+  size_t next_chunk;                  /* Next chunk to be expanded */
+
+  Offspring **kept;                   /* Neighbors kept for each chunk */
+  size_t     *kept_size;
+  size_t     *kept_allocation;
+  size_t      allocated_chunks;
+
+} ParallelLevel;
+
+typedef struct {
+
+  ParallelLevel *L;
+  unsigned int id;                    /* Also the shard of the worker */
+
+  Offspring  *buffer;                 /* Neighbors of a configuration */
+  Offspring **table;                  /* Configurations of the shard */
+  size_t      table_allocation;
+  pthread_t   thread;
+
+} ParallelWorker;
+
+/* The shard is given by the bits of the hash which are not used by
+   the dictionary and by the tables of the shards. */
+static inline unsigned int shard_of(size_t key,unsigned int shards) {
+  return (unsigned int)((key >> 40) % shards);
+}
+
+
+/* Phase 1 */
+static void *expand_ParallelWorker(void *arg) {
+
+  ParallelWorker *w=(ParallelWorker*)arg;
+  ParallelLevel  *L=w->L;
+  const DAG      *g=L->s->g;
+  Dict           *D=L->s->D;
+
+  DictQueryResult      res;
+  const QueuedConfiguration *ptr;
+  Offspring           *next;
+  BitTuple             moves;
+  Vertex               v;
+  size_t               k,i,end,buffered;
+
+  while((k=ATOMIC_FETCH_INCREMENT(&L->next_chunk)) < L->chunks) {
+
+    end = (k+1)*PARALLEL_CHUNK;
+    if (end > L->level_size) end=L->level_size;
+    L->kept_size[k] = 0;
+
+    for(i=k*PARALLEL_CHUNK; i<end; i++) {
+
+      ptr=&L->level[i];
+      buffered=0;
+
+      for(moves=legalmoves(g,&ptr->conf,L->upper_bound); !bt_iszero(moves); bt_reset(&moves,v)) {
+
+        v=bt_lowest(moves);
+        next=&w->buffer[buffered];
+
+        if (!next_PebbleConfiguration(v,g,&ptr->conf,L->upper_bound,&next->conf))
+          continue;
+
+        next->key    = hashDict(&next->conf);
+        next->parent = ptr->index;
+        next->vertex = v;
+        prefetchDict(D,next->key);
+        buffered++;
+      }
+
+      for(size_t j=0; j<buffered; j++) {
+        next=&w->buffer[j];
+        keyed_queryDict(D,&res,&next->conf,next->key);
+        if (res.index!=NO_RECORD) continue;
+
+        if (L->kept_size[k]==L->kept_allocation[k]) {
+          L->kept_allocation[k] = 2*L->kept_allocation[k] + g->size;
+          L->kept[k]=(Offspring*)realloc(L->kept[k],L->kept_allocation[k]*sizeof(Offspring));
+          assert(L->kept[k]);
+        }
+        L->kept[k][L->kept_size[k]++] = *next;
+      }
+    }
+  }
+  return NULL;
+}
+
+/* Phase 2 */
+static void *deduplicate_ParallelWorker(void *arg) {
+
+  ParallelWorker *w=(ParallelWorker*)arg;
+  ParallelLevel  *L=w->L;
+  Offspring      *next;
+  size_t          count=0,mask,h;
+
+  for(size_t k=0; k<L->chunks; k++)
+    for(size_t j=0; j<L->kept_size[k]; j++)
+      if (shard_of(L->kept[k][j].key,L->shards)==w->id) count++;
+
+  if (count==0) return NULL;
+
+  for(mask=1; mask < 2*count; mask<<=1);
+  if (w->table_allocation < mask) {
+    w->table_allocation = mask;
+    free(w->table);
+    w->table=(Offspring**)malloc(w->table_allocation*sizeof(Offspring*));
+    assert(w->table);
+  }
+  for(h=0; h<mask; h++) w->table[h]=NULL;
+  mask--;
+
+  for(size_t k=0; k<L->chunks; k++) {
+    for(size_t j=0; j<L->kept_size[k]; j++) {
+      next=&L->kept[k][j];
+      if (shard_of(next->key,L->shards)!=w->id) continue;
+      for(h=next->key & mask; w->table[h]!=NULL; h=(h+1) & mask) {
+        if (w->table[h]->key==next->key && match_configurationsDict(&w->table[h]->conf,&next->conf)) break;
+      }
+      if (w->table[h]==NULL) w->table[h]=next;
+      else next->parent=NO_RECORD;   /* Not the first occurrence */
+    }
+  }
+  return NULL;
 }
 
+/* Run a phase with `active' workers, the calling thread being the
+   first one. */
+static void run_ParallelWorkers(ParallelWorker *workers,unsigned int active,void *(*phase)(void *)) {
+
+  for(unsigned int t=1;t<active;t++) {
+    if (pthread_create(&workers[t].thread,NULL,phase,&workers[t])!=0) {
+      fprintf(stderr,"Error in search procedure: unable to start a thread.");
+      exit(EXIT_FAILURE);
+    }
+  }
+  phase(&workers[0]);
+  for(unsigned int t=1;t<active;t++) pthread_join(workers[t].thread,NULL);
+}
+
+
+/* The breadth-first search with at most `upper_bound' pebbles,
+   processing each level with `threads' threads.
+
+   @return TRUE if a final configuration has been found */
+static Boolean explore_parallel_BFSSearch(BFSSearch *s,unsigned int upper_bound,unsigned int threads) {
+
+  assert(s);
+  assert(s->final==NO_RECORD);
+  assert(s->blocked==NULL);
+  assert(threads>0);
+
+  DAG   *g = s->g;
+  Dict  *D = s->D;
+  Queue *Q = s->Q;
+
+  DictQueryResult      res;
+  QueuedConfiguration *nptr;
+  Offspring           *next;
+
+  ParallelLevel L;
+  ParallelWorker *workers=(ParallelWorker*)malloc(threads*sizeof(ParallelWorker));
+  assert(workers);
+
+  QueuedConfiguration *level=NULL;
+  size_t level_allocation=0;
+
+  s->upper_bound = upper_bound;
+  L.s = s;
+  L.upper_bound = upper_bound;
+  L.shards = threads;
+  L.kept = NULL;
+  L.kept_size = NULL;
+  L.kept_allocation = NULL;
+  L.allocated_chunks = 0;
+
+  for(unsigned int t=0;t<threads;t++) {
+    workers[t].L  = &L;
+    workers[t].id = t;
+    workers[t].buffer = (Offspring*)malloc(g->size*sizeof(Offspring));
+    assert(workers[t].buffer);
+    workers[t].table = NULL;
+    workers[t].table_allocation = 0;
+  }
+
+  while(!isemptyQ(Q) && s->final==NO_RECORD) {
+
+    /* Take the level out of the queue */
+    L.level_size = lengthQ(Q);
+    if (L.level_size > level_allocation) {
+      level_allocation = 2*L.level_size;
+      free(level);
+      level=(QueuedConfiguration*)malloc(level_allocation*sizeof(QueuedConfiguration));
+      assert(level);
+    }
+    for(size_t i=0; i<L.level_size; i++,popQ(Q)) level[i]=*(QueuedConfiguration*)frontQ(Q);
+
+    L.level = level;
+    L.chunks = (L.level_size + PARALLEL_CHUNK - 1)/PARALLEL_CHUNK;
+    L.next_chunk = 0;
+    if (L.chunks > L.allocated_chunks) {
+      L.kept            = (Offspring**)realloc(L.kept,L.chunks*sizeof(Offspring*));
+      L.kept_size       = (size_t*)realloc(L.kept_size,L.chunks*sizeof(size_t));
+      L.kept_allocation = (size_t*)realloc(L.kept_allocation,L.chunks*sizeof(size_t));
+      assert(L.kept && L.kept_size && L.kept_allocation);
+      for(size_t k=L.allocated_chunks; k<L.chunks; k++) {
+        L.kept[k] = NULL;
+        L.kept_allocation[k] = 0;
+      }
+      L.allocated_chunks = L.chunks;
+    }
+
+    /* More threads than chunks would have nothing to do */
+    unsigned int active = (L.chunks < threads) ? (unsigned int)L.chunks : threads;
+    L.shards = active;
+
+    run_ParallelWorkers(workers,active,expand_ParallelWorker);
+    run_ParallelWorkers(workers,active,deduplicate_ParallelWorker);
+
+    /* Insert the new configurations, in the order of the level */
+    for(size_t k=0; k<L.chunks && s->final==NO_RECORD; k++) {
+      for(size_t j=0; j<L.kept_size[k]; j++) {
+
+        next=&L.kept[k][j];
+        if (next->parent==NO_RECORD) continue;  /* Already in this level */
+
+        keyed_queryDict(D,&res,&next->conf,next->key);
+        assert(res.index==NO_RECORD);
+
+        next->conf.previous_configuration = next->parent;
+        next->conf.last_changed_vertex = next->vertex;
+
+        nptr = (QueuedConfiguration*)enqueueQ(Q);
+        nptr->conf  = next->conf;
+        nptr->index = save_configuration(s->A,&next->conf);
+        unsafe_noquery_writeDict(D,&res,nptr->index);
+
+        if (s->isfinal(g,&next->conf)) {
+          s->final=nptr->index;
+          break;
+        }
+      }
+    }
+  }
+
+  for(unsigned int t=0;t<threads;t++) {
+    free(workers[t].buffer);
+    free(workers[t].table);
+  }
+  for(size_t k=0; k<L.allocated_chunks; k++) free(L.kept[k]);
+  free(L.kept);
+  free(L.kept_size);
+  free(L.kept_allocation);
+  free(workers);
+  free(level);
+
+  return s->final!=NO_RECORD;
+}
+
+
+/* To get a formally correct pebbling we need to give final touch. */
+static Pebbling *solution_BFSSearch(BFSSearch *s) {
+
+  assert(s);
+
+  if (s->final==NO_RECORD) return NULL;
+
+  if (s->persistent_pebbling) return finalize_persistent_pebbling(s->g,s->D,s->final);
+
+#if REVERSIBLE_PEBBLING
+  return finalize_reversible_pebbling(s->g,s->D,s->final);
+#else
+  return finalize_pebbling(s->g,s->D,s->final);
+#endif
+}
+
+
+/**
+   Explore the space of pebbling strategies.
+
+   We employ a simple breadth-first-search exploration in the graph of
+   pebbling configurations, checking if a final configuration
+   (e.g. sink has been touched and there are no white pebbles) is
+   reachable. The space is explored by looking for pebbling with at
+   most N pebbles.
+   
+   Persistent black-white pebbling is actually measured by placing a
+   white pebble on the sink and by trying to complete the
+   pebbling. Then the resulting pebbling is reversed.
+   
+   Since  we are  going  to  explore many  configurations,  we try  to
+   represent  a  configuration  with the  smallest  memory  footprint.
+   Furthermore  there  will   be  a  lot  of  useless   or  non  valid
+   configurations, thus we produce configurations on demand.  We use a
+   dictionary to keep track of previously visited configurations.
+
+   N.B. zdd_bfs_pebbling_strategy keeps track of the visited
+   configurations in a ZDD instead.
+   
+   INPUT:
+
+   @param DAG the graph  to pebble (with few vertices  and a single
+   sink).
+
+   @param upper_bound: the maximum number of pebbles in the
+   configurations, if such number is not sufficient, the the
+   computation will fail gracefully without finding the pebbling.
+
+   @param persisten_pebbling: whether we count the black white
+   pebbling number for a pebbling which leaves a black pebble in the
+   sink.
+
+   OUTPUT:
+
+   The output is given as a sequence of vertices, because at any point
+   in a pebbling, there is a unique minimal move that can be performed
+   on a vertex, given its status.
+
+   If there is  a pebble on the vertex, such  pebble shoud be removed.
+   If there is  not, then either a  white or a black  pebble should be
+   added.  In  case both  are allowed,  it is always  better to  add a
+   black one.
+
+   Notice  that in  case of  black-white or  reversible pebbling,  any
+   pebbling  induces  a dual  pebbling  with  a reversed  sequence  of
+   vertices.  Thus the  output of this function can  be interpreted in
+   both directions.
+   
+   @return a pebbling if exists, NULL otherwise.
+
+ */
+Pebbling *WIDTH_SYMBOL(bfs_pebbling_strategy)(DAG *g,
+                                              unsigned int upper_bound,
+                                              Boolean persistent_pebbling) {
+
+  return WIDTH_SYMBOL(cancellable_bfs_pebbling_strategy)(g,upper_bound,persistent_pebbling,NULL);
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with the levels of the search
+   expanded by `threads' threads. The pebbling found is the same.
+*/
+Pebbling *WIDTH_SYMBOL(parallel_bfs_pebbling_strategy)(DAG *g,
+                                                       unsigned int upper_bound,
+                                                       Boolean persistent_pebbling,
+                                                       unsigned int threads) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  BFSSearch *s=new_BFSSearch(g,upper_bound,persistent_pebbling,BFS_ONESHOT);
+  explore_parallel_BFSSearch(s,upper_bound,threads);
+
+  Pebbling *solution=solution_BFSSearch(s);
+  dispose_BFSSearch(s);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with the partial order reduction by
+   sleep sets: of the orders of independent moves, the search
+   explores only one. The pebbling found has the same cost and the
+   same length, but it may be a different one.
+*/
+Pebbling *WIDTH_SYMBOL(reduced_bfs_pebbling_strategy)(DAG *g,
+                                                      unsigned int upper_bound,
+                                                      Boolean persistent_pebbling) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  BFSSearch *s=new_BFSSearch(g,upper_bound,persistent_pebbling,BFS_ONESHOT);
+
+  /* The sleep set of the initial configuration is empty */
+  s->sleep = newAR(sizeof(BitTuple));
+  *(BitTuple*)allocAR(s->sleep) = bt_zero();
+  s->order = (Vertex*)malloc(g->size*sizeof(Vertex));
+  assert(s->order);
+
+  explore_BFSSearch(s,upper_bound);
+
+  Pebbling *solution=solution_BFSSearch(s);
+  dispose_BFSSearch(s);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, but the search gives up as soon as
+   `*cancel' is set (e.g. by another thread). The flag is checked
+   between batches of configurations.
+
+   @param cancel the cancellation flag, or NULL
+
+   @return a pebbling if exists and the search is not cancelled, NULL
+   otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(cancellable_bfs_pebbling_strategy)(DAG *g,
+                                                          unsigned int upper_bound,
+                                                          Boolean persistent_pebbling,
+                                                          const int *cancel) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  BFSSearch *s=new_BFSSearch(g,upper_bound,persistent_pebbling,BFS_ONESHOT);
+  s->cancel = cancel;
+  explore_BFSSearch(s,upper_bound);
+
+  Pebbling *solution=solution_BFSSearch(s);
+  dispose_BFSSearch(s);
+  return solution;
+}
+
+
+/**
+   A search which keeps the visited configurations between increasing
+   bounds on the number of pebbles. The first round with bound B
+   explores the same configurations as bfs_pebbling_strategy with
+   bound B. Each later round only explores the configurations which
+   need more pebbles than the previous bound, so a sweep of bounds
+   costs about as much as a search with the last bound.
+
+   The pebbling found has the smallest cost among the bounds tried,
+   but it is not necessarily the shortest one with that cost.
+
+   @param max_bound the largest bound which is going to be used, to
+   size the data structures.
+*/
+void *WIDTH_SYMBOL(new_bfs_search)(DAG *g,
+                                   unsigned int max_bound,
+                                   Boolean persistent_pebbling) {
+  return new_BFSSearch(g,max_bound,persistent_pebbling,BFS_RESUMABLE);
+}
+
+/**
+   Continue the search with at most `upper_bound' pebbles, which must
+   not be smaller than the bound of the previous round.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(resume_bfs_search)(void *search,unsigned int upper_bound) {
+
+  BFSSearch *s=(BFSSearch*)search;
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  if (s->final==NO_RECORD) explore_BFSSearch(s,upper_bound);
+  return solution_BFSSearch(s);
+}
+
+void WIDTH_SYMBOL(dispose_bfs_search)(void *search) {
+  dispose_BFSSearch((BFSSearch*)search);
+}
+
+
+/**
+   Find a pebbling of minimum cost in a single search, instead of a
+   new search for each bound. This is a bottleneck shortest path
+   search: the configurations are visited in order of the peak number
+   of pebbles along the path which reaches them, so the first final
+   configuration found has the smallest cost.
+
+   The priority queue is a bucket queue indexed by the peak: the
+   round with bound B visits the configurations of peak B, starting
+   from the ones with a move blocked in the previous round, and the
+   visited configurations are kept among rounds. The search stops as
+   soon as no configuration has a blocked move, so an unsatisfiable
+   instance does not need all the rounds up to the cap.
+
+   The pebbling found has minimum cost, but it is not necessarily the
+   shortest one with that cost.
+
+   @param min_bound a lower bound on the cost: the first round of the
+   search already uses this bound.
+
+   @param max_bound the maximum number of pebbles: configurations
+   with more pebbles are not explored.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(minimax_pebbling_strategy)(DAG *g,
+                                                  unsigned int min_bound,
+                                                  unsigned int max_bound,
+                                                  Boolean persistent_pebbling) {
+
+  if (min_bound < 1) min_bound=1;     /* No pebbling with zero pebbles */
+  if (max_bound < min_bound) { return NULL; }
+
+  BFSSearch *s=new_BFSSearch(g,max_bound,persistent_pebbling,BFS_MINIMAX);
+
+  for(unsigned int bound=min_bound; bound<=max_bound; bound++) {
+    if (explore_BFSSearch(s,bound)) break;
+    if (isemptyQ(s->blocked)) break;   /* No move needs more pebbles */
+  }
+
+  Pebbling *solution=solution_BFSSearch(s);
+  dispose_BFSSearch(s);
+  return solution;
+}
+
+
+/* External memory search
+
+   The levels of the breadth-first search are kept on disk, in a
+   scratch directory, as files of records sorted by configuration
+   (see compare_configurations). Level L+1 is computed from level L
+   in a single pass:
+
+   1. The records of level L are read in order and expanded. The
+      neighbors are collected in a buffer of bounded size, and each
+      time the buffer is full it is sorted and written as a run,
+      without repetitions.
+
+   2. The runs are merged, keeping one record for each configuration,
+      and the configurations found in the earlier levels are dropped
+      while the merge goes, by a scan of the sorted file which holds
+      them.
+
+   The moves of a configuration read from disk do not depend on the
+   pebbling which reached it (see unpack_PebbleRecord), so the search
+   is a plain breadth-first search in the graph of configurations.
+   In reversible pebbling each move can be undone, and every move
+   changes the number of pebbles by one: the configurations at level
+   L+1 which are not new are at level L-1, and this is the only
+   level to check. In the other games all the levels must be
+   checked, and they are merged in a single file after each level.
+
+   All levels are kept until the end of the search, since the
+   pebbling is reconstructed backward by looking up, level by level,
+   the configuration which precedes the final one. Each record keeps
+   the move which reached it from the previous level. */
+
+#define EXTERNAL_MERGE_WAYS  64          /* Runs merged at once */
+#define EXTERNAL_IO_BUFFER   (0x1UL << 16)
+
+typedef struct {
+
+  DAG     *g;
+  Boolean  persistent_pebbling;
+  unsigned int upper_bound;
+
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+
+  const char *directory;      /* Scratch directory */
+  long        tag;            /* Identifies the files of the search */
+  unsigned int levels;        /* Levels written on disk */
+  unsigned int files;         /* Runs created so far */
+
+  /* Neighbors of the current level, sorted when the buffer is full */
+  PebbleRecord *run;
+  size_t        run_size;
+  size_t        run_allocation;
+
+  FILE         *runs[EXTERNAL_MERGE_WAYS];
+  unsigned int  run_number;
+
+  /* The final configuration, and the one of the last level which
+     reaches it. */
+  Boolean      found;
+  PebbleRecord final;
+  PebbleRecord parent;
+
+} ExternalSearch;
+
+
+/* Order of the records by configuration, and among the records of the
+   same configuration by the move which reached it. */
+static inline int compare_configurations(const PebbleRecord *a,const PebbleRecord *b) {
+
+  int c=bt_compare(a->black_pebbled,b->black_pebbled);
+  if (c) return c;
+#if BLACK_WHITE_PEBBLING
+  c=bt_compare(a->white_pebbled,b->white_pebbled);
+  if (c) return c;
+#endif
+  return (int)(a->flags & RECORD_SINK_TOUCHED) - (int)(b->flags & RECORD_SINK_TOUCHED);
+}
+
+static int compare_records(const void *x,const void *y) {
+
+  const PebbleRecord *a=(const PebbleRecord*)x;
+  const PebbleRecord *b=(const PebbleRecord*)y;
+
+  int c=compare_configurations(a,b);
+  if (c) return c;
+  if (a->last_changed_vertex!=b->last_changed_vertex)
+    return a->last_changed_vertex < b->last_changed_vertex ? -1 : 1;
+  return (int)a->flags - (int)b->flags;
+}
+
+
+/* Name of a file of the search, e.g. of a level */
+static void scratch_name(const ExternalSearch *s,char *name,size_t size,
+                         const char *kind,unsigned int number) {
+  snprintf(name,size,"%s/pebble-%ld-%s%u",s->directory,s->tag,kind,number);
+}
+
+static FILE *open_scratch(const char *name,const char *mode) {
+
+  FILE *f=fopen(name,mode);
+  if (!f) {
+    fprintf(stderr,"Error in search procedure: can't open the scratch file %s.\n",name);
+    exit(EXIT_FAILURE);
+  }
+  setvbuf(f,NULL,_IOFBF,EXTERNAL_IO_BUFFER);
+  return f;
+}
+
+static inline void write_record(FILE *f,const PebbleRecord *r) {
+  if (fwrite(r,sizeof(PebbleRecord),1,f)!=1) {
+    fprintf(stderr,"Error in search procedure: can't write on the scratch directory.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static inline Boolean read_record(FILE *f,PebbleRecord *r) {
+  return fread(r,sizeof(PebbleRecord),1,f)==1;
+}
+
+/* A new scratch file, open for writing and then reading. It has no
+   name anymore once opened, so it disappears when closed. */
+static FILE *new_scratch(ExternalSearch *s) {
+
+  char name[FILENAME_MAX];
+  scratch_name(s,name,sizeof(name),"run",s->files++);
+  FILE *f=open_scratch(name,"w+b");
+  remove(name);
+  return f;
+}
+
+
+/* Merge sorted files, writing each configuration once (the smallest
+   record among the ones with the same configuration), and skipping
+   the configurations in the sorted file `old', if not NULL. The
+   inputs are read from the current position.
+
+   @return the number of records written */
+static size_t merge_records(FILE **inputs,unsigned int n,FILE *old,FILE *out) {
+
+  PebbleRecord head[EXTERNAL_MERGE_WAYS];
+  unsigned int heap[EXTERNAL_MERGE_WAYS];     /* Inputs by their head */
+  unsigned int heap_size=0;
+
+  PebbleRecord last,skip;
+  Boolean has_last=FALSE;
+  Boolean has_skip= old ? read_record(old,&skip) : FALSE;
+  size_t written=0;
+
+  assert(n<=EXTERNAL_MERGE_WAYS);
+  memset(&last,0,sizeof(last));
+
+  for(unsigned int i=0;i<n;i++) {
+    if (!read_record(inputs[i],&head[i])) continue;
+    /* Sift up */
+    size_t j=heap_size++;
+    for(; j>0 && compare_records(&head[i],&head[heap[(j-1)/2]])<0; j=(j-1)/2)
+      heap[j]=heap[(j-1)/2];
+    heap[j]=i;
+  }
+
+  while(heap_size>0) {
+
+    unsigned int i=heap[0];
+    PebbleRecord r=head[i];
+
+    /* Next record of the same input, then sift down */
+    if (!read_record(inputs[i],&head[i])) i=heap[--heap_size];
+    for(size_t j=0;;) {
+      size_t k=2*j+1;
+      if (k>=heap_size) { if (heap_size) heap[j]=i; break; }
+      if (k+1<heap_size && compare_records(&head[heap[k+1]],&head[heap[k]])<0) k++;
+      if (compare_records(&head[i],&head[heap[k]])<=0) { heap[j]=i; break; }
+      heap[j]=heap[k];
+      j=k;
+    }
+
+    if (has_last && compare_configurations(&last,&r)==0) continue;
+    last=r;
+    has_last=TRUE;
+
+    while(has_skip && compare_configurations(&skip,&r)<0) has_skip=read_record(old,&skip);
+    if (has_skip && compare_configurations(&skip,&r)==0) continue;
+
+    write_record(out,&r);
+    written++;
+  }
+  return written;
+}
+
+
+/* Sort the buffer of neighbors and write it as a new run. When there
+   are too many runs they are merged in a single one. */
+static void flush_run(ExternalSearch *s) {
+
+  if (s->run_size==0) return;
+
+  qsort(s->run,s->run_size,sizeof(PebbleRecord),compare_records);
+
+  if (s->run_number==EXTERNAL_MERGE_WAYS) {
+    FILE *merged=new_scratch(s);
+    for(unsigned int i=0;i<s->run_number;i++) rewind(s->runs[i]);
+    merge_records(s->runs,s->run_number,NULL,merged);
+    for(unsigned int i=0;i<s->run_number;i++) fclose(s->runs[i]);
+    s->runs[0]=merged;
+    s->run_number=1;
+  }
+
+  FILE *f=new_scratch(s);
+  for(size_t i=0;i<s->run_size;i++) {
+    if (i>0 && compare_configurations(&s->run[i-1],&s->run[i])==0) continue;
+    write_record(f,&s->run[i]);
+  }
+  s->runs[s->run_number++]=f;
+  s->run_size=0;
+}
+
+
+/* Expand the last level on disk, and write the next one.
+
+   @return the number of configurations in the new level, or zero if
+   a final configuration has been found */
+static size_t expand_ExternalSearch(ExternalSearch *s) {
+
+  DAG *g=s->g;
+  char name[FILENAME_MAX];
+  unsigned int level=s->levels-1;
+
+  PebbleRecord r;
+  PebbleConfiguration conf,next;
+  BitTuple moves;
+  Vertex   v;
+
+  scratch_name(s,name,sizeof(name),"level",level);
+  FILE *in=open_scratch(name,"rb");
+
+  while(read_record(in,&r)) {
+
+    unpack_PebbleRecord(g,&conf,&r);
+    assert(!s->isfinal(g,&conf));
+
+    for(moves=legalmoves(g,&conf,s->upper_bound); !bt_iszero(moves); bt_reset(&moves,v)) {
+
+      v=bt_lowest(moves);
+      if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next)) continue;
+
+      /* The records on disk are not indexed: any index but
+         NO_RECORD marks the configuration as not initial. */
+      next.previous_configuration = 0;
+      next.last_changed_vertex = v;
+
+      if (s->isfinal(g,&next)) {
+        pack_PebbleConfiguration(&s->final,&next);
+        s->parent=r;
+        s->found=TRUE;
+        break;
+      }
+
+      pack_PebbleConfiguration(&s->run[s->run_size++],&next);
+      if (s->run_size==s->run_allocation) flush_run(s);
+    }
+    if (s->found) break;
+  }
+  fclose(in);
+
+  size_t size=0;
+  if (!s->found) {
+
+    FILE *old=NULL;
+    flush_run(s);
+    for(unsigned int i=0;i<s->run_number;i++) rewind(s->runs[i]);
+
+#if REVERSIBLE_PEBBLING
+    if (level>0) {
+      scratch_name(s,name,sizeof(name),"level",level-1);
+      old=open_scratch(name,"rb");
+    }
+#else
+    scratch_name(s,name,sizeof(name),"visited",level);
+    old=open_scratch(name,"rb");   /* All the levels so far */
+#endif
+
+    scratch_name(s,name,sizeof(name),"level",level+1);
+    FILE *out=open_scratch(name,"wb");
+    size=merge_records(s->runs,s->run_number,old,out);
+    fclose(out);
+    if (old) fclose(old);
+    s->levels++;
+
+#if !REVERSIBLE_PEBBLING
+    /* Add the new level to the configurations visited so far */
+    FILE *inputs[2];
+    inputs[0]=open_scratch(name,"rb");
+    scratch_name(s,name,sizeof(name),"visited",level);
+    inputs[1]=open_scratch(name,"rb");
+    remove(name);
+    scratch_name(s,name,sizeof(name),"visited",level+1);
+    out=open_scratch(name,"wb");
+    merge_records(inputs,2,NULL,out);
+    fclose(out);
+    fclose(inputs[0]);
+    fclose(inputs[1]);
+#endif
+  }
+
+  for(unsigned int i=0;i<s->run_number;i++) fclose(s->runs[i]);
+  s->run_number=0;
+  return size;
+}
+
+
+/* Find the record of a configuration in the file of a level, by
+   bisection. The configuration must be there. */
+static void lookup_level(const ExternalSearch *s,unsigned int level,PebbleRecord *r) {
+
+  char name[FILENAME_MAX];
+  PebbleRecord probe;
+
+  scratch_name(s,name,sizeof(name),"level",level);
+  FILE *f=open_scratch(name,"rb");
+
+  fseek(f,0,SEEK_END);
+  long lo=0,hi=ftell(f)/(long)sizeof(PebbleRecord);
+
+  while(lo<hi) {
+    long mid=lo+(hi-lo)/2;
+    fseek(f,mid*(long)sizeof(PebbleRecord),SEEK_SET);
+    if (!read_record(f,&probe)) break;
+    int c=compare_configurations(&probe,r);
+    if (c==0) { *r=probe; fclose(f); return; }
+    if (c<0) lo=mid+1; else hi=mid;
+  }
+  fclose(f);
+  assert(0);   /* The previous configuration is always found */
+}
+
+
+/* Finalize a pebbling given by the records of its configurations,
+   from the initial one. The records are put in a dictionary, so that
+   the pebbling is finalized as in the search in memory. */
+static Pebbling *finalize_path(const DAG *g,Boolean persistent_pebbling,
+                               const PebbleRecord *path,size_t length) {
+
+  assert(path[0].flags & RECORD_INITIAL);
+
+  Arena *A=newAR(sizeof(PebbleRecord));
+  Dict  *D=newDict(length,A);
+  DictQueryResult res;
+  PebbleConfiguration conf;
+
+  for(size_t i=0;i<length;i++) {
+    PebbleRecord *r=(PebbleRecord*)allocAR(A);
+    *r=path[i];
+#if !MOVE_LOG
+    r->previous_configuration = (i==0) ? NO_RECORD : (RecordIndex)(i-1);
+#endif
+    unpack_PebbleRecord(g,&conf,r);
+    writeDict(D,&res,&conf,(RecordIndex)i);
+  }
+
+  Pebbling *solution;
+  if (persistent_pebbling)
+    solution=finalize_persistent_pebbling(g,D,(RecordIndex)(length-1));
+  else
+#if REVERSIBLE_PEBBLING
+    solution=finalize_reversible_pebbling(g,D,(RecordIndex)(length-1));
+#else
+    solution=finalize_pebbling(g,D,(RecordIndex)(length-1));
+#endif
+
+  disposeDict(D);
+  disposeAR(A);
+  return solution;
+}
+
+
+/* Rebuild the pebbling from the final configuration, going back one
+   level at a time. */
+static Pebbling *solution_ExternalSearch(ExternalSearch *s) {
+
+  if (!s->found) return NULL;
+
+  DAG *g=s->g;
+  unsigned int length=s->levels+1;
+  PebbleRecord *path=(PebbleRecord*)malloc(length*sizeof(PebbleRecord));
+  assert(path);
+
+  path[length-1]=s->final;
+  path[length-2]=s->parent;
+  for(unsigned int l=length-2;l>0;l--) {
+    undo_PebbleRecord(g,&path[l-1],&path[l]);
+    lookup_level(s,l-1,&path[l-1]);
+  }
+
+  Pebbling *solution=finalize_path(g,s->persistent_pebbling,path,length);
+  free(path);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with the levels of the search kept
+   on disk, so that the configurations visited may take much more
+   space than the memory. The pebbling found is a shortest one within
+   the bound, but it may differ from the one of the search in memory,
+   which skips some moves by its heuristics.
+
+   @param directory the scratch directory, where the files of the
+   search are created and then removed.
+
+   @param memory_bytes the memory used to sort the neighbors of a
+   level before they are written on disk.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(external_bfs_pebbling_strategy)(DAG *g,
+                                                       unsigned int upper_bound,
+                                                       Boolean persistent_pebbling,
+                                                       const char *directory,
+                                                       size_t memory_bytes) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = 0;
+#endif
+
+  ExternalSearch s;
+  char name[FILENAME_MAX];
+  FILE *f;
+
+  s.g = g;
+  s.persistent_pebbling = persistent_pebbling;
+  s.upper_bound = upper_bound;
+  s.isfinal = persistent_pebbling ? isfinal_persistent : isfinal_visiting;
+  s.directory = directory;
+  s.tag = (long)getpid();
+  s.levels = 0;
+  s.files = 0;
+  s.run_number = 0;
+  s.found = FALSE;
+
+  /* Each configuration has at most one neighbor per vertex */
+  s.run_allocation = memory_bytes/sizeof(PebbleRecord);
+  if (s.run_allocation < g->size) s.run_allocation = g->size;
+  s.run_size = 0;
+  s.run = (PebbleRecord*)malloc(s.run_allocation*sizeof(PebbleRecord));
+  assert(s.run);
+
+  /* The initial configuration is the first level */
+  PebbleConfiguration init;
+  PebbleRecord r;
+  init_PebbleConfiguration(g,&init);
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &init); }
+#endif
+  pack_PebbleConfiguration(&r,&init);
+
+  scratch_name(&s,name,sizeof(name),"level",0);
+  f=open_scratch(name,"wb");
+  write_record(f,&r);
+  fclose(f);
+  s.levels = 1;
+
+#if !REVERSIBLE_PEBBLING
+  scratch_name(&s,name,sizeof(name),"visited",0);
+  f=open_scratch(name,"wb");
+  write_record(f,&r);
+  fclose(f);
+#endif
+
+  while(expand_ExternalSearch(&s)>0);
+
+  Pebbling *solution=solution_ExternalSearch(&s);
+
+  /* Clean up the scratch directory */
+  for(unsigned int l=0;l<s.levels;l++) {
+    scratch_name(&s,name,sizeof(name),"level",l);
+    remove(name);
+  }
+  scratch_name(&s,name,sizeof(name),"visited",s.levels-1);
+  remove(name);
+  free(s.run);
+
+  return solution;
+}
+
+
+/* Search up to symmetries
+
+   The automorphisms of the graph map pebblings to pebblings, and
+   they fix the sink, so they map final configurations to final
+   configurations. The search keeps a single configuration for each
+   orbit of the automorphisms: each configuration reached is replaced
+   by its canonical image, obtained by applying the generators of the
+   automorphisms as long as the image gets smaller (in the order of
+   compare_configurations). The canonical image is not always the
+   smallest one of the orbit, so some orbits may get more than one
+   configuration, but any choice of the images gives a correct
+   search.
+
+   The heuristics of next_PebbleConfiguration compare the indices of
+   the vertices, which the automorphisms do not preserve, so the
+   configurations are expanded from their records, without them (see
+   unpack_PebbleRecord). The record of each configuration is stored
+   together with the index of the configuration which reached it.
+   The pebbling is rebuilt by finding again the moves between
+   consecutive configurations, and the automorphisms applied along
+   the way are undone. */
+
+typedef struct {
+
+  DAG     *g;
+  Boolean  persistent_pebbling;
+  unsigned int upper_bound;
+
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+
+  const Vertex *generators;   /* Images of the vertices, see automorphisms_DAG */
+  size_t        generator_number;
+
+  Arena   *A;                 /* Records of the canonical configurations */
+  Arena   *parents;           /* Index of the record which reached each one */
+  Dict    *D;
+
+  RecordIndex final;
+
+} SymmetricSearch;
+
+
+/* Image of a set of vertices */
+static inline BitTuple permute_tuple(const Vertex *map,BitTuple t) {
+
+  BitTuple image=bt_zero();
+  Vertex v;
+
+  for(; !bt_iszero(t); bt_reset(&t,v)) {
+    v=bt_lowest(t);
+    bt_set(&image,map[v]);
+  }
+  return image;
+}
+
+/* Image of a record */
+static inline void permute_record(const Vertex *map,PebbleRecord *r) {
+
+#if BLACK_WHITE_PEBBLING
+  r->white_pebbled = permute_tuple(map,r->white_pebbled);
+#endif
+  r->black_pebbled = permute_tuple(map,r->black_pebbled);
+  r->last_changed_vertex = (RecordVertex)map[r->last_changed_vertex];
+}
+
+/* Replace a record with its canonical image. The automorphism applied
+   is written in `map', if not NULL. */
+static void canonical_record(const SymmetricSearch *s,PebbleRecord *r,Vertex *map) {
+
+  size_t n=s->g->size;
+  PebbleRecord image;
+  Boolean smaller=TRUE;
+
+  if (map) for(Vertex v=0;v<n;v++) map[v]=v;
+
+  while(smaller) {
+    smaller=FALSE;
+    for(size_t i=0;i<s->generator_number;i++) {
+      const Vertex *generator=s->generators+i*n;
+
+      image=*r;
+      permute_record(generator,&image);
+      if (compare_configurations(&image,r) >= 0) continue;
+
+      *r=image;
+      smaller=TRUE;
+      if (map) for(Vertex v=0;v<n;v++) map[v]=generator[map[v]];
+    }
+  }
+}
+
+
+/* The breadth-first search on the canonical configurations. The
+   records in the arena are in order of distance from the initial
+   configuration, so they are expanded in the order they are stored.
+
+   @return TRUE if a final configuration has been found */
+static Boolean explore_SymmetricSearch(SymmetricSearch *s) {
+
+  DAG *g=s->g;
+  DictQueryResult res;
+  PebbleConfiguration conf,next;
+  PebbleRecord r;
+  BitTuple moves;
+  Vertex   v;
+
+  for(RecordIndex i=0; i<sizeAR(s->A); i++) {
+
+    unpack_PebbleRecord(g,&conf,(const PebbleRecord*)atAR(s->A,i));
+
+    for(moves=legalmoves(g,&conf,s->upper_bound); !bt_iszero(moves); bt_reset(&moves,v)) {
+
+      v=bt_lowest(moves);
+      if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next)) continue;
+
+      next.previous_configuration = i;
+      next.last_changed_vertex = v;
+      Boolean final=s->isfinal(g,&next);
+
+      pack_PebbleConfiguration(&r,&next);
+      canonical_record(s,&r,NULL);
+
+      /* Only the pebbles and the sink are used by the dictionary */
+#if BLACK_WHITE_PEBBLING
+      next.white_pebbled = r.white_pebbled;
+#endif
+      next.black_pebbled = r.black_pebbled;
+      queryDict(s->D,&res,&next);
+      if (res.index!=NO_RECORD) continue;
+
+      if (sizeAR(s->A) >= NO_RECORD) {
+        fprintf(stderr,
+                "Error in search procedure: too many configurations "
+                "for the optimized data structures.");
+        exit(EXIT_FAILURE);
+      }
+      *(PebbleRecord*)allocAR(s->A) = r;
+      *(RecordIndex*)allocAR(s->parents) = i;
+      unsafe_noquery_writeDict(s->D,&res,(RecordIndex)(sizeAR(s->A)-1));
+
+      if (final) {
+        s->final = (RecordIndex)(sizeAR(s->A)-1);
+        return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+
+/* Rebuild the pebbling from the chain of canonical configurations.
+   Each one is the image by some automorphism of a configuration
+   reached by a move from the previous one: the move is found again,
+   together with the automorphism, and the moves are mapped by the
+   composition of the inverses of the automorphisms met so far. */
+static Pebbling *solution_SymmetricSearch(SymmetricSearch *s) {
+
+  if (s->final==NO_RECORD) return NULL;
+
+  DAG *g=s->g;
+  size_t n=g->size;
+  size_t length=0;
+
+  for(RecordIndex i=s->final; i!=NO_RECORD; i=*(RecordIndex*)atAR(s->parents,i)) length++;
+
+  RecordIndex  *chain=(RecordIndex*)malloc(length*sizeof(RecordIndex));
+  PebbleRecord *path =(PebbleRecord*)malloc(length*sizeof(PebbleRecord));
+  Vertex       *maps =(Vertex*)malloc(3*n*sizeof(Vertex));
+  assert(chain && path && maps);
+
+  Vertex *back=maps;          /* Maps the canonical configuration to the pebbling */
+  Vertex *sigma=maps+n;       /* Automorphism applied after a move */
+  Vertex *t=maps+2*n;
+
+  size_t k=length;
+  for(RecordIndex i=s->final; i!=NO_RECORD; i=*(RecordIndex*)atAR(s->parents,i)) chain[--k]=i;
+  assert(k==0 && chain[0]==0);
+
+  for(Vertex v=0;v<n;v++) back[v]=v;
+  path[0]=*(const PebbleRecord*)atAR(s->A,0);
+
+  PebbleConfiguration conf,next;
+  PebbleRecord r;
+  BitTuple moves;
+  Vertex   v;
+
+  for(size_t i=0;i+1<length;i++) {
+
+    const PebbleRecord *target=(const PebbleRecord*)atAR(s->A,chain[i+1]);
+    Boolean found=FALSE;
+
+    unpack_PebbleRecord(g,&conf,(const PebbleRecord*)atAR(s->A,chain[i]));
+    for(moves=legalmoves(g,&conf,s->upper_bound); !found && !bt_iszero(moves); bt_reset(&moves,v)) {
+
+      v=bt_lowest(moves);
+      if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next)) continue;
+
+      next.previous_configuration = chain[i];
+      next.last_changed_vertex = v;
+      pack_PebbleConfiguration(&r,&next);
+      canonical_record(s,&r,sigma);
+      found = (compare_configurations(&r,target)==0);
+    }
+    assert(found);
+
+    /* The configuration reached is the image of r by back, composed
+       with the inverse of sigma */
+    for(Vertex w=0;w<n;w++) t[sigma[w]]=back[w];
+    memcpy(back,t,n*sizeof(Vertex));
+
+    path[i+1]=r;
+    permute_record(back,&path[i+1]);
+  }
+
+  Pebbling *solution=finalize_path(g,s->persistent_pebbling,path,length);
+
+  free(maps);
+  free(path);
+  free(chain);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, keeping a single configuration for
+   each orbit of the automorphisms of the graph. The pebbling found
+   is a shortest one within the bound, but it may differ from the one
+   of bfs_pebbling_strategy, which skips some moves by its
+   heuristics.
+
+   @param generators the generators of the automorphisms, see
+   automorphisms_DAG.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(symmetric_bfs_pebbling_strategy)(DAG *g,
+                                                        unsigned int upper_bound,
+                                                        Boolean persistent_pebbling,
+                                                        const Vertex *generators,
+                                                        size_t generator_number) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = 0;
+#endif
+
+  SymmetricSearch s;
+
+  s.g = g;
+  s.persistent_pebbling = persistent_pebbling;
+  s.upper_bound = upper_bound;
+  s.isfinal = persistent_pebbling ? isfinal_persistent : isfinal_visiting;
+  s.generators = generators;
+  s.generator_number = generator_number;
+  s.A = newAR(sizeof(PebbleRecord));
+  s.parents = newAR(sizeof(RecordIndex));
+  s.D = newDict(0,s.A);
+  s.final = NO_RECORD;
+
+  /* The initial configuration is fixed by the automorphisms */
+  PebbleConfiguration init;
+  DictQueryResult res;
+  init_PebbleConfiguration(g,&init);
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &init); }
+#endif
+  assert(!s.isfinal(g,&init));
+  pack_PebbleConfiguration((PebbleRecord*)allocAR(s.A),&init);
+  *(RecordIndex*)allocAR(s.parents) = NO_RECORD;
+  writeDict(s.D,&res,&init,0);
+
+  explore_SymmetricSearch(&s);
+  Pebbling *solution=solution_SymmetricSearch(&s);
+
+  disposeDict(s.D);
+  disposeAR(s.parents);
+  disposeAR(s.A);
+  return solution;
+}
+
+
+/* Search with the visited configurations in a ZDD
+
+   The configurations visited are kept as a family of sets in a
+   zero-suppressed decision diagram (see zdd.h), instead of a
+   dictionary of records: a configuration is the set of its pebbles,
+   with the sink touched as one more item. Only the records of the
+   last level and of the next one are kept, to be expanded, and the
+   neighbors already visited are discarded by a query to the diagram.
+
+   Each level is kept as a family in the diagram as well, and the
+   visited configurations are the union of the levels. The pebbling
+   is rebuilt backward from the final configuration by looking, among
+   the configurations which differ on a single vertex, for the one in
+   the previous level which reaches it by a move. As in the search on
+   disk, the configurations are expanded from their records, without
+   the heuristics which depend on the pebbling which reached them. */
+
+typedef struct {
+
+  DAG     *g;
+  Boolean  persistent_pebbling;
+  unsigned int upper_bound;
+
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+
+  ZDD     *Z;
+  ZDDNode *roots;             /* The visited configurations, then each level */
+  size_t   root_allocation;
+  unsigned int levels;        /* Levels so far */
+  size_t   visited;           /* Configurations visited */
+
+  Arena   *current;           /* Records of the last level */
+  uint32_t *items;
+
+  /* The final configuration, and the one of the last level which
+     reaches it. */
+  Boolean      found;
+  PebbleRecord final;
+  PebbleRecord parent;
+
+} ZDDSearch;
+
+
+/* The set of a configuration: the item 2v for a black pebble on v,
+   2v+1 for a white one, and 2n for the sink touched. */
+static size_t zdd_items(const DAG *g,const PebbleRecord *r,uint32_t *items) {
+
+  size_t n=0;
+  Vertex v;
+#if BLACK_WHITE_PEBBLING
+  BitTuple pebbled=bt_or(r->black_pebbled,r->white_pebbled);
+#else
+  BitTuple pebbled=r->black_pebbled;
+#endif
+
+  for(; !bt_iszero(pebbled); bt_reset(&pebbled,v)) {
+    v=bt_lowest(pebbled);
+#if BLACK_WHITE_PEBBLING
+    items[n++] = 2*(uint32_t)v + (bt_get(r->white_pebbled,v) ? 1 : 0);
+#else
+    items[n++] = 2*(uint32_t)v;
+#endif
+  }
+  if (r->flags & RECORD_SINK_TOUCHED) items[n++] = 2*(uint32_t)g->size;
+  return n;
+}
+
+
+/* Expand the last level, and build the next one.
+
+   @return the number of configurations in the new level, or zero if
+   a final configuration has been found */
+static size_t expand_ZDDSearch(ZDDSearch *s) {
+
+  DAG *g=s->g;
+  Arena *next_level=newAR(sizeof(PebbleRecord));
+  PebbleConfiguration conf,next;
+  PebbleRecord r,q;
+  BitTuple moves;
+  Vertex   v;
+  size_t   n;
+
+  if (s->levels+2 > s->root_allocation) {
+    s->root_allocation *= 2;
+    s->roots = (ZDDNode*)realloc(s->roots,s->root_allocation*sizeof(ZDDNode));
+    assert(s->roots);
+  }
+  ZDDNode *level=&s->roots[1+s->levels];
+  *level = ZDD_EMPTY;
+
+  for(size_t i=0; i<sizeAR(s->current) && !s->found; i++) {
+
+    r=*(const PebbleRecord*)atAR(s->current,i);
+    unpack_PebbleRecord(g,&conf,&r);
+    assert(!s->isfinal(g,&conf));
+
+    for(moves=legalmoves(g,&conf,s->upper_bound); !bt_iszero(moves); bt_reset(&moves,v)) {
+
+      v=bt_lowest(moves);
+      if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next)) continue;
+
+      /* The records are not indexed: any index but NO_RECORD marks
+         the configuration as not initial. */
+      next.previous_configuration = 0;
+      next.last_changed_vertex = v;
+
+      if (s->isfinal(g,&next)) {
+        pack_PebbleConfiguration(&s->final,&next);
+        s->parent=r;
+        s->found=TRUE;
+        break;
+      }
+
+      pack_PebbleConfiguration(&q,&next);
+      n=zdd_items(g,&q,s->items);
+      if (memberZDD(s->Z,s->roots[0],s->items,n)) continue;
+      if (memberZDD(s->Z,*level,s->items,n)) continue;
+
+      *level=insertZDD(s->Z,*level,s->items,n);
+      *(PebbleRecord*)allocAR(next_level)=q;
+      collectZDD(s->Z,s->roots,s->levels+2);
+    }
+  }
+
+  disposeAR(s->current);
+  s->current=next_level;
+  if (s->found) return 0;
+
+  s->roots[0]=unionZDD(s->Z,s->roots[0],*level);
+  s->levels++;
+  s->visited += sizeAR(s->current);
+  collectZDD(s->Z,s->roots,s->levels+1);
+  return sizeAR(s->current);
+}
+
+
+/* Find a configuration of `level' which reaches `c' by a move, and
+   write it in `p'. The move is written in `c'. */
+static void previous_ZDDSearch(const ZDDSearch *s,unsigned int level,
+                               PebbleRecord *c,PebbleRecord *p) {
+
+  DAG *g=s->g;
+  ZDDNode f=s->roots[1+level];
+  PebbleConfiguration conf,next;
+  PebbleRecord q;
+  Boolean touched=(c->flags & RECORD_SINK_TOUCHED) ? TRUE : FALSE;
+
+  /* The vertex of the move, its state before it (empty, black or
+     white), and whether the move touched the sink */
+  for(Vertex v=0;v<g->size;v++)
+    for(int state=0;state<(BLACK_WHITE_PEBBLING ? 3 : 2);state++)
+      for(int first_touch=0;first_touch<2;first_touch++) {
+
+        if (first_touch && !(touched && v==g->sinks[0])) continue;
+
+        *p=*c;
+        p->last_changed_vertex = 0;
+        p->flags = (touched && !first_touch) ? RECORD_SINK_TOUCHED : 0x0;
+        bt_reset(&p->black_pebbled,v);
+#if BLACK_WHITE_PEBBLING
+        bt_reset(&p->white_pebbled,v);
+        if (state==2) bt_set(&p->white_pebbled,v);
+#endif
+        if (state==1) bt_set(&p->black_pebbled,v);
+        if (compare_configurations(p,c)==0) continue;
+
+        size_t n=zdd_items(g,p,s->items);
+        if (!memberZDD(s->Z,f,s->items,n)) continue;
+
+        unpack_PebbleRecord(g,&conf,p);
+        if (!bt_get(legalmoves(g,&conf,s->upper_bound),v)) continue;
+        if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next)) continue;
+        next.previous_configuration = 0;
+        next.last_changed_vertex = v;
+        pack_PebbleConfiguration(&q,&next);
+        if (compare_configurations(&q,c)!=0) continue;
+
+        *c=q;
+        return;
+      }
+
+  assert(0);   /* The previous configuration is always found */
+}
+
+
+/* Rebuild the pebbling from the final configuration, going back one
+   level at a time. */
+static Pebbling *solution_ZDDSearch(ZDDSearch *s,const PebbleRecord *start) {
+
+  if (!s->found) return NULL;
+
+  unsigned int length=s->levels+1;
+  PebbleRecord *path=(PebbleRecord*)malloc(length*sizeof(PebbleRecord));
+  assert(path);
+
+  path[length-1]=s->final;
+  path[length-2]=s->parent;
+  for(unsigned int l=length-2;l>0;l--) previous_ZDDSearch(s,l-1,&path[l],&path[l-1]);
+
+  assert(compare_configurations(&path[0],start)==0);
+  path[0]=*start;
+
+  Pebbling *solution=finalize_path(s->g,s->persistent_pebbling,path,length);
+  free(path);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with the visited configurations kept
+   in a zero-suppressed decision diagram. The pebbling found is a
+   shortest one within the bound, but it may differ from the one of
+   the search with a dictionary, which skips some moves by its
+   heuristics. The size of the diagram is printed as a comment, next
+   to the size of a dictionary of the same configurations.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(zdd_bfs_pebbling_strategy)(DAG *g,
+                                                  unsigned int upper_bound,
+                                                  Boolean persistent_pebbling) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = 0;
+#endif
+
+  ZDDSearch s;
+
+  s.g = g;
+  s.persistent_pebbling = persistent_pebbling;
+  s.upper_bound = upper_bound;
+  s.isfinal = persistent_pebbling ? isfinal_persistent : isfinal_visiting;
+  s.Z = newZDD();
+  s.root_allocation = 16;
+  s.roots = (ZDDNode*)malloc(s.root_allocation*sizeof(ZDDNode));
+  s.items = (uint32_t*)malloc((g->size+1)*sizeof(uint32_t));
+  s.current = newAR(sizeof(PebbleRecord));
+  s.found = FALSE;
+  assert(s.roots && s.items);
+
+  /* The initial configuration is the first level */
+  PebbleConfiguration init;
+  PebbleRecord start;
+  init_PebbleConfiguration(g,&init);
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &init); }
+#endif
+  pack_PebbleConfiguration(&start,&init);
+  *(PebbleRecord*)allocAR(s.current)=start;
+
+  size_t n=zdd_items(g,&start,s.items);
+  s.roots[0] = insertZDD(s.Z,ZDD_EMPTY,s.items,n);
+  s.roots[1] = s.roots[0];
+  s.levels = 1;
+  s.visited = 1;
+
+  while(expand_ZDDSearch(&s)>0);
+
+  Pebbling *solution=solution_ZDDSearch(&s,&start);
+
+  /* A dictionary of the configurations visited keeps their records,
+     in slots which are at most 3/4 full */
+  size_t slots=DICT_MIN_ALLOCATION;
+  while (4*s.visited > 3*slots) slots*=2;
+  printf("c Visited %lu configurations: %lu nodes in the ZDD (%lu bytes, at most %lu nodes), "
+         "%lu bytes in a dictionary\n",
+         (unsigned long)s.visited,
+         (unsigned long)nodecountZDD(s.Z,s.roots[0]),
+         (unsigned long)memoryZDD(s.Z),
+         (unsigned long)s.Z->peak,
+         (unsigned long)(s.visited*sizeof(PebbleRecord)+slots*sizeof(DictEntry)));
+
+  disposeAR(s.current);
+  free(s.items);
+  free(s.roots);
+  disposeZDD(s.Z);
+  return solution;
+}
@@ -22,8 +22,103 @@
 
 
 /* Code */
+
+/* Chooses the build of the search for the size of the graph */
 extern Pebbling* bfs_pebbling_strategy(DAG *digraph,
                                        unsigned int upper_bound,
                                        Boolean persistent_pebbling);
 
+/* Same, with the search run by several threads */
+extern Pebbling* parallel_bfs_pebbling_strategy(DAG *digraph,
+                                                unsigned int upper_bound,
+                                                Boolean persistent_pebbling,
+                                                unsigned int threads);
+
+/* Same, giving up as soon as `*cancel' is set */
+extern Pebbling* cancellable_bfs_pebbling_strategy(DAG *digraph,
+                                                   unsigned int upper_bound,
+                                                   Boolean persistent_pebbling,
+                                                   const int *cancel);
+
+/* Same, with the levels of the search kept in a scratch directory */
+extern Pebbling* external_bfs_pebbling_strategy(DAG *digraph,
+                                                unsigned int upper_bound,
+                                                Boolean persistent_pebbling,
+                                                const char *directory,
+                                                size_t memory_bytes);
+
+/* Same, keeping one configuration for each orbit of the automorphisms
+   given by `generators' (see automorphisms_DAG) */
+extern Pebbling* symmetric_bfs_pebbling_strategy(DAG *digraph,
+                                                 unsigned int upper_bound,
+                                                 Boolean persistent_pebbling,
+                                                 const Vertex *generators,
+                                                 size_t generator_number);
+
+/* Same, exploring a single order of the independent moves */
+extern Pebbling* reduced_bfs_pebbling_strategy(DAG *digraph,
+                                               unsigned int upper_bound,
+                                               Boolean persistent_pebbling);
+
+/* Same, with the visited configurations kept in a ZDD */
+extern Pebbling* zdd_bfs_pebbling_strategy(DAG *digraph,
+                                           unsigned int upper_bound,
+                                           Boolean persistent_pebbling);
+
+/* Same, for the search of a pebbling of minimum cost */
+extern Pebbling* minimax_pebbling_strategy(DAG *digraph,
+                                           unsigned int min_bound,
+                                           unsigned int max_bound,
+                                           Boolean persistent_pebbling);
+
+/* Builds of the search for configurations of 16, 32, 64 and
+   64*WIDE_WORDS vertices (see bittuple.h). Each build provides a
+   search from scratch (also in a parallel, in a cancellable, in an
+   external memory, in a symmetry reduced, in a partial order reduced
+   and in a ZDD version), a search which
+   can be resumed with larger bounds (see search.h) and a search for
+   the minimum cost. */
+#define BFS_DECLARE_WIDTH(suffix)                                       \
+  extern Pebbling* bfs_pebbling_strategy_##suffix(DAG *digraph,         \
+                                                  unsigned int upper_bound, \
+                                                  Boolean persistent_pebbling); \
+  extern void*     new_bfs_search_##suffix(DAG *digraph,                \
+                                           unsigned int max_bound,      \
+                                           Boolean persistent_pebbling); \
+  extern Pebbling* resume_bfs_search_##suffix(void *search,unsigned int upper_bound); \
+  extern void      dispose_bfs_search_##suffix(void *search);  \
+  extern Pebbling* parallel_bfs_pebbling_strategy_##suffix(DAG *digraph, \
+                                                           unsigned int upper_bound, \
+                                                           Boolean persistent_pebbling, \
+                                                           unsigned int threads); \
+  extern Pebbling* cancellable_bfs_pebbling_strategy_##suffix(DAG *digraph, \
+                                                              unsigned int upper_bound, \
+                                                              Boolean persistent_pebbling, \
+                                                              const int *cancel); \
+  extern Pebbling* external_bfs_pebbling_strategy_##suffix(DAG *digraph, \
+                                                           unsigned int upper_bound, \
+                                                           Boolean persistent_pebbling, \
+                                                           const char *directory, \
+                                                           size_t memory_bytes); \
+  extern Pebbling* symmetric_bfs_pebbling_strategy_##suffix(DAG *digraph, \
+                                                            unsigned int upper_bound, \
+                                                            Boolean persistent_pebbling, \
+                                                            const Vertex *generators, \
+                                                            size_t generator_number); \
+  extern Pebbling* reduced_bfs_pebbling_strategy_##suffix(DAG *digraph, \
+                                                          unsigned int upper_bound, \
+                                                          Boolean persistent_pebbling); \
+  extern Pebbling* zdd_bfs_pebbling_strategy_##suffix(DAG *digraph,     \
+                                                      unsigned int upper_bound, \
+                                                      Boolean persistent_pebbling); \
+  extern Pebbling* minimax_pebbling_strategy_##suffix(DAG *digraph,     \
+                                                      unsigned int min_bound, \
+                                                      unsigned int max_bound, \
+                                                      Boolean persistent_pebbling);
+
+BFS_DECLARE_WIDTH(w16)
+BFS_DECLARE_WIDTH(w32)
+BFS_DECLARE_WIDTH(w64)
+BFS_DECLARE_WIDTH(wide)
+
 #endif /* BFS_H */
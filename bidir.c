@@ -0,0 +1,346 @@
+/*
+   Description::
+
+   Bidirectional breadth-first search for a pebbling within a bound.
+
+   Every goal configuration of the search (see isfinal_visiting and
+   isfinal_persistent) reaches the empty configuration with the sink
+   touched by the clean up appended to the pebbling, or in reversible
+   pebbling by the moves done backward. So the search looks for a
+   shortest path from the initial configuration to that single one:
+   a search goes forward from the initial configuration, a search
+   goes backward from the final one, and each step expands a whole
+   level of the side with the smaller frontier. The pebbling is found
+   as soon as a configuration is reached by both sides, and it is a
+   shortest one, since the sides have already covered the shorter
+   paths when the levels are expanded entirely.
+
+   In reversible pebbling a move can be undone, and in black-white
+   pebbling a move can be undone by the dual move. In general the
+   configurations which precede a given one are found by changing a
+   single vertex, and by checking that the move on the vertex leads
+   back to the configuration.
+
+   The configurations are expanded from their records, so the
+   heuristics which depend on the pebbling which reached a
+   configuration are not used (see unpack_PebbleRecord).
+
+   This file is compiled once for each width of the configurations
+   (see bittuple.h), and bidirectional_pebbling_strategy chooses the
+   build according to the size of the graph.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "common.h"
+#include "dag.h"
+#include "dsbasic.h"
+#include "pebbling.h"
+#include "configuration.h"
+#include "hashtable.h"
+#include "bidir.h"
+
+
+/* Code */
+
+#define FORWARD   0
+#define BACKWARD  1
+
+/* The configurations reached by one side of the search. Each one has
+   a record in the arena, indexed by the dictionary, and the index of
+   the record of the configuration it has been reached from, which is
+   NO_RECORD for the one the side starts from. The record keeps the
+   vertex of the move between the two. */
+typedef struct {
+
+  Arena *A;
+  Arena *parents;     /* RecordIndex, one for each record */
+  Dict  *D;
+  Queue *Q;           /* Records of the frontier */
+
+} Side;
+
+/* State of the search: the two sides, and the configuration where
+   they meet, with its record in each side. */
+typedef struct {
+
+  DAG         *g;
+  unsigned int upper_bound;
+  Boolean      start_touched;   /* The sink is touched from the start */
+
+  Side         side[2];
+  RecordIndex  meeting[2];
+
+} BidirectionalSearch;
+
+
+static void init_Side(Side *s) {
+  s->A       = newAR(sizeof(PebbleRecord));
+  s->parents = newAR(sizeof(RecordIndex));
+  s->D       = newDict(0,s->A);
+  s->Q       = newQ(sizeof(RecordIndex));
+}
+
+static void dispose_Side(Side *s) {
+  disposeQ(s->Q);
+  disposeDict(s->D);
+  disposeAR(s->parents);
+  disposeAR(s->A);
+}
+
+static inline RecordIndex parent_Side(Side *s,RecordIndex index) {
+  return *(RecordIndex*)atAR(s->parents,index);
+}
+
+/* Store a configuration not reached yet by the side, and put it in
+   the frontier. The query must have been done on the dictionary of
+   the side. */
+static RecordIndex add_Side(Side *s,DictQueryResult *res,
+                            const PebbleConfiguration *c,RecordIndex parent) {
+
+  assert(res->index==NO_RECORD);
+
+  if (sizeAR(s->A) >= NO_RECORD) {
+    fprintf(stderr,
+            "Error in search procedure: too many configurations "
+            "for the optimized data structures.");
+    exit(EXIT_FAILURE);
+  }
+  pack_PebbleConfiguration((PebbleRecord*)allocAR(s->A),c);
+  *(RecordIndex*)allocAR(s->parents) = parent;
+
+  RecordIndex index=(RecordIndex)(sizeAR(s->A)-1);
+  unsafe_noquery_writeDict(s->D,res,index);
+  *(RecordIndex*)enqueueQ(s->Q) = index;
+  return index;
+}
+
+
+/* The configurations which reach `c' by a move on `v', with at most
+   `bound' pebbles. A pebble on `v' has been placed, maybe touching
+   the sink for the first time, otherwise a pebble of either color has
+   been removed.
+
+   @return the number of configurations written in `out' (at most 2) */
+static unsigned int predecessors(const BidirectionalSearch *s,
+                                 const PebbleRecord *r,const PebbleConfiguration *c,
+                                 Vertex v,PebbleConfiguration *out) {
+
+  const DAG *g=s->g;
+  PebbleRecord candidates[2];
+  PebbleRecord q=*r;
+  PebbleConfiguration p,n;
+  unsigned int k=0,found=0;
+
+  if (ispebbled(v,g,c)) {
+    bt_reset(&q.black_pebbled,v);
+#if BLACK_WHITE_PEBBLING
+    bt_reset(&q.white_pebbled,v);
+#endif
+    candidates[k++]=q;
+    if (v==g->sinks[0] && !s->start_touched) {
+      q.flags &= (uint8_t)~RECORD_SINK_TOUCHED;
+      candidates[k++]=q;
+    }
+  } else {
+    bt_set(&q.black_pebbled,v);
+    candidates[k++]=q;
+#if BLACK_WHITE_PEBBLING
+    q=*r;
+    bt_set(&q.white_pebbled,v);
+    candidates[k++]=q;
+#endif
+  }
+
+  for(unsigned int i=0;i<k;i++) {
+
+    if (!isconsistent_PebbleRecord(g,&candidates[i])) continue;
+    if (recordcost(&candidates[i]) > (int)s->upper_bound) continue;
+
+    unpack_PebbleRecord(g,&p,&candidates[i]);
+    if (!next_PebbleConfiguration(v,g,&p,s->upper_bound,&n)) continue;
+    if (!match_configurationsDict(&n,c)) continue;
+
+    out[found]=p;
+    out[found].last_changed_vertex=v;
+    found++;
+  }
+  return found;
+}
+
+
+/* Expand the frontier of a side by a whole level.
+
+   @return TRUE if the sides meet */
+static Boolean expand_Side(BidirectionalSearch *s,int k) {
+
+  DAG  *g=s->g;
+  Side *side=&s->side[k];
+  Side *other=&s->side[1-k];
+
+  PebbleConfiguration conf,next[2];
+  PebbleRecord r;
+  DictQueryResult res;
+  RecordIndex index,added;
+  BitTuple moves;
+  Vertex   v;
+  unsigned int n;
+
+  for(size_t level=lengthQ(side->Q); level>0; level--,popQ(side->Q)) {
+
+    index=*(RecordIndex*)frontQ(side->Q);
+    r=*(PebbleRecord*)atAR(side->A,index);
+    unpack_PebbleRecord(g,&conf,&r);
+
+    moves = (k==FORWARD) ? legalmoves(g,&conf,s->upper_bound) : bt_prefix(g->size);
+
+    for(; !bt_iszero(moves); bt_reset(&moves,v)) {
+
+      v=bt_lowest(moves);
+
+      if (k==FORWARD) {
+        n=next_PebbleConfiguration(v,g,&conf,s->upper_bound,&next[0]) ? 1 : 0;
+        next[0].last_changed_vertex=v;
+      } else {
+        n=predecessors(s,&r,&conf,v,next);
+      }
+
+      for(unsigned int i=0;i<n;i++) {
+
+        /* The records are not meant to be undone: any index but
+           NO_RECORD marks the configuration as not initial. */
+        next[i].previous_configuration = index;
+
+        queryDict(side->D,&res,&next[i]);
+        if (res.index!=NO_RECORD) continue;
+        added=add_Side(side,&res,&next[i],index);
+
+        queryDict(other->D,&res,&next[i]);
+        if (res.index!=NO_RECORD) {
+          s->meeting[k]   = added;
+          s->meeting[1-k] = res.index;
+          return TRUE;
+        }
+      }
+    }
+  }
+  return FALSE;
+}
+
+
+/* Number of moves from a record to the configuration its side starts
+   from, and the largest number of pebbles along the way. */
+static size_t distance_Side(Side *s,RecordIndex index,int *cost) {
+
+  size_t d=0;
+  for(; index!=NO_RECORD; index=parent_Side(s,index)) {
+    *cost=MAX(*cost,recordcost((PebbleRecord*)atAR(s->A,index)));
+    d++;
+  }
+  return d-1;
+}
+
+/* The pebbling through the configuration where the sides meet. The
+   path of the forward side is read backward, and the one of the
+   backward side is read forward. A persistent pebbling is found
+   backward (see finalize_persistent_pebbling), so it is reversed. */
+static Pebbling *solution_BidirectionalSearch(BidirectionalSearch *s,Boolean persistent_pebbling) {
+
+  Side *f=&s->side[FORWARD];
+  Side *b=&s->side[BACKWARD];
+  RecordIndex index;
+  int cost=0;
+
+  size_t head=distance_Side(f,s->meeting[FORWARD],&cost);
+  size_t tail=distance_Side(b,s->meeting[BACKWARD],&cost);
+
+  Pebbling *solution=new_Pebbling(head+tail);
+  solution->length = head+tail;
+  solution->cost   = cost;
+
+  size_t i=head;
+  for(index=s->meeting[FORWARD]; parent_Side(f,index)!=NO_RECORD; index=parent_Side(f,index))
+    solution->steps[--i]=((PebbleRecord*)atAR(f->A,index))->last_changed_vertex;
+  assert(i==0);
+
+  i=head;
+  for(index=s->meeting[BACKWARD]; parent_Side(b,index)!=NO_RECORD; index=parent_Side(b,index))
+    solution->steps[i++]=((PebbleRecord*)atAR(b->A,index))->last_changed_vertex;
+  assert(i==head+tail);
+
+  if (persistent_pebbling) {
+    for(size_t j=0;j<solution->length/2;j++) {
+      Vertex t=solution->steps[j];
+      solution->steps[j]=solution->steps[solution->length-1-j];
+      solution->steps[solution->length-1-j]=t;
+    }
+  }
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with a bidirectional search. The
+   pebbling found is a shortest one within the bound which ends with
+   no pebbles (or with a pebble on the sink, if it is persistent),
+   and it may differ from the one of bfs_pebbling_strategy.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(bidirectional_pebbling_strategy)(DAG *g,
+                                                        unsigned int upper_bound,
+                                                        Boolean persistent_pebbling) {
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = 0;
+#endif
+
+  BidirectionalSearch s;
+  PebbleConfiguration start,final;
+  DictQueryResult res;
+
+  init_PebbleConfiguration(g,&start);
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &start); }
+#endif
+  assert(!(persistent_pebbling ? isfinal_persistent(g,&start) : isfinal_visiting(g,&start)));
+  init_PebbleConfiguration(g,&final);
+  final.sink_touched = TRUE;
+
+  s.g = g;
+  s.upper_bound = upper_bound;
+  s.start_touched = start.sink_touched;
+  s.meeting[FORWARD] = s.meeting[BACKWARD] = NO_RECORD;
+
+  init_Side(&s.side[FORWARD]);
+  init_Side(&s.side[BACKWARD]);
+  queryDict(s.side[FORWARD].D,&res,&start);
+  add_Side(&s.side[FORWARD],&res,&start,NO_RECORD);
+  queryDict(s.side[BACKWARD].D,&res,&final);
+  add_Side(&s.side[BACKWARD],&res,&final,NO_RECORD);
+
+  /* The side with fewer configurations to expand goes on */
+  Boolean met=FALSE;
+  while(!met && !isemptyQ(s.side[FORWARD].Q) && !isemptyQ(s.side[BACKWARD].Q)) {
+    if (lengthQ(s.side[FORWARD].Q) <= lengthQ(s.side[BACKWARD].Q))
+      met=expand_Side(&s,FORWARD);
+    else
+      met=expand_Side(&s,BACKWARD);
+  }
+
+  Pebbling *solution = met ? solution_BidirectionalSearch(&s,persistent_pebbling) : NULL;
+
+  dispose_Side(&s.side[FORWARD]);
+  dispose_Side(&s.side[BACKWARD]);
+  return solution;
+}
@@ -0,0 +1,40 @@
+/*
+   Description::
+
+   Bidirectional search for a pebbling within a bound: one search
+   goes forward from the initial configuration, another one backward
+   from the final configuration, and the pebbling is found where they
+   meet.
+
+*/
+
+
+/* Preamble */
+#ifndef  BIDIR_H
+#define  BIDIR_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+/* Chooses the build of the search for the size of the graph */
+extern Pebbling* bidirectional_pebbling_strategy(DAG *digraph,
+                                                 unsigned int upper_bound,
+                                                 Boolean persistent_pebbling);
+
+/* Builds of the search for configurations of 16, 32, 64 and
+   64*WIDE_WORDS vertices (see bittuple.h). */
+#define BIDIR_DECLARE_WIDTH(suffix)                                     \
+  extern Pebbling* bidirectional_pebbling_strategy_##suffix(DAG *digraph, \
+                                                            unsigned int upper_bound, \
+                                                            Boolean persistent_pebbling);
+
+BIDIR_DECLARE_WIDTH(w16)
+BIDIR_DECLARE_WIDTH(w32)
+BIDIR_DECLARE_WIDTH(w64)
+BIDIR_DECLARE_WIDTH(wide)
+
+#endif /* BIDIR_H */
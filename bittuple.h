@@ -0,0 +1,226 @@
+/*
+   Description::
+
+   Bit tuples used to represent sets of vertices in pebble
+   configurations. The width of a bit tuple is fixed at compile time:
+   the code which depends on it is compiled once for each width, and
+   the right build is chosen at runtime according to the size of the
+   graph.
+
+   The width is given by defining either BITTUPLE_WIDTH as 16, 32 or
+   64, and then a bit tuple is just an integer of that size, or
+   BITTUPLE_WIDE, and then a bit tuple is made of WIDE_WORDS machine
+   words and the operations work word by word.
+
+   Each build exports its symbols with a suffix (see WIDTH_SYMBOL) so
+   that all of them can be linked in the same program.
+
+*/
+
+#ifndef BITTUPLE_H
+#define BITTUPLE_H
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "common.h"
+
+#if BITTUPLE_WIDE
+
+#ifndef WIDE_WORDS
+#define WIDE_WORDS 4
+#endif
+#define BITTUPLE_WORDS WIDE_WORDS
+#define BITTUPLE_SIZE  (BITTUPLE_WORDS*BITWORD_SIZE)
+#define WIDTH_SYMBOL(name) name##_wide
+
+#elif BITTUPLE_WIDTH == 16
+
+typedef uint16_t BitTuple;
+#define BITTUPLE_WORDS 1
+#define BITTUPLE_SIZE  16
+#define WIDTH_SYMBOL(name) name##_w16
+
+#elif BITTUPLE_WIDTH == 32
+
+typedef uint32_t BitTuple;
+#define BITTUPLE_WORDS 1
+#define BITTUPLE_SIZE  32
+#define WIDTH_SYMBOL(name) name##_w32
+
+#elif BITTUPLE_WIDTH == 64
+
+typedef BitWord BitTuple;
+#define BITTUPLE_WORDS 1
+#define BITTUPLE_SIZE  64
+#define WIDTH_SYMBOL(name) name##_w64
+
+#else
+#error "Either BITTUPLE_WIDTH (16, 32 or 64) or BITTUPLE_WIDE must be defined"
+#endif
+
+
+#if BITTUPLE_WORDS == 1
+
+static inline BitTuple bt_zero(void)                       { return 0; }
+static inline Boolean  bt_get(BitTuple t,size_t i)         { return GETBIT(t,i); }
+static inline void     bt_set(BitTuple *t,size_t i)        { SETBIT(*t,i); }
+static inline void     bt_reset(BitTuple *t,size_t i)      { RESETBIT(*t,i); }
+static inline BitTuple bt_or(BitTuple a,BitTuple b)        { return a | b; }
+static inline BitTuple bt_and(BitTuple a,BitTuple b)       { return a & b; }
+static inline BitTuple bt_andnot(BitTuple a,BitTuple b)    { return a & ~b; }
+static inline Boolean  bt_iszero(BitTuple t)               { return t==0; }
+static inline Boolean  bt_equal(BitTuple a,BitTuple b)     { return a==b; }
+static inline int      bt_compare(BitTuple a,BitTuple b)   { return (a>b)-(a<b); }
+static inline size_t   bt_popcount(BitTuple t)             { return POPCOUNT(t); }
+
+/* Index of the lowest set bit, the tuple must be non zero */
+static inline size_t   bt_lowest(BitTuple t)               { assert(t!=0); return LOWESTBIT(t); }
+
+/* The first `n' bits set */
+static inline BitTuple bt_prefix(size_t n) {
+  assert(n<=BITTUPLE_SIZE);
+  return (n==BITTUPLE_SIZE) ? (BitTuple)BITWORD_FULL : (BitTuple)((BITWORD_UNIT << n) - 1);
+}
+
+/* A single word summarizing the tuple, used for hashing */
+static inline BitWord  bt_fold(BitTuple t)                 { return t; }
+
+/* Operations with a bitmask of `n' words (e.g. from the DAG
+   structure), which must fit in the tuple. */
+static inline void bt_orwords(BitTuple *t,const BitWord *m,size_t n) {
+  assert(n==1);
+  *t |= (BitTuple)m[0];
+}
+
+static inline void bt_andnotwords(BitTuple *t,const BitWord *m,size_t n) {
+  assert(n==1);
+  *t &= (BitTuple)~m[0];
+}
+
+static inline Boolean bt_haswords(BitTuple t,const BitWord *m,size_t n) {
+  assert(n==1);
+  return (t & m[0])==m[0];
+}
+
+#else /* BITTUPLE_WORDS > 1 */
+
+typedef struct {
+  BitWord word[BITTUPLE_WORDS];
+} BitTuple;
+
+static inline BitTuple bt_zero(void) {
+  BitTuple t;
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) t.word[k]=BITWORD_ZERO;
+  return t;
+}
+
+static inline Boolean bt_get(BitTuple t,size_t i) {
+  return GETWORDSBIT(t.word,i);
+}
+
+static inline void bt_set(BitTuple *t,size_t i) {
+  SETWORDSBIT(t->word,i);
+}
+
+static inline void bt_reset(BitTuple *t,size_t i) {
+  RESETBIT(t->word[i/BITWORD_SIZE],i%BITWORD_SIZE);
+}
+
+static inline BitTuple bt_or(BitTuple a,BitTuple b) {
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) a.word[k] |= b.word[k];
+  return a;
+}
+
+static inline BitTuple bt_and(BitTuple a,BitTuple b) {
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) a.word[k] &= b.word[k];
+  return a;
+}
+
+static inline BitTuple bt_andnot(BitTuple a,BitTuple b) {
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) a.word[k] &= ~b.word[k];
+  return a;
+}
+
+static inline Boolean bt_iszero(BitTuple t) {
+  BitWord acc=BITWORD_ZERO;
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) acc |= t.word[k];
+  return acc==BITWORD_ZERO;
+}
+
+static inline Boolean bt_equal(BitTuple a,BitTuple b) {
+  BitWord acc=BITWORD_ZERO;
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) acc |= a.word[k] ^ b.word[k];
+  return acc==BITWORD_ZERO;
+}
+
+/* Order of the tuples as numbers, the highest word first */
+static inline int bt_compare(BitTuple a,BitTuple b) {
+  for(size_t k=BITTUPLE_WORDS;k>0;k--) {
+    if (a.word[k-1]!=b.word[k-1]) return a.word[k-1] > b.word[k-1] ? 1 : -1;
+  }
+  return 0;
+}
+
+static inline size_t bt_popcount(BitTuple t) {
+  size_t c=0;
+  for(size_t k=0;k<BITTUPLE_WORDS;k++) c += POPCOUNT(t.word[k]);
+  return c;
+}
+
+/* Index of the lowest set bit, the tuple must be non zero */
+static inline size_t bt_lowest(BitTuple t) {
+  size_t k=0;
+  while(t.word[k]==BITWORD_ZERO) { k++; assert(k<BITTUPLE_WORDS); }
+  return k*BITWORD_SIZE + LOWESTBIT(t.word[k]);
+}
+
+/* The first `n' bits set */
+static inline BitTuple bt_prefix(size_t n) {
+  assert(n<=BITTUPLE_SIZE);
+  BitTuple t;
+  for(size_t k=0;k<BITTUPLE_WORDS;k++,n = (n>BITWORD_SIZE) ? n-BITWORD_SIZE : 0) {
+    t.word[k] = (n>=BITWORD_SIZE) ? BITWORD_FULL : ((BITWORD_UNIT << n) - 1);
+  }
+  return t;
+}
+
+/* A single word summarizing the tuple, used for hashing */
+static inline BitWord bt_fold(BitTuple t) {
+  BitWord h=t.word[0];
+  for(size_t k=1;k<BITTUPLE_WORDS;k++) h = (h * 0x100000001b3ULL) ^ t.word[k];
+  return h;
+}
+
+/* Operations with a bitmask of `n' words (e.g. from the DAG
+   structure), which must fit in the tuple. */
+static inline void bt_orwords(BitTuple *t,const BitWord *m,size_t n) {
+  assert(n<=BITTUPLE_WORDS);
+  for(size_t k=0;k<n;k++) t->word[k] |= m[k];
+}
+
+static inline void bt_andnotwords(BitTuple *t,const BitWord *m,size_t n) {
+  assert(n<=BITTUPLE_WORDS);
+  for(size_t k=0;k<n;k++) t->word[k] &= ~m[k];
+}
+
+static inline Boolean bt_haswords(BitTuple t,const BitWord *m,size_t n) {
+  assert(n<=BITTUPLE_WORDS);
+  BitWord acc=BITWORD_ZERO;
+  for(size_t k=0;k<n;k++) acc |= m[k] & ~t.word[k];
+  return acc==BITWORD_ZERO;
+}
+
+#endif /* BITTUPLE_WORDS */
+
+
+/* Checks that no bit beyond the first `n' is set */
+static inline Boolean bt_fits(BitTuple t,size_t n) {
+  for(size_t i=n;i<BITTUPLE_SIZE;i++) {
+    if (bt_get(t,i)) return FALSE;
+  }
+  return TRUE;
+}
+
+#endif /* BITTUPLE_H */
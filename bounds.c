@@ -0,0 +1,304 @@
+/*
+   Description::
+
+   Lower bounds on the cost of pebbling a DAG.
+
+   Notice that a reversible pebbling is also a black pebbling, so the
+   bounds for black pebbling hold for reversible pebbling as well.
+   Black-white pebbling may be cheaper, and only the indegree bound
+   holds for it.
+
+   For black pebbling of in-trees the recursive bound is exact, and
+   the pebbling which achieves it is built directly.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <assert.h>
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "bounds.h"
+
+
+/* Code */
+
+/**
+ * Every vertex must be pebbled at some point, and a vertex can get a
+ * black pebble, or lose a white one, only when all its predecessors
+ * are pebbled.
+ *
+ * @param g the graph to be pebbled
+ *
+ * @return the largest indegree plus one
+ */
+unsigned int indegree_lower_bound(const DAG *g) {
+
+  assert(isconsistent_DAG(g));
+
+  size_t d=0;
+  for(Vertex v=0;v<g->size;v++) {
+    if (g->indegree[v]>d) d=g->indegree[v];
+  }
+  return (unsigned int)(d+1);
+}
+
+
+#if REVERSIBLE_PEBBLING
+/* Number of vertices of a longest path which ends in `v'. The
+   `length' array memoizes the values already computed, and zero
+   means unknown. */
+static size_t longest_path_to(const DAG *g,Vertex v,size_t *length) {
+
+  if (length[v]>0) return length[v];
+
+  size_t best=0;
+  for(size_t i=0;i<g->indegree[v];i++) {
+    size_t l=longest_path_to(g,g->in[v][i],length);
+    if (l>best) best=l;
+  }
+  length[v]=best+1;
+  return length[v];
+}
+#endif
+
+/**
+ * A reversible pebbling of the graph induces a reversible pebbling
+ * of any path from a source to the sink, with no more pebbles. With
+ * p pebbles the reversible pebbling can reach the end of a path of
+ * 2^p - 1 vertices, and can leave a pebble on the end of a path of
+ * 2^(p-1) vertices.
+ *
+ * @param g the graph to be pebbled
+ * @param persistent_pebbling whether the pebbling must leave a
+ * pebble on the sink
+ *
+ * @return the bound for a longest path in the graph, or zero if the
+ * pebbling is not reversible
+ */
+unsigned int path_lower_bound(const DAG *g,Boolean persistent_pebbling) {
+
+  assert(isconsistent_DAG(g));
+
+#if REVERSIBLE_PEBBLING
+  size_t *length=(size_t*)calloc(g->size,sizeof(size_t));
+  assert(length);
+
+  size_t longest=0;
+  for(size_t i=0;i<g->sink_number;i++) {
+    size_t l=longest_path_to(g,g->sinks[i],length);
+    if (l>longest) longest=l;
+  }
+  free(length);
+
+  unsigned int p=1;
+  if (persistent_pebbling) {
+    while(((size_t)1 << (p-1)) < longest) p++;
+  } else {
+    while(((size_t)1 << p) - 1 < longest) p++;
+  }
+  return p;
+#else
+  (void)persistent_pebbling;
+  return 0;
+#endif
+}
+
+
+/* Cost of the black pebbling of `v' which pebbles the predecessors
+   one at a time, the most expensive first, each time from scratch
+   (i.e. recomputing the shared vertices), and keeps a pebble on the
+   predecessors already done. The `memo' array keeps the values
+   already computed, and zero means unknown. */
+static unsigned int recursive_cost(const DAG *g,Vertex v,unsigned int *memo) {
+
+  if (memo[v]>0) return memo[v];
+
+  size_t d=g->indegree[v];
+  if (d==0) return memo[v]=1;
+
+  unsigned int cost[d];
+  for(size_t i=0;i<d;i++) {
+    unsigned int c=recursive_cost(g,g->in[v][i],memo);
+    size_t j=i;
+    for(; j>0 && cost[j-1]<c; j--) cost[j]=cost[j-1];  /* Decreasing order */
+    cost[j]=c;
+  }
+
+  unsigned int best=(unsigned int)(d+1);
+  for(size_t i=0;i<d;i++) {
+    if (cost[i]+i > best) best=cost[i]+(unsigned int)i;
+  }
+  return memo[v]=best;
+}
+
+/* Cost of the recursive pebbling of the sinks */
+static unsigned int recursive_sink_cost(const DAG *g) {
+
+  unsigned int *memo=(unsigned int*)calloc(g->size,sizeof(unsigned int));
+  assert(memo);
+
+  unsigned int best=0;
+  for(size_t i=0;i<g->sink_number;i++) {
+    unsigned int c=recursive_cost(g,g->sinks[i],memo);
+    if (c>best) best=c;
+  }
+  free(memo);
+  return best;
+}
+
+#if !BLACK_WHITE_PEBBLING
+/* Is the graph an in-tree, i.e. with a single sink and every other
+   vertex with a single successor? */
+static Boolean isintree(const DAG *g) {
+
+  if (g->sink_number!=1) return FALSE;
+
+  for(Vertex v=0;v<g->size;v++) {
+    if (g->outdegree[v]>1) return FALSE;
+  }
+  return TRUE;
+}
+#endif
+
+/**
+ * In an in-tree (i.e. every vertex has at most one successor) the
+ * cost of black pebbling follows the Strahler-like recursion
+ *
+ *     p(v) = max( max_i p(c_i) + i - 1 , d + 1 )
+ *
+ * where c_1,...,c_d are the predecessors of v sorted by decreasing
+ * cost.
+ *
+ * @param g the graph to be pebbled
+ *
+ * @return the bound, or zero if the graph is not an in-tree or the
+ * pebbling is black-white
+ */
+unsigned int intree_lower_bound(const DAG *g) {
+
+  assert(isconsistent_DAG(g));
+
+#if BLACK_WHITE_PEBBLING
+  return 0;
+#else
+  if (!isintree(g)) return 0;
+  return recursive_sink_cost(g);
+#endif
+}
+
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+/* Append to `p' the black pebbling of `v' in an in-tree which
+   pebbles the predecessors the most expensive first, keeping a
+   pebble on each of them until `v' is pebbled. */
+static void intree_steps(const DAG *g,Vertex v,const unsigned int *memo,Pebbling *p) {
+
+  size_t d=g->indegree[v];
+  Vertex order[d+1];
+  for(size_t i=0;i<d;i++) {
+    Vertex u=g->in[v][i];
+    size_t j=i;
+    for(; j>0 && memo[order[j-1]]<memo[u]; j--) order[j]=order[j-1];  /* Decreasing cost */
+    order[j]=u;
+  }
+
+  for(size_t i=0;i<d;i++) intree_steps(g,order[i],memo,p);
+  p->steps[p->length++]=v;
+  for(size_t i=0;i<d;i++) p->steps[p->length++]=order[i];
+}
+#endif
+
+/**
+ * The black pebbling of an in-tree with the cost of the recursion in
+ * intree_lower_bound, which is then the minimum cost. Each vertex is
+ * pebbled once and the sink is cleaned up at the end, so the
+ * pebbling is also a shortest one.
+ *
+ * @param g the graph to be pebbled
+ *
+ * @return the pebbling, or NULL if the graph is not an in-tree or the
+ * pebbling is not black
+ */
+Pebbling *intree_pebbling_strategy(const DAG *g) {
+
+  assert(isconsistent_DAG(g));
+
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  return NULL;
+#else
+  if (!isintree(g)) return NULL;
+
+  unsigned int *memo=(unsigned int*)calloc(g->size,sizeof(unsigned int));
+  assert(memo);
+
+  Vertex sink=g->sinks[0];
+  Pebbling *p=new_Pebbling(2*g->size);
+  p->length = 0;
+  p->cost   = (int)recursive_cost(g,sink,memo);
+  intree_steps(g,sink,memo,p);
+  p->steps[p->length++]=sink;
+  assert(p->length==2*g->size);
+
+  free(memo);
+  return p;
+#endif
+}
+
+
+/**
+ * A black pebbling can pebble each vertex recursively from scratch,
+ * with the cost given by the recursion in intree_lower_bound. This
+ * is a feasible cost for black and black-white pebbling, while in
+ * reversible pebbling the recomputed vertices can't be removed.
+ *
+ * @param g the graph to be pebbled
+ *
+ * @return the upper bound, or zero for reversible pebbling
+ */
+unsigned int recursive_upper_bound(const DAG *g) {
+
+  assert(isconsistent_DAG(g));
+
+#if REVERSIBLE_PEBBLING
+  return 0;
+#else
+  return recursive_sink_cost(g);
+#endif
+}
+
+
+/**
+ * The black pebbling of a pyramid of height h costs h+2 pebbles.
+ *
+ * @return the bound, or zero for black-white pebbling
+ */
+unsigned int pyramid_lower_bound(int height) {
+
+  assert(height>=0);
+
+#if BLACK_WHITE_PEBBLING
+  return 0;
+#else
+  return height>0 ? (unsigned int)height+2 : 1;
+#endif
+}
+
+/**
+ * The black pebbling of a complete binary tree of height h costs h+2
+ * pebbles.
+ *
+ * @return the bound, or zero for black-white pebbling
+ */
+unsigned int tree_lower_bound(int height) {
+
+  assert(height>=0);
+
+#if BLACK_WHITE_PEBBLING
+  return 0;
+#else
+  return height>0 ? (unsigned int)height+2 : 1;
+#endif
+}
@@ -0,0 +1,41 @@
+/*
+   Description::
+
+   Lower bounds on the cost of pebbling a DAG, which are cheap to
+   compute and can be used to skip the search with hopeless bounds,
+   and an upper bound given by a simple strategy.
+
+*/
+
+
+/* Preamble */
+#ifndef  BOUNDS_H
+#define  BOUNDS_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+/* Each function gives a lower bound on the cost of a pebbling of the
+   graph, for the kind of pebbling of the current build. A bound of
+   zero means that the argument does not apply to the graph or to the
+   kind of pebbling. */
+extern unsigned int indegree_lower_bound(const DAG *digraph);
+extern unsigned int path_lower_bound(const DAG *digraph,Boolean persistent_pebbling);
+extern unsigned int intree_lower_bound(const DAG *digraph);
+
+/* A feasible cost, found without search (zero if not available) */
+extern unsigned int recursive_upper_bound(const DAG *digraph);
+
+/* The black pebbling of an in-tree of minimum cost, found without
+   search (NULL if not available) */
+extern Pebbling *intree_pebbling_strategy(const DAG *digraph);
+
+/* Known values for the pebbling of classic graphs */
+extern unsigned int pyramid_lower_bound(int height);
+extern unsigned int tree_lower_bound(int height);
+
+#endif /* BOUNDS_H */
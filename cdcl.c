@@ -0,0 +1,676 @@
+/*
+   Description::
+
+   A small incremental CDCL solver, in the style of MiniSat: two
+   watched literals per clause, learning of the first unique
+   implication point, variable activities with a heap, phase saving,
+   restarts following the Luby sequence and periodic deletion of the
+   least active learnt clauses.
+
+   The assumptions of a call are the first decisions, one per
+   decision level, so the clauses learnt under them hold without
+   them, and they are kept for the next calls.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "common.h"
+#include "cdcl.h"
+
+
+/* Code */
+
+/* Internally the literals of the variable v (from 0) are 2v and 2v+1,
+   for v true and false respectively. */
+#define VAR(lit)      ((lit) >> 1)
+#define NEG(lit)      ((lit) ^ 1)
+#define NO_LIT        (-1)
+
+#define LTRUE    1
+#define LFALSE (-1)
+#define LUNDEF   0
+
+#define RESTART_UNIT   100     /* Conflicts in a unit of the Luby sequence */
+#define VAR_DECAY      0.95
+#define CLAUSE_DECAY   0.999
+
+typedef struct {
+  double       activity;
+  unsigned int size;
+  Boolean      learnt;
+  Boolean      deleted;
+  int          lits[];
+} Clause;
+
+typedef struct {
+  Clause **data;
+  size_t   size;
+  size_t   capacity;
+} ClauseVector;
+
+typedef struct {
+  int     *data;
+  size_t   size;
+  size_t   capacity;
+} IntVector;
+
+struct SatSolver {
+
+  int           nvars;
+  size_t        var_capacity;
+
+  signed char  *assign;        /* Value of each variable */
+  signed char  *polarity;      /* Last value of each variable */
+  signed char  *model;         /* Values found by the last call */
+  int          *level;         /* Decision level of each assignment */
+  Clause      **reason;        /* Clause which implied the assignment */
+  char         *seen;          /* Marks for the conflict analysis */
+
+  double       *activity;      /* Activity of the variables */
+  double        var_inc;
+  int          *heap;          /* Unassigned variables by activity */
+  int          *heap_index;    /* Position in the heap, or -1 */
+  int           heap_size;
+
+  int          *trail;         /* Assigned literals, in order */
+  int           trail_size;
+  int          *trail_lim;     /* Start of each decision level */
+  int           levels;
+  int           qhead;         /* Next literal to propagate */
+
+  ClauseVector *watches;       /* Clauses watching each literal */
+  ClauseVector  clauses;
+  ClauseVector  learnts;
+  double        cla_inc;
+  double        max_learnts;
+
+  Boolean       ok;            /* FALSE if the clauses are unsatisfiable */
+
+  IntVector     original;      /* Clauses as given, ended by zero */
+  size_t        original_number;
+
+  IntVector     learnt_buffer; /* Scratch space of the analysis */
+  IntVector     to_clear;
+};
+
+
+/* Vectors */
+
+static void pushC(ClauseVector *v,Clause *c) {
+  if (v->size==v->capacity) {
+    v->capacity = v->capacity ? 2*v->capacity : 4;
+    v->data = (Clause**)realloc(v->data,v->capacity*sizeof(Clause*));
+    assert(v->data);
+  }
+  v->data[v->size++]=c;
+}
+
+static void pushI(IntVector *v,int x) {
+  if (v->size==v->capacity) {
+    v->capacity = v->capacity ? 2*v->capacity : 16;
+    v->data = (int*)realloc(v->data,v->capacity*sizeof(int));
+    assert(v->data);
+  }
+  v->data[v->size++]=x;
+}
+
+
+/* Values */
+
+static inline signed char value_lit(const SatSolver *s,int lit) {
+  signed char v=s->assign[VAR(lit)];
+  return (lit & 1) ? -v : v;
+}
+
+static inline int internal_lit(int lit) {
+  assert(lit!=0);
+  return lit>0 ? 2*(lit-1) : 2*(-lit-1)+1;
+}
+
+
+/* Heap of the variables, by decreasing activity */
+
+static inline Boolean heap_less(const SatSolver *s,int a,int b) {
+  return s->activity[a] > s->activity[b];
+}
+
+static void heap_up(SatSolver *s,int i) {
+  int x=s->heap[i];
+  while (i>0) {
+    int parent=(i-1)/2;
+    if (!heap_less(s,x,s->heap[parent])) break;
+    s->heap[i]=s->heap[parent];
+    s->heap_index[s->heap[i]]=i;
+    i=parent;
+  }
+  s->heap[i]=x;
+  s->heap_index[x]=i;
+}
+
+static void heap_down(SatSolver *s,int i) {
+  int x=s->heap[i];
+  for(;;) {
+    int child=2*i+1;
+    if (child>=s->heap_size) break;
+    if (child+1<s->heap_size && heap_less(s,s->heap[child+1],s->heap[child])) child++;
+    if (!heap_less(s,s->heap[child],x)) break;
+    s->heap[i]=s->heap[child];
+    s->heap_index[s->heap[i]]=i;
+    i=child;
+  }
+  s->heap[i]=x;
+  s->heap_index[x]=i;
+}
+
+static void heap_insert(SatSolver *s,int var) {
+  if (s->heap_index[var]>=0) return;
+  s->heap[s->heap_size]=var;
+  s->heap_index[var]=s->heap_size;
+  s->heap_size++;
+  heap_up(s,s->heap_size-1);
+}
+
+static int heap_pop(SatSolver *s) {
+  assert(s->heap_size>0);
+  int var=s->heap[0];
+  s->heap_index[var]=-1;
+  s->heap_size--;
+  if (s->heap_size>0) {
+    s->heap[0]=s->heap[s->heap_size];
+    s->heap_index[s->heap[0]]=0;
+    heap_down(s,0);
+  }
+  return var;
+}
+
+
+/* Activities */
+
+static void bump_var(SatSolver *s,int var) {
+  s->activity[var] += s->var_inc;
+  if (s->activity[var] > 1e100) {
+    for(int v=0;v<s->nvars;v++) s->activity[v] *= 1e-100;
+    s->var_inc *= 1e-100;
+  }
+  if (s->heap_index[var]>=0) heap_up(s,s->heap_index[var]);
+}
+
+static void bump_clause(SatSolver *s,Clause *c) {
+  c->activity += s->cla_inc;
+  if (c->activity > 1e20) {
+    for(size_t i=0;i<s->learnts.size;i++) s->learnts.data[i]->activity *= 1e-20;
+    s->cla_inc *= 1e-20;
+  }
+}
+
+
+/* Assignments */
+
+static inline void enqueue(SatSolver *s,int lit,Clause *reason) {
+  assert(value_lit(s,lit)==LUNDEF);
+  int var=VAR(lit);
+  s->assign[var] = (lit & 1) ? LFALSE : LTRUE;
+  s->level[var]  = s->levels;
+  s->reason[var] = reason;
+  s->trail[s->trail_size++] = lit;
+}
+
+static void cancel_until(SatSolver *s,int level) {
+  if (s->levels <= level) return;
+  for(int i=s->trail_size-1; i>=s->trail_lim[level]; i--) {
+    int var=VAR(s->trail[i]);
+    s->polarity[var] = s->assign[var];
+    s->assign[var] = LUNDEF;
+    s->reason[var] = NULL;
+    heap_insert(s,var);
+  }
+  s->trail_size = s->trail_lim[level];
+  s->qhead = s->trail_size;
+  s->levels = level;
+}
+
+static inline void new_level(SatSolver *s) {
+  s->trail_lim[s->levels++] = s->trail_size;
+}
+
+
+/* Clauses */
+
+static Clause *new_clause(const int *lits,size_t n,Boolean learnt) {
+  Clause *c=(Clause*)malloc(sizeof(Clause)+n*sizeof(int));
+  assert(c);
+  c->activity = 0.0;
+  c->size     = (unsigned int)n;
+  c->learnt   = learnt;
+  c->deleted  = FALSE;
+  memcpy(c->lits,lits,n*sizeof(int));
+  return c;
+}
+
+static inline void attach_clause(SatSolver *s,Clause *c) {
+  assert(c->size>=2);
+  pushC(&s->watches[c->lits[0]],c);
+  pushC(&s->watches[c->lits[1]],c);
+}
+
+/* A clause is locked if it is the reason of an assignment */
+static inline Boolean islocked(const SatSolver *s,const Clause *c) {
+  return s->reason[VAR(c->lits[0])]==c && value_lit(s,c->lits[0])==LTRUE;
+}
+
+
+/* Propagation of the assignments on the trail
+
+   @return a clause falsified, or NULL */
+static Clause *propagate(SatSolver *s) {
+
+  Clause *conflict=NULL;
+
+  while (s->qhead < s->trail_size && !conflict) {
+
+    int falselit=NEG(s->trail[s->qhead++]);
+    ClauseVector *ws=&s->watches[falselit];
+    size_t i=0,j=0;
+
+    while (i<ws->size) {
+
+      Clause *c=ws->data[i++];
+
+      /* The false literal goes in the second position */
+      if (c->lits[0]==falselit) { c->lits[0]=c->lits[1]; c->lits[1]=falselit; }
+      assert(c->lits[1]==falselit);
+
+      if (value_lit(s,c->lits[0])==LTRUE) { ws->data[j++]=c; continue; }
+
+      /* Look for a new literal to watch */
+      Boolean moved=FALSE;
+      for(unsigned int k=2;k<c->size;k++) {
+        if (value_lit(s,c->lits[k])!=LFALSE) {
+          c->lits[1]=c->lits[k]; c->lits[k]=falselit;
+          pushC(&s->watches[c->lits[1]],c);
+          moved=TRUE;
+          break;
+        }
+      }
+      if (moved) continue;
+
+      /* The clause is unit or falsified */
+      ws->data[j++]=c;
+      if (value_lit(s,c->lits[0])==LFALSE) {
+        conflict=c;
+        while (i<ws->size) ws->data[j++]=ws->data[i++];
+      } else {
+        enqueue(s,c->lits[0],c);
+      }
+    }
+    ws->size=j;
+  }
+  return conflict;
+}
+
+
+/* Learn the clause of the first unique implication point of a
+   conflict, in s->learnt_buffer with the asserting literal first and
+   one of the highest level second.
+
+   @return the level to backtrack to */
+static int analyze(SatSolver *s,Clause *conflict) {
+
+  IntVector *learnt=&s->learnt_buffer;
+  int pathC=0;
+  int p=NO_LIT;
+  int index=s->trail_size-1;
+
+  learnt->size=0;
+  pushI(learnt,NO_LIT);       /* Room for the asserting literal */
+  s->to_clear.size=0;
+
+  do {
+    assert(conflict);
+    if (conflict->learnt) bump_clause(s,conflict);
+
+    for(unsigned int k=(p==NO_LIT ? 0 : 1); k<conflict->size; k++) {
+      int q=conflict->lits[k];
+      int var=VAR(q);
+      if (s->seen[var] || s->level[var]==0) continue;
+      bump_var(s,var);
+      s->seen[var]=1;
+      pushI(&s->to_clear,var);
+      if (s->level[var] >= s->levels) pathC++;
+      else pushI(learnt,q);
+    }
+
+    /* The next literal of the current level on the trail */
+    while (!s->seen[VAR(s->trail[index])]) index--;
+    p=s->trail[index--];
+    conflict=s->reason[VAR(p)];
+    pathC--;
+
+  } while (pathC>0);
+  learnt->data[0]=NEG(p);
+
+  /* Drop the literals implied by the other ones */
+  size_t j=1;
+  for(size_t i=1;i<learnt->size;i++) {
+    int var=VAR(learnt->data[i]);
+    Clause *r=s->reason[var];
+    Boolean redundant = (r!=NULL);
+    for(unsigned int k=1; r && k<r->size && redundant; k++) {
+      int u=VAR(r->lits[k]);
+      if (!s->seen[u] && s->level[u]>0) redundant=FALSE;
+    }
+    if (!redundant) learnt->data[j++]=learnt->data[i];
+  }
+  learnt->size=j;
+
+  for(size_t i=0;i<s->to_clear.size;i++) s->seen[s->to_clear.data[i]]=0;
+
+  /* Backtrack level */
+  if (learnt->size==1) return 0;
+  size_t max=1;
+  for(size_t i=2;i<learnt->size;i++)
+    if (s->level[VAR(learnt->data[i])] > s->level[VAR(learnt->data[max])]) max=i;
+  int t=learnt->data[1]; learnt->data[1]=learnt->data[max]; learnt->data[max]=t;
+  return s->level[VAR(learnt->data[1])];
+}
+
+
+/* Delete half of the learnt clauses, the least active ones */
+static int compare_activity(const void *a,const void *b) {
+  double x=(*(Clause* const*)a)->activity;
+  double y=(*(Clause* const*)b)->activity;
+  return (x<y) ? -1 : (x>y ? 1 : 0);
+}
+
+static void reduce_learnts(SatSolver *s) {
+
+  ClauseVector *l=&s->learnts;
+  qsort(l->data,l->size,sizeof(Clause*),compare_activity);
+
+  for(size_t i=0;i<l->size/2;i++) {
+    Clause *c=l->data[i];
+    if (c->size>2 && !islocked(s,c)) c->deleted=TRUE;
+  }
+
+  for(int lit=0;lit<2*s->nvars;lit++) {
+    ClauseVector *ws=&s->watches[lit];
+    size_t k=0;
+    for(size_t i=0;i<ws->size;i++) if (!ws->data[i]->deleted) ws->data[k++]=ws->data[i];
+    ws->size=k;
+  }
+
+  size_t j=0;
+  for(size_t i=0;i<l->size;i++) {
+    if (l->data[i]->deleted) free(l->data[i]);
+    else l->data[j++]=l->data[i];
+  }
+  l->size=j;
+}
+
+
+/* Luby sequence: 1 1 2 1 1 2 4 1 1 2 ... */
+static double luby(int i) {
+  int size=1,seq=0;
+  while (size < i+1) { seq++; size=2*size+1; }
+  while (size-1 != i) { size=(size-1)>>1; seq--; i=i%size; }
+  double x=1.0;
+  while (seq-- > 0) x*=2.0;
+  return x;
+}
+
+
+/* Search until a model is found, the clauses are refuted (under the
+   assumptions), or `conflict_limit' conflicts happen.
+
+   @return LTRUE, LFALSE, or LUNDEF for a restart */
+static int search(SatSolver *s,const int *assumptions,size_t n,long conflict_limit) {
+
+  long conflicts=0;
+
+  for(;;) {
+
+    Clause *conflict=propagate(s);
+
+    if (conflict) {
+
+      conflicts++;
+      if (s->levels==0) { s->ok=FALSE; return LFALSE; }
+
+      int level=analyze(s,conflict);
+      cancel_until(s,level);
+
+      IntVector *learnt=&s->learnt_buffer;
+      if (learnt->size==1) {
+        enqueue(s,learnt->data[0],NULL);
+      } else {
+        Clause *c=new_clause(learnt->data,learnt->size,TRUE);
+        pushC(&s->learnts,c);
+        attach_clause(s,c);
+        bump_clause(s,c);
+        enqueue(s,learnt->data[0],c);
+      }
+      s->var_inc /= VAR_DECAY;
+      s->cla_inc /= CLAUSE_DECAY;
+      continue;
+    }
+
+    if (conflicts >= conflict_limit) { cancel_until(s,0); return LUNDEF; }
+
+    if ((double)s->learnts.size - s->trail_size >= s->max_learnts) reduce_learnts(s);
+
+    /* Assumptions first, then the most active variable */
+    int next=NO_LIT;
+    while (s->levels < (int)n) {
+      int p=assumptions[s->levels];
+      if (value_lit(s,p)==LTRUE) { new_level(s); continue; }
+      if (value_lit(s,p)==LFALSE) return LFALSE;
+      next=p;
+      break;
+    }
+
+    if (next==NO_LIT) {
+      while (s->heap_size>0 && next==NO_LIT) {
+        int var=heap_pop(s);
+        if (s->assign[var]==LUNDEF) next = (s->polarity[var]==LTRUE) ? 2*var : 2*var+1;
+      }
+      if (next==NO_LIT) return LTRUE;
+    }
+
+    new_level(s);
+    enqueue(s,next,NULL);
+  }
+}
+
+
+/**
+   Create a solver with no variables and no clauses.
+*/
+SatSolver *new_SatSolver(void) {
+
+  SatSolver *s=(SatSolver*)calloc(1,sizeof(SatSolver));
+  assert(s);
+  s->var_inc = 1.0;
+  s->cla_inc = 1.0;
+  s->ok = TRUE;
+  return s;
+}
+
+void dispose_SatSolver(SatSolver *s) {
+
+  assert(s);
+  for(size_t i=0;i<s->clauses.size;i++) free(s->clauses.data[i]);
+  for(size_t i=0;i<s->learnts.size;i++) free(s->learnts.data[i]);
+  for(int lit=0;lit<2*s->nvars;lit++) free(s->watches[lit].data);
+  free(s->clauses.data);
+  free(s->learnts.data);
+  free(s->watches);
+  free(s->assign);
+  free(s->polarity);
+  free(s->model);
+  free(s->level);
+  free(s->reason);
+  free(s->seen);
+  free(s->activity);
+  free(s->heap);
+  free(s->heap_index);
+  free(s->trail);
+  free(s->trail_lim);
+  free(s->original.data);
+  free(s->learnt_buffer.data);
+  free(s->to_clear.data);
+  free(s);
+}
+
+
+/**
+   Add a new variable to the solver.
+
+   @return the number of the variable, from 1 on
+*/
+int newvar_SatSolver(SatSolver *s) {
+
+  assert(s->levels==0);
+
+  if ((size_t)s->nvars==s->var_capacity) {
+    size_t c = s->var_capacity ? 2*s->var_capacity : 1024;
+    s->assign     = (signed char*)realloc(s->assign,c*sizeof(signed char));
+    s->polarity   = (signed char*)realloc(s->polarity,c*sizeof(signed char));
+    s->model      = (signed char*)realloc(s->model,c*sizeof(signed char));
+    s->level      = (int*)realloc(s->level,c*sizeof(int));
+    s->reason     = (Clause**)realloc(s->reason,c*sizeof(Clause*));
+    s->seen       = (char*)realloc(s->seen,c*sizeof(char));
+    s->activity   = (double*)realloc(s->activity,c*sizeof(double));
+    s->heap       = (int*)realloc(s->heap,c*sizeof(int));
+    s->heap_index = (int*)realloc(s->heap_index,c*sizeof(int));
+    s->trail      = (int*)realloc(s->trail,c*sizeof(int));
+    s->trail_lim  = (int*)realloc(s->trail_lim,2*c*sizeof(int)); /* With assumptions */
+    s->watches    = (ClauseVector*)realloc(s->watches,2*c*sizeof(ClauseVector));
+    assert(s->assign && s->polarity && s->model && s->level && s->reason && s->seen);
+    assert(s->activity && s->heap && s->heap_index && s->trail && s->trail_lim && s->watches);
+    s->var_capacity = c;
+  }
+
+  int var=s->nvars++;
+  s->assign[var]   = LUNDEF;
+  s->polarity[var] = LFALSE;
+  s->model[var]    = LUNDEF;
+  s->level[var]    = 0;
+  s->reason[var]   = NULL;
+  s->seen[var]     = 0;
+  s->activity[var] = 0.0;
+  s->heap_index[var] = -1;
+  memset(&s->watches[2*var],0,2*sizeof(ClauseVector));
+  heap_insert(s,var);
+
+  return var+1;
+}
+
+
+/**
+   Add a clause to the solver, between two calls of solve_SatSolver.
+
+   @param lits the literals of the clause, in DIMACS format
+   @param n the number of literals
+*/
+void addclause_SatSolver(SatSolver *s,const int *lits,size_t n) {
+
+  assert(s->levels==0);
+
+  for(size_t i=0;i<n;i++) {
+    assert(lits[i]!=0 && abs(lits[i])<=s->nvars);
+    pushI(&s->original,lits[i]);
+  }
+  pushI(&s->original,0);
+  s->original_number++;
+
+  if (!s->ok) return;
+
+  /* Remove the duplicates and the literals false at level zero, and
+     skip the tautologies and the clauses already satisfied */
+  IntVector *c=&s->learnt_buffer;
+  Boolean satisfied=FALSE;
+  c->size=0;
+  for(size_t i=0;i<n && !satisfied;i++) {
+    int lit=internal_lit(lits[i]);
+    int var=VAR(lit);
+    char mark=(lit & 1) ? 2 : 1;
+    if (value_lit(s,lit)==LTRUE) satisfied=TRUE;
+    else if (s->seen[var]==mark || value_lit(s,lit)==LFALSE) continue;
+    else if (s->seen[var]!=0) satisfied=TRUE;
+    else { s->seen[var]=mark; pushI(c,lit); }
+  }
+  for(size_t i=0;i<c->size;i++) s->seen[VAR(c->data[i])]=0;
+  if (satisfied) return;
+
+  if (c->size==0) { s->ok=FALSE; return; }
+
+  if (c->size==1) {
+    enqueue(s,c->data[0],NULL);
+    if (propagate(s)) s->ok=FALSE;
+    return;
+  }
+
+  Clause *cl=new_clause(c->data,c->size,FALSE);
+  pushC(&s->clauses,cl);
+  attach_clause(s,cl);
+}
+
+
+/**
+   Decide the satisfiability of the clauses added so far, with the
+   literals in `assumptions' set to true. The learnt clauses are kept
+   for the next calls.
+
+   @param assumptions literals in DIMACS format
+   @param n the number of assumptions
+
+   @return TRUE if satisfiable, and then the assignment found is read
+   with value_SatSolver
+*/
+Boolean solve_SatSolver(SatSolver *s,const int *assumptions,size_t n) {
+
+  assert(s->levels==0);
+  assert(n <= (size_t)s->nvars);
+  if (!s->ok) return FALSE;
+
+  int *internal=(int*)malloc((n+1)*sizeof(int));
+  assert(internal);
+  for(size_t i=0;i<n;i++) internal[i]=internal_lit(assumptions[i]);
+
+  s->max_learnts = (double)s->clauses.size/3.0 + 1000.0;
+  if (s->max_learnts < (double)s->learnts.size) s->max_learnts = (double)s->learnts.size;
+
+  int status=LUNDEF;
+  for(int restart=0; status==LUNDEF; restart++) {
+    status=search(s,internal,n,(long)(luby(restart)*RESTART_UNIT));
+    s->max_learnts *= 1.05;
+  }
+
+  if (status==LTRUE) memcpy(s->model,s->assign,s->nvars*sizeof(signed char));
+
+  cancel_until(s,0);
+  free(internal);
+  return status==LTRUE;
+}
+
+
+Boolean value_SatSolver(const SatSolver *s,int var) {
+  assert(var>0 && var<=s->nvars);
+  return s->model[var-1]==LTRUE;
+}
+
+
+void fprint_dimacs_SatSolver(FILE *outfile,const SatSolver *s,
+                             const int *assumptions,size_t n) {
+
+  fprintf(outfile,"p cnf %d %lu\n",s->nvars,(unsigned long)(s->original_number+n));
+  for(size_t i=0;i<s->original.size;i++) {
+    if (s->original.data[i]==0) fprintf(outfile,"0\n");
+    else fprintf(outfile,"%d ",s->original.data[i]);
+  }
+  for(size_t i=0;i<n;i++) fprintf(outfile,"%d 0\n",assumptions[i]);
+}
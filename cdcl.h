@@ -0,0 +1,49 @@
+/*
+   Description::
+
+   A small incremental CDCL solver for formulas in conjunctive normal
+   form. Clauses can be added between two calls, and each call can
+   assume the value of some literals.
+
+*/
+
+
+/* Preamble */
+#ifndef  CDCL_H
+#define  CDCL_H
+
+#include <stdio.h>
+#include "common.h"
+
+
+/* Code */
+
+/* Variables are numbered from 1, and literals are written as in the
+   DIMACS format: v for the variable v, -v for its negation. */
+typedef struct SatSolver SatSolver;
+
+extern SatSolver* new_SatSolver(void);
+extern void       dispose_SatSolver(SatSolver *s);
+
+/* A new variable */
+extern int     newvar_SatSolver(SatSolver *s);
+
+/* Add a clause of `n' literals */
+extern void    addclause_SatSolver(SatSolver *s,const int *lits,size_t n);
+
+/* Decides the clauses added so far, with the literals in
+   `assumptions' set to true.
+
+   @return TRUE if the clauses are satisfiable */
+extern Boolean solve_SatSolver(SatSolver *s,const int *assumptions,size_t n);
+
+/* Value of a variable in the assignment found by the last call of
+   solve_SatSolver, which must have been satisfiable */
+extern Boolean value_SatSolver(const SatSolver *s,int var);
+
+/* Print the clauses added so far in DIMACS format, followed by the
+   assumptions as unit clauses */
+extern void    fprint_dimacs_SatSolver(FILE *outfile,const SatSolver *s,
+                                       const int *assumptions,size_t n);
+
+#endif /* CDCL_H */
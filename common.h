@@ -18,23 +18,41 @@
 #include <limits.h>
 
 /* Bit and Boolean types declarations */
-/* Several bit tuples  are used in the code.
+/* Several bit tuples  are used in the code. A BitWord is the machine
+   word used to build them: the bit tuples of pebble configurations
+   are defined in bittuple.h.
  */
-typedef long long unsigned int BitTuple;
+typedef long long unsigned int BitWord;
 typedef long long unsigned int Counter;
 typedef unsigned char          Boolean;
 
-#define BITTUPLE_UNIT 0x1ULL       /* A bitmask compatible with BitTuple, of value 1 */
-#define BITTUPLE_ZERO 0x0ULL       /* A bitmask compatible with BitTuple, of value 0 */
-#define BITTUPLE_FULL (~0x0ULL)    /* A bitmask compatible with BitTuple, of value 1 */
-#define BITTUPLE_SIZE sizeof(BitTuple)*CHAR_BIT
+#define BITWORD_UNIT 0x1ULL       /* A bitmask compatible with BitWord, of value 1 */
+#define BITWORD_ZERO 0x0ULL       /* A bitmask compatible with BitWord, of value 0 */
+#define BITWORD_FULL (~0x0ULL)    /* A bitmask compatible with BitWord, of value 1 */
+#define BITWORD_SIZE (sizeof(BitWord)*CHAR_BIT)
 
 #define TRUE  1
 #define FALSE 0
 
-#define   GETBIT(tuple,i) (((tuple) & (BITTUPLE_UNIT << (i))) ? TRUE : FALSE )
-#define   SETBIT(tuple,i) ((tuple)|=(BITTUPLE_UNIT << (i)))
-#define RESETBIT(tuple,i) ((tuple)&= ~(BITTUPLE_UNIT << (i)))
+#define   GETBIT(tuple,i) (((tuple) & (BITWORD_UNIT << (i))) ? TRUE : FALSE )
+#define   SETBIT(tuple,i) ((tuple)|=(BITWORD_UNIT << (i)))
+#define RESETBIT(tuple,i) ((tuple)&= ~(BITWORD_UNIT << (i)))
+#define POPCOUNT(tuple)   (__builtin_popcountll(tuple))
+#define LOWESTBIT(tuple)  ((size_t)__builtin_ctzll(tuple))   /* tuple must be non zero */
+
+/* Hint that the memory at `addr' will be read soon */
+#define PREFETCH(addr)    (__builtin_prefetch((addr),0,1))
+
+/* Access to flags shared among threads */
+#define ATOMIC_LOAD(ptr)      (__atomic_load_n((ptr),__ATOMIC_ACQUIRE))
+#define ATOMIC_STORE(ptr,val) (__atomic_store_n((ptr),(val),__ATOMIC_RELEASE))
+#define ATOMIC_FETCH_INCREMENT(ptr) (__atomic_fetch_add((ptr),1,__ATOMIC_RELAXED))
+#define ATOMIC_FETCH_ADD(ptr,val)   (__atomic_fetch_add((ptr),(val),__ATOMIC_ACQ_REL))
+
+/* Bitmasks of arbitrary length, represented as arrays of BitWord */
+#define BITWORDS(n)          (((n)+BITWORD_SIZE-1)/BITWORD_SIZE)
+#define   GETWORDSBIT(words,i) GETBIT((words)[(i)/BITWORD_SIZE],(i)%BITWORD_SIZE)
+#define   SETWORDSBIT(words,i) SETBIT((words)[(i)/BITWORD_SIZE],(i)%BITWORD_SIZE)
 
 #define MAX(a,b) (a > b ? a : b )
 
@@ -28,6 +28,8 @@ const char* pebbling_Type() {
   return Name;
 }
 
+int reversible_pebbling() { return 1; }
+
 #elif BLACK_WHITE_PEBBLING
 
 const char* pebbling_type() {
@@ -40,6 +42,8 @@ const char* pebbling_Type() {
   return Name;
 }
 
+int reversible_pebbling() { return 0; }
+
 #else 
 
 const char* pebbling_type() {
@@ -52,6 +56,8 @@ const char* pebbling_Type() {
   return Name;
 }
 
+int reversible_pebbling() { return 0; }
+
 #endif
 
 
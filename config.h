@@ -16,5 +16,8 @@
 const char* pebbling_Type();
 const char* pebbling_type();
 
+/* Non zero in reversible pebbling, which some engines require */
+int reversible_pebbling();
+
 
 #endif /* _CONFIG_H_ */
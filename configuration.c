@@ -0,0 +1,727 @@
+/*
+   Copyright (C) 2010, 2011, 2012, 2013, 2014 by Massimo Lauria <lauria.massimo@gmail.com>
+
+   Created   : "2010-12-17, venerdì 12:01 (CET) Massimo Lauria"
+   Time-stamp: "2014-06-03, 10:12 (EDT) Massimo Lauria"
+
+   Description::
+
+   Pebble configurations: basic management functions, to recognise
+   which vertices in the graph can be pebbled and which white pebble
+   can be removed, and the generation of the neighbour configurations.
+
+   This file is compiled once for each width of the configurations
+   (see bittuple.h).
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "common.h"
+#include "dag.h"
+#include "configuration.h"
+
+
+/**
+   Pebbling Configurations
+ */
+
+
+/* The set of pebbled vertices, which determines the active ones */
+static inline BitTuple pebbled_set(const PebbleConfiguration *c) {
+#if BLACK_WHITE_PEBBLING
+  return bt_or(c->white_pebbled,c->black_pebbled);
+#else
+  return c->black_pebbled;
+#endif
+}
+
+/* A new pebble on `v' may activate its successors. */
+static inline void activate_successors(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+
+  BitTuple pebbled = pebbled_set(c);
+
+  for(size_t i=0;i<g->outdegree[v];i++) {
+    Vertex w=g->out[v][i];
+    if (bt_haswords(pebbled,PRED_BITMASK(g,w),g->bitmask_words)) bt_set(&c->active,w);
+  }
+}
+
+/* Without a pebble on `v' none of its successors is active. */
+static inline void deactivate_successors(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+  bt_andnotwords(&c->active,SUCC_BITMASK(g,v),g->bitmask_words);
+}
+
+
+/**
+ * Set a pebble configuration to the empty one. The storage is
+ * provided by the caller.
+ *
+ * @param g the graph to be pebbled
+ * @param ptr a pointer to the configuration.
+ */
+void init_PebbleConfiguration(const DAG *g,PebbleConfiguration *const ptr) {
+
+  assert(isconsistent_DAG(g));
+  assert(ptr);
+
+#if BLACK_WHITE_PEBBLING
+  ptr->white_pebbled=bt_zero();
+#endif
+
+  ptr->black_pebbled=bt_zero();
+
+  ptr->used_pebbles = bt_zero();
+  
+  ptr->sink_touched =FALSE;
+
+  ptr->pebbles=0;
+
+  ptr->previous_configuration=NO_RECORD;
+  ptr->last_changed_vertex=0;
+  ptr->last_move=0x0;
+
+  /* Only the sources are active in the empty configuration */
+  ptr->active=bt_zero();
+  for(size_t i=0;i<g->source_number;i++) bt_set(&ptr->active,g->sources[i]);
+}
+
+/* This function checks if the configuration of pebbles referenced by
+   ptr is a consistent configuration for the graph referenced by
+   graph, which in turns must be consistent. */
+Boolean isconsistent_PebbleConfiguration(const DAG *graph,const PebbleConfiguration *ptr) {
+
+  assert(ptr);
+  assert(graph);
+
+  /* The size of the graph and the number of sinks must fit with the
+     pebbling representation. */
+  if (graph->size > BITTUPLE_SIZE) return FALSE;
+  if (graph->sink_number != 1)    return FALSE;
+
+  /* The configuration must not have both a white and a black pebble
+     on the same vertex */
+#if BLACK_WHITE_PEBBLING
+  if (!bt_iszero(bt_and(ptr->white_pebbled,ptr->black_pebbled))) return FALSE;
+#endif
+
+  /* If there's a pebble on the sink, sink is touched */
+  if (bt_get(ptr->black_pebbled,graph->sinks[0])) {
+    if (!ptr->sink_touched) return FALSE;
+  }
+
+#if BLACK_WHITE_PEBBLING
+if (bt_get(ptr->white_pebbled,graph->sinks[0])) {
+    if (!ptr->sink_touched) return FALSE;
+  }
+#endif
+  
+  /* Count the number of pebbles in the bitvector and check
+     consistency with the pebble counter */
+  unsigned int counter=0;
+
+  for(size_t i=0; i<graph->size; i++) {
+
+#if BLACK_WHITE_PEBBLING    
+    if (bt_get(ptr->white_pebbled,i)) counter++;
+#endif
+
+    if (bt_get(ptr->black_pebbled,i)) counter++;
+  }
+
+  if (counter!=ptr->pebbles) return FALSE;
+
+  /* Check that the mask is clean in the residual bits */
+  BitTuple mask = ptr->used_pebbles;
+
+#if BLACK_WHITE_PEBBLING
+  mask = bt_or(mask,ptr->white_pebbled);
+#endif
+  
+  mask = bt_or(mask,ptr->black_pebbled);
+  
+  if (!bt_fits(mask,graph->size)) return FALSE;
+
+  /* The active vertices must be the ones with all predecessors
+     pebbled. */
+  if (!bt_fits(ptr->active,graph->size)) return FALSE;
+  for(size_t i=0; i<graph->size; i++) {
+    if (bt_get(ptr->active,i) !=
+        bt_haswords(pebbled_set(ptr),PRED_BITMASK(graph,i),graph->bitmask_words)) return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+inline int configurationcost(const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+
+#if BLACK_WHITE_PEBBLING
+  return (int)bt_popcount(bt_or(c->white_pebbled,c->black_pebbled));
+#else
+  return (int)bt_popcount(c->black_pebbled);
+#endif
+}
+
+
+/**
+ * Store a configuration in compact form.
+ *
+ * @param r the record to be filled
+ * @param c the configuration
+ */
+void pack_PebbleConfiguration(PebbleRecord *const r,const PebbleConfiguration *c) {
+
+  assert(r);
+  assert(c);
+  assert(c->last_changed_vertex < BITTUPLE_SIZE);
+  assert(c->last_changed_vertex == (RecordVertex)c->last_changed_vertex);
+
+#if BLACK_WHITE_PEBBLING
+  r->white_pebbled = c->white_pebbled;
+#endif
+  r->black_pebbled = c->black_pebbled;
+
+#if !MOVE_LOG
+  r->previous_configuration = c->previous_configuration;
+#endif
+  r->last_changed_vertex    = (RecordVertex)c->last_changed_vertex;
+  r->flags                  = c->sink_touched ? RECORD_SINK_TOUCHED : 0x0;
+
+  if (c->previous_configuration==NO_RECORD)
+    r->flags |= RECORD_INITIAL;
+  else
+    r->flags |= c->last_move;
+}
+
+
+/**
+ * Compute the record of the configuration previous to a given one,
+ * by undoing the move on its last changed vertex. Only the fields
+ * which identify a configuration (pebbles and sink status) are
+ * meaningful, so the result must be looked up among the visited
+ * configurations.
+ *
+ * @param g the graph to be pebbled
+ * @param previous the record to be filled
+ * @param r the record of a configuration which is not the initial one
+ */
+void undo_PebbleRecord(const DAG *g,PebbleRecord *const previous,const PebbleRecord *r) {
+
+  assert(isconsistent_PebbleRecord(g,r));
+  assert(previous);
+  assert(!(r->flags & RECORD_INITIAL));
+
+  Vertex v=r->last_changed_vertex;
+
+  *previous = *r;
+#if !MOVE_LOG
+  previous->previous_configuration = NO_RECORD;
+#endif
+  previous->last_changed_vertex = 0;
+  previous->flags = r->flags & RECORD_SINK_TOUCHED;
+  if (r->flags & RECORD_FIRST_TOUCH) previous->flags = 0x0;
+
+  /* A placement is undone by a deletion, and vice versa */
+#if BLACK_WHITE_PEBBLING
+  if (r->flags & RECORD_WHITE_MOVE) {
+    if (bt_get(r->white_pebbled,v)) bt_reset(&previous->white_pebbled,v);
+    else                            bt_set(&previous->white_pebbled,v);
+    return;
+  }
+#endif
+  if (bt_get(r->black_pebbled,v)) bt_reset(&previous->black_pebbled,v);
+  else                            bt_set(&previous->black_pebbled,v);
+}
+
+
+/**
+ * Recover a configuration from its compact form. The record does not
+ * tell how the configuration has been reached, so it gets no previous
+ * configuration and all vertices count as used: the heuristics of
+ * next_PebbleConfiguration, which depend on the pebbling so far, do
+ * not discard any move from it.
+ *
+ * @param g the graph to be pebbled
+ * @param c the configuration to be filled
+ * @param r the record
+ */
+void unpack_PebbleRecord(const DAG *g,PebbleConfiguration *const c,const PebbleRecord *r) {
+
+  assert(isconsistent_PebbleRecord(g,r));
+  assert(c);
+
+  init_PebbleConfiguration(g,c);
+
+#if BLACK_WHITE_PEBBLING
+  c->white_pebbled = r->white_pebbled;
+#endif
+  c->black_pebbled = r->black_pebbled;
+  c->used_pebbles  = bt_prefix(g->size);
+  c->sink_touched  = (r->flags & RECORD_SINK_TOUCHED) ? TRUE : FALSE;
+  c->pebbles       = (unsigned int)recordcost(r);
+
+  c->last_changed_vertex = r->last_changed_vertex;
+  c->last_move           = r->flags & (RECORD_FIRST_TOUCH | RECORD_WHITE_MOVE);
+
+  BitTuple pebbled = pebbled_set(c);
+  for(Vertex v=0;v<g->size;v++) {
+    if (bt_haswords(pebbled,PRED_BITMASK(g,v),g->bitmask_words)) bt_set(&c->active,v);
+  }
+}
+
+
+/* This function checks if the record referenced by r is consistent
+   for the graph referenced by graph. */
+Boolean isconsistent_PebbleRecord(const DAG *graph,const PebbleRecord *r) {
+
+  assert(r);
+  assert(graph);
+
+  if (graph->size > BITTUPLE_SIZE) return FALSE;
+  if (graph->sink_number != 1)    return FALSE;
+
+  BitTuple mask = r->black_pebbled;
+
+#if BLACK_WHITE_PEBBLING
+  if (!bt_iszero(bt_and(r->white_pebbled,r->black_pebbled))) return FALSE;
+  mask = bt_or(mask,r->white_pebbled);
+#endif
+
+  /* If there's a pebble on the sink, sink is touched */
+  if (bt_get(mask,graph->sinks[0]) && !(r->flags & RECORD_SINK_TOUCHED)) return FALSE;
+
+  if (r->last_changed_vertex >= graph->size) return FALSE;
+
+  if (!bt_fits(mask,graph->size)) return FALSE;
+
+  return TRUE;
+}
+
+
+/* Number of pebbles in a stored configuration */
+inline int recordcost(const PebbleRecord *r) {
+
+  assert(r);
+
+#if BLACK_WHITE_PEBBLING
+  return (int)bt_popcount(bt_or(r->white_pebbled,r->black_pebbled));
+#else
+  return (int)bt_popcount(r->black_pebbled);
+#endif
+}
+
+
+/* ------------------------------ Manipulation of pebble status -----------------------------*/
+
+inline void deleteblack(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+  assert(isblack(v,g,c));
+#if REVERSIBLE_PEBBLING
+  assert(isactive(v,g,c));
+#endif
+
+  bt_reset(&c->black_pebbled,v);
+  bt_reset(&c->used_pebbles,v);
+  c->pebbles       -= 1;
+  c->last_move      = 0x0;
+#if REVERSIBLE_PEBBLING
+  bt_orwords(&c->used_pebbles,PRED_BITMASK(g,v),g->bitmask_words);
+#endif
+  deactivate_successors(v,g,c);
+}
+
+/* Determines if a vertex is black pebbled according to a specific
+   configuration */
+inline Boolean isblack(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+
+  return bt_get(c->black_pebbled,v);
+}
+
+inline void placeblack(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+  assert(!ispebbled(v,g,c));
+  assert(isactive(v,g,c));
+
+  bt_set(&c->black_pebbled,v);
+  c->pebbles       += 1;
+  c->last_move      = 0x0;
+  bt_orwords(&c->used_pebbles,PRED_BITMASK(g,v),g->bitmask_words);
+  activate_successors(v,g,c);
+
+  if (v==g->sinks[0] && !c->sink_touched) {
+    c->sink_touched = TRUE;
+    c->last_move   |= RECORD_FIRST_TOUCH;
+    bt_set(&c->used_pebbles,v);
+  }
+}
+
+
+#if BLACK_WHITE_PEBBLING
+
+inline void deletewhite(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+  assert(iswhite(v,g,c));
+  assert(isactive(v,g,c));
+
+  bt_reset(&c->white_pebbled,v);
+  bt_reset(&c->used_pebbles,v);
+  c->pebbles       -= 1;
+  c->last_move      = RECORD_WHITE_MOVE;
+  bt_orwords(&c->used_pebbles,PRED_BITMASK(g,v),g->bitmask_words);
+  deactivate_successors(v,g,c);
+}
+
+
+/* Determines if a vertex is white pebbled according to a specific
+   configuration */
+inline Boolean iswhite(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+
+  return bt_get(c->white_pebbled,v);
+}
+
+inline void placewhite(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+  assert(!ispebbled(v,g,c));
+
+  bt_set(&c->white_pebbled,v);
+  c->pebbles       += 1;
+  c->last_move      = RECORD_WHITE_MOVE;
+  activate_successors(v,g,c);
+
+  if (v==g->sinks[0] && !c->sink_touched) {
+    c->sink_touched=TRUE;
+    c->last_move   |= RECORD_FIRST_TOUCH;
+    bt_set(&c->used_pebbles,v);
+  }
+}
+
+#endif /* BLACK_WHITE_PEBBLING */
+
+/* Vertex Statuses */
+
+/* Determines if a vertex is pebbled according to a specific
+   configuration */
+inline Boolean ispebbled(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+
+#if BLACK_WHITE_PEBBLING
+  return bt_get(c->white_pebbled,v) || bt_get(c->black_pebbled,v);
+#else
+  return bt_get(c->black_pebbled,v);
+#endif
+}
+
+
+/* Determines if there is a pebble on all predecessors of a given
+   vertex */
+inline Boolean isactive(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+
+  return bt_get(c->active,v);
+}
+
+
+inline Boolean isused(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(v<g->size);
+
+  return bt_get(c->used_pebbles,v);
+}
+
+/* Persistent pebbling is realized by placing a pebble on top and then
+   by reaching the empty configuration. In both black-white
+   andreversible pebble the actual pebbling is inverted to result in
+   the desired pebbling that ends with a pebble on the sink.  In
+   black-white pebbling the inversion swaps the colors, so the pebble
+   on the sink is white: a black one would be final already. */
+void    init_persistent_pebbling(const DAG *g, PebbleConfiguration *const c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+
+  assert(g->sink_number==1);
+  assert(!ispebbled(g->sinks[0],g,c));
+#if REVERSIBLE_PEBBLING
+  bt_set(&c->black_pebbled,g->sinks[0]);
+#elif BLACK_WHITE_PEBBLING
+  bt_set(&c->white_pebbled,g->sinks[0]);
+#else
+  assert(0);
+#endif
+  
+  c->pebbles       += 1;
+  c->sink_touched = TRUE;
+  bt_set(&c->used_pebbles,g->sinks[0]);
+  activate_successors(g->sinks[0],g,c);
+}
+
+
+/* Determines if the configuration is final for a visiting
+   pebbling. In a visiting pebbling we start with an empty
+   configuration an we try to touch the sink. And reach a
+   configuration without white pebbles. */
+inline Boolean isfinal_visiting(const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+
+#if BLACK_WHITE_PEBBLING
+  if (!bt_iszero(c->white_pebbled)) return FALSE;
+#endif
+
+  if (c->sink_touched==TRUE) return TRUE;
+  else return FALSE;
+}
+
+/* Determines if the configuration is final for a persistent
+   pebbling. In a persistent pebbling we start with a configuration
+   with a hard to remove pebble on the sink (i.e. makes sense for
+   white and reversible) and we try to reach the configuration with no
+   hard to remove pebbles. */
+inline Boolean isfinal_persistent(const DAG *g,const PebbleConfiguration *c) {
+
+  assert(isconsistent_DAG(g));
+  assert(isconsistent_PebbleConfiguration(g,c));
+  assert(c->sink_touched);
+  
+#if BLACK_WHITE_PEBBLING
+  if (!bt_iszero(c->white_pebbled)) return FALSE;
+#elif REVERSIBLE_PEBBLING
+  if (!bt_iszero(c->black_pebbled)) return FALSE;
+#else
+  assert(FALSE);           /* persistent pebbling makes sense only for reversible and black/white pebblings */
+#endif
+
+  return TRUE;
+}
+
+
+/* Heuristics */
+
+#if BLACK_WHITE_PEBBLING==1
+
+static inline Boolean place_white_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  if (c->previous_configuration==NO_RECORD) return FALSE;
+  if (v==c->last_changed_vertex) return TRUE;
+
+  /* Never place two pebbles on vertices with decreasing
+     rank. Notice that successors always have bigger rank.  */
+  if (ispebbled(c->last_changed_vertex,g,c) && (v < c->last_changed_vertex)) return TRUE;
+
+  return FALSE;
+}
+
+#endif
+
+static inline Boolean place_black_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  if (c->previous_configuration==NO_RECORD) return FALSE;
+  if (v==c->last_changed_vertex) return TRUE;
+
+  /* Never place two pebbles on vertices with decreasing
+     rank. Notice that successors always have bigger rank.  */
+  if (ispebbled(c->last_changed_vertex,g,c) && (v < c->last_changed_vertex)) return TRUE;
+
+  return FALSE;
+}
+
+
+#if BLACK_WHITE_PEBBLING
+static inline Boolean delete_white_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  if (!isused(v, g, c)) return TRUE;
+
+  Vertex w=c->last_changed_vertex;
+  if (c->previous_configuration==NO_RECORD) return FALSE;
+  if (v==w) return TRUE;  /* White pebble can't be placed and removed,
+                             not even of the sink */
+
+  /* Never remove pebbles on vertices with increasing
+     rank. Notice that predecessors always have smaller rank.  */
+  if (!ispebbled(w,g,c) && (v > w)) return TRUE;
+
+  /* If a white pebble removal is after a placement, ... */
+  if (ispebbled(w,g,c)) {
+    /* either the placed pebble is necessary for the removal ... */
+    if (GETWORDSBIT(PRED_BITMASK(g,v),w)) return FALSE;
+    /* or the white pebble was necessary for the placement ... */
+    if (GETWORDSBIT(SUCC_BITMASK(g,v),w) && isblack(w,g,c)) return FALSE;
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+
+}
+#endif
+ 
+static inline Boolean delete_black_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+
+  if (!isused(v, g, c)) return TRUE;
+
+  Vertex w=c->last_changed_vertex;
+  if (c->previous_configuration==NO_RECORD) return FALSE;
+  if (v==w) return (g->sinks[0]!=w);    /* A black pebble may be
+                                           placed and then removed iff
+                                           it's on the sink. */
+
+  /* Never remove pebbles on vertices with increasing
+     rank. Notice that predecessors always have smaller rank.  */
+  if (!ispebbled(w,g,c) && (v > w)) return TRUE;
+
+  /* If a black pebble removal is after a placement, then the placed
+     vertex must be a black pebbled successor, unless we are doing a
+     reversible pebbling.
+  */
+#if !REVERSIBLE_PEBBLING
+  if (ispebbled(w,g,c)) {
+    if (!isblack(w,g,c)) return TRUE;
+    if (!GETWORDSBIT(SUCC_BITMASK(g,v),w)) return TRUE;
+  }
+#endif
+  
+  return FALSE;
+}
+
+
+
+/* The legal moves are computed from the pebbled and the active
+   vertices. The possible move on a vertex is unique, see
+   next_PebbleConfiguration. */
+BitTuple legalmoves(const DAG *g,const PebbleConfiguration *c,unsigned int max_pebbles) {
+
+  assert(isconsistent_PebbleConfiguration(g,c));
+
+  BitTuple moves;
+  Boolean  canplace = (c->pebbles < max_pebbles);
+
+#if BLACK_WHITE_PEBBLING
+  /* Black pebbles and active white pebbles can be removed, and a
+     pebble can be placed on every other vertex. */
+  moves = bt_or(c->black_pebbled,bt_and(c->white_pebbled,c->active));
+  if (canplace) moves = bt_or(moves,bt_andnot(bt_prefix(g->size),pebbled_set(c)));
+#elif REVERSIBLE_PEBBLING
+  /* Black pebbles can be removed or placed on active vertices */
+  moves = canplace ? c->active : bt_and(c->black_pebbled,c->active);
+#else
+  /* Black pebbles can be removed, and placed on active vertices */
+  moves = c->black_pebbled;
+  if (canplace) moves = bt_or(moves,c->active);
+#endif
+
+  return moves;
+}
+
+
+/* Each pebble configuration has a number of neightbours less than or
+   equal to the number of vertices.  For each vertex you can either
+   add a pebble (if possible) or remove one (if present).  The
+   possible move is unique for every vertex.
+*/
+Boolean next_PebbleConfiguration(const Vertex v,
+                                 const DAG *g,
+                                 const PebbleConfiguration *old,
+                                 unsigned int max_pebbles,
+                                 PebbleConfiguration *const nconf) {
+
+  assert(isconsistent_PebbleConfiguration(g,old));
+  assert(nconf);
+  assert(nconf!=old);
+
+#if REVERSIBLE_PEBBLING
+  if ( isblack(v,g,old) && isactive(v,g,old)) {
+#else
+  if ( isblack(v,g,old) ) {
+#endif
+
+    if (delete_black_heuristics_cut(v,g,old)) return FALSE;
+
+    /* Delete BLACK */
+    *nconf=*old;
+    deleteblack(v,g,nconf);
+
+    assert(isconsistent_PebbleConfiguration(g,nconf));
+    return TRUE;
+    }
+
+#if BLACK_WHITE_PEBBLING
+  
+  if ( iswhite(v,g,old) && isactive(v,g,old) ) { /* Delete WHITE */
+
+    if (delete_white_heuristics_cut(v,g,old)) return FALSE;
+
+    *nconf=*old;
+    deletewhite(v,g,nconf);
+
+    assert(isconsistent_PebbleConfiguration(g,nconf));
+    return TRUE;
+  }
+#endif /* BLACK_WHITE_PEBBLING */
+  
+  if ( !ispebbled(v,g,old) && isactive(v,g,old) ) { /* Place BLACK */
+
+    if (old->pebbles >= max_pebbles) return FALSE;
+    if (place_black_heuristics_cut(v,g,old)) return FALSE;
+
+    *nconf=*old;
+
+    placeblack(v,g,nconf);
+
+    assert(isconsistent_PebbleConfiguration(g,nconf));
+    return TRUE;
+  }
+
+#if BLACK_WHITE_PEBBLING
+  if ( !ispebbled(v,g,old) && !isactive(v,g,old)) { /* Place WHITE */
+
+    if (old->pebbles >= max_pebbles) return FALSE;
+    if (place_white_heuristics_cut(v,g,old)) return FALSE;
+
+
+    *nconf=*old;
+    placewhite(v,g,nconf);
+
+    assert(isconsistent_PebbleConfiguration(g,nconf));
+    return TRUE;
+  }
+#endif /* BLACK_WHITE_PEBBLING */
+
+  /* No operation allowed on the chosen vertex. */
+  return FALSE;
+}
+
+
@@ -0,0 +1,228 @@
+/*
+   Copyright (C) 2010, 2011, 2012, 2013, 2014 by Massimo Lauria <lauria.massimo@gmail.com>
+
+   Created   : "2010-12-17, venerdì 12:03 (CET) Massimo Lauria"
+   Time-stamp: "2014-06-03, 10:12 (EDT) Massimo Lauria"
+
+   Description::
+
+   Pebble configurations, used by the search for a pebbling.
+
+   This header requires the width of the configurations to be chosen
+   (see bittuple.h). The code in configuration.c is compiled once for
+   each width, and its functions get a suffix which identifies it.
+
+*/
+
+
+/* Preamble */
+#ifndef  CONFIGURATION_H
+#define  CONFIGURATION_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "common.h"
+#include "dag.h"
+#include "bittuple.h"
+#include "pebbling.h"
+
+/* Symbols of the build for the current width */
+#define init_PebbleConfiguration          WIDTH_SYMBOL(init_PebbleConfiguration)
+#define isconsistent_PebbleConfiguration  WIDTH_SYMBOL(isconsistent_PebbleConfiguration)
+#define pack_PebbleConfiguration          WIDTH_SYMBOL(pack_PebbleConfiguration)
+#define isconsistent_PebbleRecord         WIDTH_SYMBOL(isconsistent_PebbleRecord)
+#define recordcost                        WIDTH_SYMBOL(recordcost)
+#define isfinal_persistent                WIDTH_SYMBOL(isfinal_persistent)
+#define isfinal_visiting                  WIDTH_SYMBOL(isfinal_visiting)
+#define init_persistent_pebbling          WIDTH_SYMBOL(init_persistent_pebbling)
+#define configurationcost                 WIDTH_SYMBOL(configurationcost)
+#define iswhite                           WIDTH_SYMBOL(iswhite)
+#define placewhite                        WIDTH_SYMBOL(placewhite)
+#define deletewhite                       WIDTH_SYMBOL(deletewhite)
+#define isblack                           WIDTH_SYMBOL(isblack)
+#define placeblack                        WIDTH_SYMBOL(placeblack)
+#define deleteblack                       WIDTH_SYMBOL(deleteblack)
+#define ispebbled                         WIDTH_SYMBOL(ispebbled)
+#define isactive                          WIDTH_SYMBOL(isactive)
+#define isused                            WIDTH_SYMBOL(isused)
+#define next_PebbleConfiguration          WIDTH_SYMBOL(next_PebbleConfiguration)
+#define legalmoves                        WIDTH_SYMBOL(legalmoves)
+#define undo_PebbleRecord                 WIDTH_SYMBOL(undo_PebbleRecord)
+#define unpack_PebbleRecord               WIDTH_SYMBOL(unpack_PebbleRecord)
+
+/* If MOVE_LOG is set, the records of visited configurations do not
+   keep the index of the previous one, see PebbleRecord. */
+#ifndef MOVE_LOG
+#define MOVE_LOG 1
+#endif
+
+
+/* Records of visited configurations are addressed by 32 bits
+   indices. */
+typedef uint32_t RecordIndex;
+#define NO_RECORD ((RecordIndex)0xFFFFFFFFUL)
+
+/**
+ *  A pebble configuration is represented by a bitset of at most
+ *  BITTUPLE_SIZE elements.  This allows to represent the pebbling in
+ *  small space, which is the most important thing since the
+ *  configuration may be a large number.
+ */
+typedef struct _PebbleConfiguration {
+
+  /* Since the configuration space can be large, we use integers of
+   specific size as bit tuples of fixed length.  The specific integer
+   type is defined here. */
+
+#if BLACK_WHITE_PEBBLING
+  BitTuple white_pebbled;    /* White pebbled vertices */
+#endif
+
+  BitTuple black_pebbled;    /* Black pebbled vertices */
+
+
+  BitTuple used_pebbles;     /* Pebbles used at least once */
+
+  /* Vertices with all predecessors pebbled (black pebbled, except in
+     black-white pebbling). It is updated at each move, using the
+     successors of the vertex, so that the legal moves can be computed
+     as bitmasks. */
+  BitTuple active;
+  
+  Boolean sink_touched;
+
+  unsigned int pebbles;  /* Number of pebbles in the pebbling */
+
+  
+  /* Information regarding the configuration transition: what is the
+     record of the previous configuration? What was the vertex we
+     acted on to reach the present configuration? */
+  RecordIndex previous_configuration;
+  Vertex last_changed_vertex;
+  uint8_t last_move;     /* RECORD_FIRST_TOUCH and RECORD_WHITE_MOVE */
+
+} PebbleConfiguration;
+
+
+/**
+ *  The configurations visited by the search are stored in a compact
+ *  form, which keeps only what is needed to recognize the
+ *  configuration and to reconstruct the pebbling: the pebbled
+ *  vertices, whether the sink has been touched, and the vertex which
+ *  changed. The number of pebbles is recomputed when needed.
+ *
+ *  Each move changes a single vertex, thus the previous configuration
+ *  is obtained by undoing the move on the vertex (see
+ *  undo_PebbleRecord), and its record is found in the dictionary of
+ *  visited configurations. The flags tell whether the move touched
+ *  the sink for the first time, and whether it was on a white pebble,
+ *  which is what is needed to undo it.
+ *
+ *  Unless MOVE_LOG is set, each record also keeps the index of the
+ *  record of the previous configuration, so that the pebbling can be
+ *  reconstructed without the dictionary.
+ *
+ *  With MOVE_LOG, for graphs up to 16 vertices a record takes 4
+ *  bytes in black and reversible pebbling, 8 bytes for graphs up to
+ *  32 vertices, and 16 for graphs up to 64 vertices.
+ */
+#define RECORD_SINK_TOUCHED  0x01   /* The sink has been touched */
+#define RECORD_INITIAL       0x02   /* No previous configuration */
+#define RECORD_FIRST_TOUCH   0x04   /* The move touched the sink for the first time */
+#define RECORD_WHITE_MOVE    0x08   /* The move placed or removed a white pebble */
+
+#if BITTUPLE_WIDE && WIDE_WORDS > 4
+typedef uint16_t RecordVertex;
+#else
+typedef uint8_t  RecordVertex;
+#endif
+
+typedef struct {
+
+#if BLACK_WHITE_PEBBLING
+  BitTuple white_pebbled;
+#endif
+  BitTuple black_pebbled;
+
+#if !MOVE_LOG
+  RecordIndex  previous_configuration;   /* NO_RECORD for the initial one */
+#endif
+  RecordVertex last_changed_vertex;
+  uint8_t      flags;
+
+} PebbleRecord;
+
+extern void         init_PebbleConfiguration(const DAG *g,PebbleConfiguration *const ptr);
+extern Boolean      isconsistent_PebbleConfiguration(const DAG *graph,const PebbleConfiguration *ptr);
+
+extern void    pack_PebbleConfiguration(PebbleRecord *const r,const PebbleConfiguration *c);
+extern Boolean isconsistent_PebbleRecord(const DAG *graph,const PebbleRecord *r);
+extern int     recordcost(const PebbleRecord *r);
+extern void    undo_PebbleRecord(const DAG *g,PebbleRecord *const previous,const PebbleRecord *r);
+extern void    unpack_PebbleRecord(const DAG *g,PebbleConfiguration *const c,const PebbleRecord *r);
+
+extern Boolean isfinal_persistent(const DAG *g,const PebbleConfiguration *c);
+extern Boolean isfinal_visiting(const DAG *g,const PebbleConfiguration *c);
+extern void    init_persistent_pebbling(const DAG *g,PebbleConfiguration *const c);  
+
+
+extern int     configurationcost(const DAG *g,const PebbleConfiguration *c);
+
+/* Vertices operations */
+
+#if BLACK_WHITE_PEBBLING
+extern Boolean iswhite    (const Vertex v, const DAG *g, const PebbleConfiguration *c);
+extern void    placewhite (const Vertex v, const DAG *g, PebbleConfiguration *const c);
+extern void    deletewhite(const Vertex v, const DAG *g, PebbleConfiguration *const c);
+#endif
+
+extern Boolean isblack    (const Vertex v, const DAG *g, const PebbleConfiguration *c);
+extern void    placeblack (const Vertex v, const DAG *g, PebbleConfiguration *const c);
+extern void    deleteblack(const Vertex v, const DAG *g, PebbleConfiguration *const c);
+
+extern Boolean ispebbled(const Vertex v, const DAG *g, const PebbleConfiguration *c);
+extern Boolean isactive (const Vertex v, const DAG *g, const PebbleConfiguration *c);
+extern Boolean isused(const Vertex v, const DAG *g, const PebbleConfiguration *c);
+
+
+
+
+/**
+   The set of vertices on which a move is legal in a configuration,
+   given the maximum number of pebbles. The heuristics used by
+   next_PebbleConfiguration may still discard some of them.
+*/
+extern BitTuple legalmoves(const DAG *g,
+                           const PebbleConfiguration *c,
+                           unsigned int max_pebbles);
+
+
+/**
+   Produce a neighbor configuration 
+   
+   Given a configuration, produces the neighbor configuration obtained
+   operating on vertex v. This is well defined since there is at most
+   one action which is sensible to do on a given vertex.
+
+   In some cases some legal configuration are not produced if the
+   resulting pebbling would be clearly sub optimal (this heuristics
+   are put in place to reduce the runtime and the growth of the search
+   space).
+   
+   OUTPUT:
+
+   The neighbor is written in `nconf', which is provided by the
+   caller (usually as scratch space, so that nothing is allocated
+   for neighbors which turn out to be already visited).
+
+   @return TRUE if `nconf' has been filled, FALSE otherwise
+*/
+extern Boolean next_PebbleConfiguration(const Vertex v,
+                                        const DAG *g,
+                                        const PebbleConfiguration *old,
+                                        unsigned int max_pebbles,
+                                        PebbleConfiguration *const nconf);
+
+
+
+#endif /* CONFIGURATION_H */
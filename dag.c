@@ -59,23 +59,19 @@ void dag_precompute_data(DAG *digraph) {
   }
 
   /* Computes the predecessors and successors bitmaks */
-  if (digraph->size > BITTUPLE_SIZE) {
-    digraph->pred_bitmasks = NULL;
-    digraph->succ_bitmasks = NULL;
-  } else {
-    digraph->pred_bitmasks=(BitTuple*)malloc(sizeof(BitTuple)*(digraph->size));
-    digraph->succ_bitmasks=(BitTuple*)malloc(sizeof(BitTuple)*(digraph->size));
-    for(Vertex v=0;v<digraph->size;v++) {
-      digraph->pred_bitmasks[v]=BITTUPLE_ZERO;
-      digraph->succ_bitmasks[v]=BITTUPLE_ZERO;
-      for(size_t j=0;j<digraph->indegree[v];j++) {
-        assert(digraph->in[v][j] < v );
-        digraph->pred_bitmasks[v] |= (BITTUPLE_UNIT << digraph->in[v][j]);
-      }
-      for(size_t j=0;j<digraph->outdegree[v];j++) {
-        assert(digraph->out[v][j] > v);
-        digraph->succ_bitmasks[v] |= (BITTUPLE_UNIT << digraph->out[v][j]);
-      }
+  digraph->bitmask_words = BITWORDS(digraph->size);
+  digraph->pred_bitmasks=(BitWord*)calloc(digraph->size*digraph->bitmask_words,sizeof(BitWord));
+  digraph->succ_bitmasks=(BitWord*)calloc(digraph->size*digraph->bitmask_words,sizeof(BitWord));
+  assert(digraph->pred_bitmasks);
+  assert(digraph->succ_bitmasks);
+  for(Vertex v=0;v<digraph->size;v++) {
+    for(size_t j=0;j<digraph->indegree[v];j++) {
+      assert(digraph->in[v][j] < v );
+      SETWORDSBIT(PRED_BITMASK(digraph,v),digraph->in[v][j]);
+    }
+    for(size_t j=0;j<digraph->outdegree[v];j++) {
+      assert(digraph->out[v][j] > v);
+      SETWORDSBIT(SUCC_BITMASK(digraph,v),digraph->out[v][j]);
     }
   }
 }
@@ -203,14 +199,10 @@ Boolean isconsistent_DAG(const DAG *ptr) {
   assert(ptr->sinks);
   assert(ptr->sources);
 
-  /* Bitmasks are present iff they are big enough */
-  if (ptr->size <= BITTUPLE_SIZE) {
-    assert(ptr->pred_bitmasks);
-    assert(ptr->succ_bitmasks);
-  } else {
-    assert(ptr->pred_bitmasks==NULL);
-    assert(ptr->succ_bitmasks==NULL);
-  }
+  /* Bitmasks are always present */
+  assert(ptr->bitmask_words == BITWORDS(ptr->size));
+  assert(ptr->pred_bitmasks);
+  assert(ptr->succ_bitmasks);
   return TRUE;
 }
 
@@ -305,6 +297,335 @@ void fprint_dot_DAG(FILE *outfile,
 /* }}} */
 
 
+/********************************************************************************
+                     AUTOMORPHISMS
+ ********************************************************************************/
+
+/*
+   The automorphisms of the graph are found by individualization and
+   refinement. A coloring of the vertices is refined until the color
+   of a vertex determines the colors of its predecessors and of its
+   successors. Two colorings are refined together, so that colors
+   mean the same in both: an automorphism which maps the first
+   coloring to the second maps each vertex to one of the same color,
+   and when all colors are distinct the colorings give the map.
+*/
+
+/* Signature of a vertex: its color, then the number and the sorted
+   colors of its predecessors, and the same for its successors. */
+typedef struct {
+  size_t *data;
+  size_t  length;
+} Signature;
+
+static int compare_signatures(const Signature *a,const Signature *b) {
+
+  size_t l= a->length < b->length ? a->length : b->length;
+
+  for(size_t i=0;i<l;i++) {
+    if (a->data[i]!=b->data[i]) return a->data[i] < b->data[i] ? -1 : 1;
+  }
+  return (a->length > b->length) - (a->length < b->length);
+}
+
+/* Merge sort of the items by signature */
+static void sort_by_signature(size_t *items,size_t *buffer,size_t n,const Signature *s) {
+
+  if (n<2) return;
+
+  size_t h=n/2,i=0,j=h,k=0;
+  sort_by_signature(items,  buffer,h,  s);
+  sort_by_signature(items+h,buffer,n-h,s);
+
+  while(i<h && j<n)
+    buffer[k++] = (compare_signatures(&s[items[j]],&s[items[i]]) < 0) ? items[j++] : items[i++];
+  while(i<h) buffer[k++]=items[i++];
+  while(j<n) buffer[k++]=items[j++];
+  memcpy(items,buffer,n*sizeof(size_t));
+}
+
+/* Insertion sort of few colors */
+static void sort_colors(size_t *c,size_t n) {
+
+  for(size_t i=1;i<n;i++) {
+    size_t x=c[i],j=i;
+    while(j>0 && c[j-1]>x) { c[j]=c[j-1]; j--; }
+    c[j]=x;
+  }
+}
+
+/*
+   Refine a coloring, or two colorings together. The colors are
+   replaced by the ranks of the signatures of the vertices, until the
+   number of colors does not grow anymore. The colors given must be
+   at most the number of vertices.
+
+   @param right the second coloring, or NULL
+
+   @return the number of colors, or zero if some color has a
+   different number of vertices in the two colorings.
+*/
+static size_t refine_colorings(const DAG *g,size_t *left,size_t *right) {
+
+  size_t n=g->size;
+  size_t sides= right ? 2 : 1;
+  size_t N=sides*n;
+  size_t *colors[2]={left,right};
+
+  size_t edges=0;
+  for(Vertex v=0;v<n;v++) edges += g->indegree[v] + g->outdegree[v];
+
+  size_t    *data  =(size_t*)malloc(sides*(3*n+edges)*sizeof(size_t));
+  Signature *sig   =(Signature*)malloc(N*sizeof(Signature));
+  size_t    *items =(size_t*)malloc(N*sizeof(size_t));
+  size_t    *buffer=(size_t*)malloc(N*sizeof(size_t));
+  size_t    *count =(size_t*)calloc(N+1,sizeof(size_t));
+  assert(data && sig && items && buffer && count);
+
+  /* Number of colors given */
+  size_t number=0;
+  for(size_t k=0;k<N;k++) {
+    size_t c=colors[k/n][k%n];
+    assert(c<=n);
+    if (count[c]++==0) number++;
+  }
+
+  for(;;) {
+
+    size_t *p=data;
+    for(size_t k=0;k<N;k++) {
+      const size_t *color=colors[k/n];
+      Vertex v=k%n;
+
+      sig[k].data=p;
+      *p++ = color[v];
+      *p++ = g->indegree[v];
+      for(size_t j=0;j<g->indegree[v];j++) p[j]=color[g->in[v][j]];
+      sort_colors(p,g->indegree[v]);
+      p += g->indegree[v];
+      *p++ = g->outdegree[v];
+      for(size_t j=0;j<g->outdegree[v];j++) p[j]=color[g->out[v][j]];
+      sort_colors(p,g->outdegree[v]);
+      p += g->outdegree[v];
+      sig[k].length = (size_t)(p - sig[k].data);
+
+      items[k]=k;
+    }
+    sort_by_signature(items,buffer,N,sig);
+
+    /* The new colors are the ranks of the signatures */
+    size_t rank=0;
+    for(size_t i=0;i<N;i++) {
+      if (i>0 && compare_signatures(&sig[items[i-1]],&sig[items[i]])!=0) rank++;
+      buffer[items[i]]=rank;
+    }
+    for(size_t k=0;k<N;k++) colors[k/n][k%n]=buffer[k];
+
+    if (rank+1==number) break;
+    number=rank+1;
+  }
+
+  /* The colorings must have the same number of vertices of each
+     color */
+  if (right) {
+    memset(count,0,(N+1)*sizeof(size_t));
+    for(Vertex v=0;v<n;v++) { count[left[v]]++; count[right[v]]--; }
+    for(size_t c=0;c<number;c++) if (count[c]!=0) { number=0; break; }
+  }
+
+  free(count);
+  free(buffer);
+  free(items);
+  free(sig);
+  free(data);
+  return number;
+}
+
+/* The first color of more than one vertex, and its first vertex.
+
+   @return FALSE if all colors are distinct */
+static Boolean first_cell(size_t n,const size_t *colors,size_t *cell,Vertex *first) {
+
+  size_t *count=(size_t*)calloc(n,sizeof(size_t));
+  assert(count);
+
+  Boolean found=FALSE;
+  for(Vertex v=0;v<n;v++) count[colors[v]]++;
+  for(size_t c=0;c<n && !found;c++) {
+    if (count[c]<2) continue;
+    *cell=c;
+    found=TRUE;
+  }
+  for(Vertex v=0;found && v<n;v++) if (colors[v]==*cell) { *first=v; break; }
+
+  free(count);
+  return found;
+}
+
+static Boolean is_automorphism(const DAG *g,const Vertex *map) {
+
+  for(Vertex v=0;v<g->size;v++) {
+    if (g->indegree[v]!=g->indegree[map[v]]) return FALSE;
+    for(size_t j=0;j<g->indegree[v];j++) {
+      if (!GETWORDSBIT(PRED_BITMASK(g,map[v]),map[g->in[v][j]])) return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/*
+   Look for an automorphism which maps the left coloring to the right
+   one, which have been refined together and have `number' colors. A
+   vertex of the first cell of more than one vertex is given a new
+   color, together with each vertex of the same color in the right
+   coloring in turn (itself first).
+
+   @return TRUE if there is such an automorphism, which is written in
+   `map'
+*/
+static Boolean extend_automorphism(const DAG *g,const size_t *left,const size_t *right,
+                                   size_t number,Vertex *map) {
+
+  size_t n=g->size;
+  size_t cell;
+  Vertex x;
+
+  if (!first_cell(n,left,&cell,&x)) {
+    Vertex *owner=(Vertex*)malloc(n*sizeof(Vertex));
+    assert(owner);
+    for(Vertex v=0;v<n;v++) owner[right[v]]=v;
+    for(Vertex v=0;v<n;v++) map[v]=owner[left[v]];
+    free(owner);
+    return is_automorphism(g,map);
+  }
+
+  size_t *l=(size_t*)malloc(2*n*sizeof(size_t));
+  size_t *r=l+n;
+  assert(l);
+
+  Boolean found=FALSE;
+  for(Vertex i=0;i<=n && !found;i++) {
+    Vertex y = (i==0) ? x : i-1;
+    if (right[y]!=cell || (i>0 && y==x)) continue;
+
+    memcpy(l,left, n*sizeof(size_t));
+    memcpy(r,right,n*sizeof(size_t));
+    l[x]=number;
+    r[y]=number;
+    size_t m=refine_colorings(g,l,r);
+    found = (m>0) && extend_automorphism(g,l,r,m,map);
+  }
+
+  free(l);
+  return found;
+}
+
+/* Generators found so far */
+typedef struct {
+  Vertex *maps;
+  size_t  number;
+  size_t  allocation;
+} Generators;
+
+/* Vertices reached from `b' by the generators */
+static void orbit_of(size_t n,const Generators *G,Vertex b,Boolean *orbit,Vertex *stack) {
+
+  size_t top=0;
+
+  memset(orbit,0,n*sizeof(Boolean));
+  orbit[b]=TRUE;
+  stack[top++]=b;
+  while(top>0) {
+    Vertex u=stack[--top];
+    for(size_t i=0;i<G->number;i++) {
+      Vertex w=G->maps[i*n+u];
+      if (orbit[w]) continue;
+      orbit[w]=TRUE;
+      stack[top++]=w;
+    }
+  }
+}
+
+/*
+   Generators of the automorphisms which preserve a refined coloring
+   with `number' colors. A vertex b of the first cell of more than one
+   vertex gets a new color, and the generators of the automorphisms
+   which fix it are found first. Then an automorphism which maps b to
+   each other vertex of the cell is looked for, unless the generators
+   found so far already do: all of them preserve the coloring, so
+   together they generate all its automorphisms.
+*/
+static void find_generators(const DAG *g,const size_t *colors,size_t number,Generators *G) {
+
+  size_t n=g->size;
+  size_t cell;
+  Vertex b;
+
+  if (!first_cell(n,colors,&cell,&b)) return;
+
+  size_t  *l     =(size_t*)malloc(2*n*sizeof(size_t));
+  size_t  *r     =l+n;
+  Boolean *orbit =(Boolean*)malloc(n*sizeof(Boolean));
+  Vertex  *stack =(Vertex*)malloc(n*sizeof(Vertex));
+  assert(l && orbit && stack);
+
+  memcpy(l,colors,n*sizeof(size_t));
+  l[b]=number;
+  find_generators(g,l,refine_colorings(g,l,NULL),G);
+
+  for(Vertex w=0;w<n;w++) {
+    if (w==b || colors[w]!=cell) continue;
+
+    orbit_of(n,G,b,orbit,stack);
+    if (orbit[w]) continue;
+
+    memcpy(l,colors,n*sizeof(size_t));
+    memcpy(r,colors,n*sizeof(size_t));
+    l[b]=number;
+    r[w]=number;
+    size_t m=refine_colorings(g,l,r);
+
+    if (G->number==G->allocation) {
+      G->allocation = 2*G->allocation + 1;
+      G->maps=(Vertex*)realloc(G->maps,G->allocation*n*sizeof(Vertex));
+      assert(G->maps);
+    }
+    if (m>0 && extend_automorphism(g,l,r,m,G->maps+G->number*n)) G->number++;
+  }
+
+  free(stack);
+  free(orbit);
+  free(l);
+}
+
+/*
+   Generators of the group of automorphisms of the graph. Each
+   generator is the array of the images of the vertices, and the
+   generators are stored one after the other.
+
+   @param number the number of generators
+
+   @return the generators, to be freed, or NULL if the graph has no
+   automorphism but the identity
+*/
+Vertex *automorphisms_DAG(const DAG *g,size_t *number) {
+
+  assert(isconsistent_DAG(g));
+  assert(number);
+
+  Generators G={NULL,0,0};
+  size_t *colors=(size_t*)calloc(g->size,sizeof(size_t));
+  assert(colors);
+
+  find_generators(g,colors,refine_colorings(g,colors,NULL),&G);
+  free(colors);
+
+  *number=G.number;
+  if (G.number==0) { free(G.maps); return NULL; }
+  return G.maps;
+}
+
+
 /********************************************************************************
                      STRUCTURE BUILDING FUNCTIONS
  ********************************************************************************/
@@ -318,6 +639,7 @@ void fprint_dot_DAG(FILE *outfile,
   assert(height>=0);
 
   /* Set to null sinks and source vector */
+  d->bitmask_words=0;
   d->pred_bitmasks=NULL;
   d->succ_bitmasks=NULL;
   d->sources=NULL;
@@ -400,6 +722,7 @@ void fprint_dot_DAG(FILE *outfile,
   assert(h>=0);
 
   /* Set to null sinks and source vector */
+  d->bitmask_words=0;
   d->pred_bitmasks=NULL;
   d->succ_bitmasks=NULL;
   d->sources=NULL;
@@ -485,6 +808,7 @@ void fprint_dot_DAG(FILE *outfile,
   assert(d);
 
   /* Set to null sinks and source vector */
+  d->bitmask_words=0;
   d->pred_bitmasks=NULL;
   d->succ_bitmasks=NULL;
   d->sources=NULL;
@@ -551,6 +875,7 @@ void fprint_dot_DAG(FILE *outfile,
   assert(d);
 
   /* Set to null sinks and source vector */
+  d->bitmask_words=0;
   d->pred_bitmasks=NULL;
   d->succ_bitmasks=NULL;
   d->sources=NULL;
@@ -633,6 +958,7 @@ void fprint_dot_DAG(FILE *outfile,
   p->size=S;
 
   /* Set to null sinks and source vector */
+  p->bitmask_words=0;
   p->pred_bitmasks=NULL;
   p->succ_bitmasks=NULL;
   p->sources=NULL;
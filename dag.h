@@ -52,8 +52,12 @@ typedef struct {
 
   /* The following data is precomputed for efficiency */
 
-  BitTuple *pred_bitmasks;  /* Bitmask indicating the predecessors of a vertex */
-  BitTuple *succ_bitmasks;  /* Bitmask indicating the predecessors of a vertex */
+  /* Bitmasks indicating the predecessors and the successors of a
+     vertex. Each bitmask is made of `bitmask_words' words, and the
+     bitmasks of all vertices are stored one after the other. */
+  size_t   bitmask_words;
+  BitWord *pred_bitmasks;
+  BitWord *succ_bitmasks;
 
   size_t source_number;
   size_t sink_number;
@@ -63,6 +67,9 @@ typedef struct {
 
 } DAG;
 
+#define PRED_BITMASK(g,v) ((g)->pred_bitmasks + (v)*(g)->bitmask_words)
+#define SUCC_BITMASK(g,v) ((g)->succ_bitmasks + (v)*(g)->bitmask_words)
+
 /* Data structure management functions */
 extern Boolean isconsistent_DAG(const DAG *ptr);
 extern DAG*    copy_DAG(const DAG *src);
@@ -77,6 +84,10 @@ extern void fprint_dot_DAG(FILE *outfile,const DAG *p,
                             char**vertex_options);
 
 
+/* Generators of the automorphisms of the graph, as arrays of images
+   of the vertices stored one after the other (see dag.c) */
+extern Vertex* automorphisms_DAG(const DAG *p,size_t *number);
+
 /* Structure building functions */
 extern DAG* pyramid(int h);
 extern DAG* path(int n);
@@ -0,0 +1,589 @@
+/*
+   Description::
+
+   Parallel depth-first search for a pebbling within a bound.
+
+   The breadth-first search finds the shortest pebbling, but it keeps
+   every visited configuration and the whole frontier. Here each
+   thread explores the configurations depth-first from a stack of its
+   own, and an idle thread steals moves not explored yet from the
+   bottom of the stack of another one. The visited configurations
+   are remembered in a transposition table of fixed size, where a
+   configuration replaces the one which was in its slot: memory is
+   bounded, at the price of exploring again the configurations
+   forgotten.
+
+   This file is compiled once for each width of the configurations
+   (see bittuple.h), and dfs_pebbling_strategy chooses the build
+   according to the size of the graph.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "configuration.h"
+#include "hashtable.h"
+#include "dfs.h"
+
+
+/* Code */
+
+/* The transposition table is direct mapped: the slot of a
+   configuration is given by its hash, and a new configuration takes
+   the place of the old one. The slots are guarded by a fixed number
+   of locks, each one for a stripe of slots. */
+#define TABLE_MIN_ALLOCATION  (0x1UL << 10)
+#define TABLE_STRIPES         64
+
+typedef struct {
+  PebbleRecord record;
+  Boolean      occupied;
+} TableEntry;
+
+typedef struct {
+
+  TableEntry     *slots;
+  size_t          allocation;     /* A power of two */
+  pthread_mutex_t locks[TABLE_STRIPES];
+
+} TranspositionTable;
+
+
+/* The largest table which fits in `bytes' */
+static TranspositionTable *new_TranspositionTable(size_t bytes) {
+
+  TranspositionTable *T=(TranspositionTable*)malloc(sizeof(TranspositionTable));
+  assert(T);
+
+  T->allocation = TABLE_MIN_ALLOCATION;
+  while(2*T->allocation*sizeof(TableEntry) <= bytes) T->allocation <<= 1;
+
+  T->slots=(TableEntry*)calloc(T->allocation,sizeof(TableEntry));
+  if (T->slots==NULL) {
+    fprintf(stderr,
+            "Error in search procedure: unable to allocate "
+            "the transposition table (%lu bytes).",
+            (unsigned long)(T->allocation*sizeof(TableEntry)));
+    exit(EXIT_FAILURE);
+  }
+  for(int i=0;i<TABLE_STRIPES;i++) pthread_mutex_init(&T->locks[i],NULL);
+  return T;
+}
+
+static void dispose_TranspositionTable(TranspositionTable *T) {
+
+  assert(T);
+
+  for(int i=0;i<TABLE_STRIPES;i++) pthread_mutex_destroy(&T->locks[i]);
+  free(T->slots);
+  free(T);
+}
+
+/* The heuristics of next_PebbleConfiguration discard some moves
+   according to the last move and to the pebbles used so far, which
+   depend on the path to the configuration. They are sound for the
+   breadth-first search, but here a configuration may be visited
+   first from a path which discards the moves needed later. So the
+   configurations of this search look like the initial one (no
+   previous configuration) and have every pebble used, and all the
+   legal moves are explored. */
+static inline void forget_path(const DAG *g,PebbleConfiguration *c) {
+  c->previous_configuration = NO_RECORD;
+  c->used_pebbles = bt_prefix(g->size);
+}
+
+/* Whether the configuration is in the table. If it is not, then it
+   is stored, replacing the configuration in its slot. */
+static Boolean visit_TranspositionTable(TranspositionTable *T,
+                                        const PebbleConfiguration *c,size_t key) {
+
+  size_t i=key & (T->allocation-1);
+  pthread_mutex_t *lock=&T->locks[i % TABLE_STRIPES];
+  Boolean seen;
+
+  pthread_mutex_lock(lock);
+  seen = T->slots[i].occupied && matchDict(&T->slots[i].record,c);
+  if (!seen) {
+    pack_PebbleConfiguration(&T->slots[i].record,c);
+    T->slots[i].occupied = TRUE;
+  }
+  pthread_mutex_unlock(lock);
+  return seen;
+}
+
+
+/* A configuration on the stack, with the moves not explored yet */
+typedef struct {
+  PebbleConfiguration conf;
+  size_t              key;      /* hashDict(&conf) */
+  BitTuple            moves;
+} DFSFrame;
+
+struct _DFSSearch;
+
+/* Each worker has a stack of configurations, each one reached by a
+   move from the previous one. The first configuration is reached
+   from the initial one by the moves in `prefix'.
+
+   The owner works at the top of the stack, the thieves take moves
+   from the bottom. Both hold the lock of the worker while they
+   change the stack.
+
+   The frames on the stack are also indexed by hash, so that a
+   configuration already on the stack is not pushed again: otherwise
+   the search might go around a cycle of configurations which the
+   transposition table has forgotten. */
+typedef struct {
+
+  struct _DFSSearch *s;
+  unsigned int id;
+  pthread_mutex_t lock;
+
+  DFSFrame *stack;
+  size_t    top;                  /* Number of frames */
+  size_t    allocation;
+
+  size_t   *index;                /* Frame number plus one, or zero */
+  size_t    index_allocation;     /* A power of two */
+
+  Vertex      *prefix;
+  size_t       prefix_length;
+  size_t       prefix_allocation;
+  unsigned int prefix_cost;       /* Largest number of pebbles before
+                                     the first frame */
+
+  pthread_t thread;
+
+} DFSWorker;
+
+typedef struct _DFSSearch {
+
+  DAG     *g;
+  Boolean  persistent_pebbling;
+  unsigned int upper_bound;
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+
+  TranspositionTable *T;
+
+  DFSWorker   *workers;
+  unsigned int threads;
+  int          idle;              /* Workers with an empty stack */
+  int          found;             /* Set when a pebbling is found */
+
+  /* Moves to the final configuration, guarded by the lock */
+  pthread_mutex_t     lock;
+  Vertex             *witness;
+  size_t              witness_length;
+  size_t              witness_allocation;
+  unsigned int        witness_cost;
+  PebbleConfiguration final;
+
+} DFSSearch;
+
+
+/* Append a move to an array of moves */
+static inline void append_move(Vertex **moves,size_t *length,size_t *allocation,Vertex v) {
+
+  if (*length==*allocation) {
+    *allocation = 2*(*allocation) + 64;
+    *moves=(Vertex*)realloc(*moves,(*allocation)*sizeof(Vertex));
+    assert(*moves);
+  }
+  (*moves)[(*length)++]=v;
+}
+
+/* The moves from the initial configuration to frame `n' of the
+   stack of `w', and the largest number of pebbles used by them
+   (the configuration at frame `n' excluded). */
+static void path_DFSWorker(const DFSWorker *w,size_t n,
+                           Vertex **moves,size_t *length,size_t *allocation,
+                           unsigned int *cost) {
+
+  assert(n < w->top);
+
+  *length = 0;
+  *cost   = w->prefix_cost;
+  for(size_t i=0;i<w->prefix_length;i++) append_move(moves,length,allocation,w->prefix[i]);
+  for(size_t i=0;i<n;i++) {
+    append_move(moves,length,allocation,w->stack[i+1].conf.last_changed_vertex);
+    *cost = MAX(*cost,w->stack[i].conf.pebbles);
+  }
+}
+
+
+static inline size_t home_DFSWorker(const DFSWorker *w,size_t entry) {
+  return w->stack[entry-1].key & (w->index_allocation-1);
+}
+
+static Boolean onstack_DFSWorker(const DFSWorker *w,const PebbleConfiguration *c,size_t key) {
+
+  const size_t mask = w->index_allocation-1;
+  const DFSFrame *f;
+
+  for(size_t i=key & mask; w->index[i]!=0; i=(i+1) & mask) {
+    f=&w->stack[w->index[i]-1];
+    if (f->key==key && match_configurationsDict(&f->conf,c)) return TRUE;
+  }
+  return FALSE;
+}
+
+static void index_DFSWorker(DFSWorker *w,size_t n) {
+
+  const size_t mask = w->index_allocation-1;
+  size_t i;
+
+  for(i=w->stack[n].key & mask; w->index[i]!=0; i=(i+1) & mask);
+  w->index[i]=n+1;
+}
+
+/* Removal from a linear probing table: the following elements are
+   moved back, unless their home slot is after the hole. */
+static void unindex_DFSWorker(DFSWorker *w,size_t n) {
+
+  const size_t mask = w->index_allocation-1;
+  size_t i,j,k;
+
+  for(i=w->stack[n].key & mask; w->index[i]!=n+1; i=(i+1) & mask);
+
+  for(j=(i+1) & mask; w->index[j]!=0; j=(j+1) & mask) {
+    k=home_DFSWorker(w,w->index[j]);
+    if ((i<=j) ? (k<=i || k>j) : (k<=i && k>j)) {
+      w->index[i]=w->index[j];
+      i=j;
+    }
+  }
+  w->index[i]=0;
+}
+
+/* Push a configuration on the stack of its worker, which must hold
+   the lock. */
+static void push_DFSWorker(DFSWorker *w,const PebbleConfiguration *c,size_t key,BitTuple moves) {
+
+  if (w->top==w->allocation) {
+    w->allocation *= 2;
+    w->stack=(DFSFrame*)realloc(w->stack,w->allocation*sizeof(DFSFrame));
+    assert(w->stack);
+  }
+
+  /* The index is kept at most half full */
+  if (2*(w->top+1) > w->index_allocation) {
+    w->index_allocation *= 2;
+    free(w->index);
+    w->index=(size_t*)calloc(w->index_allocation,sizeof(size_t));
+    assert(w->index);
+    for(size_t n=0;n<w->top;n++) index_DFSWorker(w,n);
+  }
+
+  w->stack[w->top].conf  = *c;
+  w->stack[w->top].key   = key;
+  w->stack[w->top].moves = moves;
+  index_DFSWorker(w,w->top);
+  w->top++;
+}
+
+
+/* The configuration `c' reached from the top of the stack of `w' is
+   final. The first worker which gets here writes the witness. */
+static void found_DFSWorker(DFSWorker *w,const PebbleConfiguration *c) {
+
+  DFSSearch *s=w->s;
+
+  pthread_mutex_lock(&s->lock);
+  if (!s->found) {
+    path_DFSWorker(w,w->top-1,&s->witness,&s->witness_length,&s->witness_allocation,&s->witness_cost);
+    append_move(&s->witness,&s->witness_length,&s->witness_allocation,c->last_changed_vertex);
+    s->witness_cost = MAX(s->witness_cost,w->stack[w->top-1].conf.pebbles);
+    s->witness_cost = MAX(s->witness_cost,c->pebbles);
+    s->final = *c;
+    ATOMIC_STORE(&s->found,TRUE);
+  }
+  pthread_mutex_unlock(&s->lock);
+}
+
+
+/* Take some moves from the bottom of the stack of another worker.
+   The moves of the lowest frame which has some are split
+   alternately between the thief and the victim.
+
+   @return TRUE if some moves have been stolen */
+static Boolean steal_DFSWorker(DFSWorker *w) {
+
+  DFSSearch *s=w->s;
+  DFSWorker *victim;
+  DFSFrame   frame;
+  Boolean    mine;
+  Vertex     v;
+
+  assert(w->top==0);
+
+  for(unsigned int t=1;t<s->threads;t++) {
+
+    victim=&s->workers[(w->id+t) % s->threads];
+    pthread_mutex_lock(&victim->lock);
+
+    for(size_t n=0;n<victim->top;n++) {
+
+      DFSFrame *f=&victim->stack[n];
+      if (bt_iszero(f->moves)) continue;
+
+      frame = *f;
+      frame.moves = bt_zero();
+      mine = TRUE;
+      for(BitTuple m=f->moves; !bt_iszero(m); bt_reset(&m,v)) {
+        v=bt_lowest(m);
+        if (mine) {
+          bt_set(&frame.moves,v);
+          bt_reset(&f->moves,v);
+        }
+        mine = !mine;
+      }
+
+      /* The thief starts from the same configuration. Nobody reads
+         its prefix while its stack is empty. */
+      path_DFSWorker(victim,n,&w->prefix,&w->prefix_length,&w->prefix_allocation,&w->prefix_cost);
+      ATOMIC_FETCH_ADD(&s->idle,-1);
+      pthread_mutex_unlock(&victim->lock);
+
+      pthread_mutex_lock(&w->lock);
+      push_DFSWorker(w,&frame.conf,frame.key,frame.moves);
+      pthread_mutex_unlock(&w->lock);
+      return TRUE;
+    }
+    pthread_mutex_unlock(&victim->lock);
+  }
+  return FALSE;
+}
+
+
+static void *run_DFSWorker(void *arg) {
+
+  DFSWorker *w=(DFSWorker*)arg;
+  DFSSearch *s=w->s;
+  const DAG *g=s->g;
+
+  PebbleConfiguration next;
+  DFSFrame *f;
+  Boolean   idle=(w->top==0);
+  size_t    key;
+  Vertex    v;
+
+  while(!ATOMIC_LOAD(&s->found)) {
+
+    /* Out of work: the search ends when all workers are */
+    if (w->top==0) {
+      if (!idle) {
+        ATOMIC_FETCH_ADD(&s->idle,1);
+        idle=TRUE;
+      }
+      if (ATOMIC_LOAD(&s->idle)==(int)s->threads) break;
+      if (steal_DFSWorker(w)) idle=FALSE;
+      else sched_yield();
+      continue;
+    }
+
+    /* Next move from the configuration at the top. Only the owner
+       reallocates the stack, so the frame stays in place. */
+    pthread_mutex_lock(&w->lock);
+    f=&w->stack[w->top-1];
+    if (bt_iszero(f->moves)) {
+      unindex_DFSWorker(w,w->top-1);
+      w->top--;
+      pthread_mutex_unlock(&w->lock);
+      continue;
+    }
+    v=bt_lowest(f->moves);
+    bt_reset(&f->moves,v);
+    pthread_mutex_unlock(&w->lock);
+
+    if (!next_PebbleConfiguration(v,g,&f->conf,s->upper_bound,&next))
+      continue; /* Step corresponding to vertex v is invalid/useless */
+    next.last_changed_vertex = v;
+    forget_path(g,&next);
+
+    if (s->isfinal(g,&next)) {
+      found_DFSWorker(w,&next);
+      break;
+    }
+
+    key=hashDict(&next);
+    if (onstack_DFSWorker(w,&next,key)) continue;
+    if (visit_TranspositionTable(s->T,&next,key)) continue;
+
+    pthread_mutex_lock(&w->lock);
+    push_DFSWorker(w,&next,key,legalmoves(g,&next,s->upper_bound));
+    pthread_mutex_unlock(&w->lock);
+  }
+  return NULL;
+}
+
+
+/* The pebbling given by the witness, completed as in the
+   finalization of the breadth-first search (see bfs.c). */
+static Pebbling *solution_DFSSearch(const DFSSearch *s) {
+
+  const DAG    *g=s->g;
+  const Vertex *moves=s->witness;
+  size_t        n=s->witness_length;
+  size_t        clean=0;
+  size_t        i=0;
+  Pebbling     *solution;
+
+  if (!s->found) return NULL;
+
+#if !REVERSIBLE_PEBBLING
+  clean = bt_popcount(s->final.black_pebbled);
+#endif
+
+  if (s->persistent_pebbling) {
+
+    /* The pebbling is reversed, and the black pebbles left become
+       white placements at the beginning. */
+    solution = new_Pebbling(n+clean);
+    solution->length = n+clean;
+    for(Vertex v=0;v<g->size && clean>0;v++) {
+      if (bt_get(s->final.black_pebbled,v)) solution->steps[i++]=v;
+    }
+    for(size_t j=n;j>0;j--) solution->steps[i++]=moves[j-1];
+
+  } else {
+
+#if REVERSIBLE_PEBBLING
+    /* The pebbling is repeated backward */
+    solution = new_Pebbling(2*n);
+    solution->length = 2*n;
+    for(size_t j=0;j<n;j++) {
+      solution->steps[j]       = moves[j];
+      solution->steps[2*n-1-j] = moves[j];
+    }
+#else
+    /* The black pebbles left are removed */
+    solution = new_Pebbling(n+clean);
+    solution->length = n+clean;
+    for(size_t j=0;j<n;j++) solution->steps[j]=moves[j];
+    i=n+clean;
+    for(Vertex v=0;v<g->size;v++) {
+      if (bt_get(s->final.black_pebbled,v)) solution->steps[--i]=v;
+    }
+#endif
+  }
+
+  solution->cost = (int)s->witness_cost;
+  return solution;
+}
+
+
+/**
+   Look for a pebbling with at most `upper_bound' pebbles, by a
+   depth-first search run by `threads' threads.
+
+   The pebbling found is not necessarily the shortest one, nor one of
+   minimum cost. The transposition table takes at most `table_bytes'
+   bytes, and the rest of the memory used only depends on the depth
+   of the search.
+
+   @param DAG the graph to pebble (with few vertices and a single
+   sink).
+
+   @param persistent_pebbling whether the pebbling must leave a black
+   pebble on the sink (see bfs_pebbling_strategy).
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(dfs_pebbling_strategy)(DAG *g,
+                                              unsigned int upper_bound,
+                                              Boolean persistent_pebbling,
+                                              unsigned int threads,
+                                              size_t table_bytes) {
+
+  assert(threads>0);
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = 0;
+#endif
+
+  DFSSearch s;
+  PebbleConfiguration initial;
+  size_t key;
+
+  s.g = g;
+  s.persistent_pebbling = persistent_pebbling;
+  s.upper_bound = upper_bound;
+  s.isfinal = persistent_pebbling ? isfinal_persistent : isfinal_visiting;
+  s.T = new_TranspositionTable(table_bytes);
+  s.threads = threads;
+  s.idle    = (int)threads-1;
+  s.found   = FALSE;
+  pthread_mutex_init(&s.lock,NULL);
+  s.witness = NULL;
+  s.witness_length = 0;
+  s.witness_allocation = 0;
+  s.witness_cost = 0;
+
+  s.workers=(DFSWorker*)malloc(threads*sizeof(DFSWorker));
+  assert(s.workers);
+  for(unsigned int t=0;t<threads;t++) {
+    DFSWorker *w=&s.workers[t];
+    w->s  = &s;
+    w->id = t;
+    pthread_mutex_init(&w->lock,NULL);
+    w->top = 0;
+    w->allocation = 64;
+    w->stack=(DFSFrame*)malloc(w->allocation*sizeof(DFSFrame));
+    w->index_allocation = 128;
+    w->index=(size_t*)calloc(w->index_allocation,sizeof(size_t));
+    assert(w->stack && w->index);
+    w->prefix = NULL;
+    w->prefix_length = 0;
+    w->prefix_allocation = 0;
+    w->prefix_cost = 0;
+  }
+
+  /* The first worker starts from the initial configuration */
+  init_PebbleConfiguration(g,&initial);
+#if BLACK_WHITE_PEBBLING || REVERSIBLE_PEBBLING
+  if (persistent_pebbling) {  init_persistent_pebbling(g,&initial); }
+#endif
+  forget_path(g,&initial);
+  key=hashDict(&initial);
+  visit_TranspositionTable(s.T,&initial,key);
+  push_DFSWorker(&s.workers[0],&initial,key,legalmoves(g,&initial,upper_bound));
+
+  for(unsigned int t=1;t<threads;t++) {
+    if (pthread_create(&s.workers[t].thread,NULL,run_DFSWorker,&s.workers[t])!=0) {
+      fprintf(stderr,"Error in search procedure: unable to start a thread.");
+      exit(EXIT_FAILURE);
+    }
+  }
+  run_DFSWorker(&s.workers[0]);
+  for(unsigned int t=1;t<threads;t++) pthread_join(s.workers[t].thread,NULL);
+
+  Pebbling *solution=solution_DFSSearch(&s);
+
+  for(unsigned int t=0;t<threads;t++) {
+    pthread_mutex_destroy(&s.workers[t].lock);
+    free(s.workers[t].stack);
+    free(s.workers[t].index);
+    free(s.workers[t].prefix);
+  }
+  free(s.workers);
+  free(s.witness);
+  pthread_mutex_destroy(&s.lock);
+  dispose_TranspositionTable(s.T);
+
+  return solution;
+}
@@ -0,0 +1,47 @@
+/*
+   Description::
+
+   Depth-first search for a pebbling within a bound, which does not
+   keep all the visited configurations: it answers whether a
+   pebbling exists in bounded memory, without looking for the
+   shortest one.
+
+*/
+
+
+/* Preamble */
+#ifndef  DFS_H
+#define  DFS_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+/* Size of the transposition table when not given (in megabytes) */
+#define DFS_DEFAULT_TABLE_MB 64
+
+/* Chooses the build of the search for the size of the graph */
+extern Pebbling* dfs_pebbling_strategy(DAG *digraph,
+                                       unsigned int upper_bound,
+                                       Boolean persistent_pebbling,
+                                       unsigned int threads,
+                                       size_t table_bytes);
+
+/* Builds of the search for configurations of 16, 32, 64 and
+   64*WIDE_WORDS vertices (see bittuple.h). */
+#define DFS_DECLARE_WIDTH(suffix)                                       \
+  extern Pebbling* dfs_pebbling_strategy_##suffix(DAG *digraph,         \
+                                                  unsigned int upper_bound, \
+                                                  Boolean persistent_pebbling, \
+                                                  unsigned int threads, \
+                                                  size_t table_bytes);
+
+DFS_DECLARE_WIDTH(w16)
+DFS_DECLARE_WIDTH(w32)
+DFS_DECLARE_WIDTH(w64)
+DFS_DECLARE_WIDTH(wide)
+
+#endif /* DFS_H */
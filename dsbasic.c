@@ -6,7 +6,8 @@
 
    Description::
 
-   Basic implementation of simple data structures as queue, lists, deque.
+   Basic implementation of simple data structures as queue, lists, deque,
+   arena.
 
 
 */
@@ -517,3 +518,167 @@ void *getDL(DLinkedList *l) {
   return l->cursor->data;
 }
 
+
+
+/********************************************************************************
+                     QUEUE
+ ********************************************************************************/
+
+/* This function check if the queue is well formed: the chunks are
+   properly linked and the number of elements in them is the length
+   of the queue. */
+Boolean isconsistentQ(Queue *q) {
+
+  assert(q);
+
+  if (q->elemsize==0 || q->chunk_capacity==0) return FALSE;
+
+  /* Empty list of chunks */
+  if (q->head==NULL || q->tail==NULL) {
+    return (q->head==NULL && q->tail==NULL && q->length==0);
+  }
+
+  if (q->tail->next!=NULL) return FALSE;
+  if (q->head_pos > q->chunk_capacity || q->tail_pos > q->chunk_capacity) return FALSE;
+
+  /* Count the elements chunk by chunk */
+  size_t counter = 0;
+  struct QueueChunk *c=q->head;
+  while(c!=q->tail) {
+    counter += q->chunk_capacity;
+    c=c->next;
+    if (c==NULL) return FALSE; /* tail is not in the list */
+  }
+  counter += q->tail_pos;
+
+  return (counter - q->head_pos == q->length);
+}
+
+
+Queue *newQ(size_t elemsize) {
+
+  assert(elemsize>0);
+
+  Queue *q=(Queue*)malloc(sizeof(Queue));
+  assert(q);
+
+  q->elemsize = elemsize;
+  q->chunk_capacity = (QUEUE_CHUNK_BYTES - sizeof(struct QueueChunk)) / elemsize;
+  if (q->chunk_capacity==0) q->chunk_capacity=1;
+
+  q->head = q->tail = q->spare = NULL;
+  q->head_pos = q->tail_pos = 0;
+  q->length = 0;
+
+  assert(isconsistentQ(q));
+  return q;
+}
+
+
+void disposeQ(Queue *q) {
+  struct QueueChunk *c,*n;
+
+  assert(q);
+  c=q->head;
+  while(c) { n=c->next; free(c); c=n; }
+  if (q->spare) free(q->spare);
+  free(q);
+}
+
+
+/* Add a fresh chunk at the end of the queue. The spare chunk is used
+   if there is one. */
+void extendQ(Queue *q) {
+
+  assert(q);
+
+  struct QueueChunk *c;
+  if (q->spare) {
+    c=q->spare;
+    q->spare=NULL;
+  } else {
+    c=(struct QueueChunk*)malloc(sizeof(struct QueueChunk) + q->chunk_capacity*q->elemsize);
+    assert(c);
+  }
+  c->next=NULL;
+
+  if (q->tail) {
+    q->tail->next=c;
+  } else {
+    q->head=c;
+    q->head_pos=0;
+  }
+  q->tail=c;
+  q->tail_pos=0;
+}
+
+
+/* Remove the head chunk, which has been consumed. It is kept as the
+   spare chunk. */
+void shrinkQ(Queue *q) {
+
+  assert(q);
+  assert(q->head);
+  assert(q->head_pos==q->chunk_capacity);
+
+  struct QueueChunk *c=q->head;
+
+  q->head=c->next;
+  q->head_pos=0;
+  if (q->head==NULL) q->tail=NULL;
+
+  if (q->spare) free(q->spare);
+  q->spare=c;
+}
+
+
+
+/********************************************************************************
+                     ARENA
+ ********************************************************************************/
+
+Arena *newAR(size_t elemsize) {
+
+  assert(elemsize>0);
+
+  Arena *a=(Arena*)malloc(sizeof(Arena));
+  assert(a);
+
+  a->elemsize = elemsize;
+  a->slab_allocation = 16;
+  a->slab_number = 0;
+  a->size = 0;
+
+  a->slabs = (unsigned char**)malloc(a->slab_allocation*sizeof(unsigned char*));
+  assert(a->slabs);
+
+  return a;
+}
+
+
+/* All elements are freed at once. */
+void disposeAR(Arena *a) {
+
+  assert(a);
+  for(size_t i=0;i<a->slab_number;i++) free(a->slabs[i]);
+  free(a->slabs);
+  free(a);
+}
+
+
+/* Add a new slab to the arena. */
+void extendAR(Arena *a) {
+
+  assert(a);
+  assert(a->slab_number <= a->slab_allocation);
+
+  if (a->slab_number == a->slab_allocation) {
+    a->slab_allocation *= 2;
+    a->slabs = (unsigned char**)realloc(a->slabs,a->slab_allocation*sizeof(unsigned char*));
+    assert(a->slabs);
+  }
+
+  a->slabs[a->slab_number] = (unsigned char*)malloc(ARENA_SLAB_SIZE*a->elemsize);
+  assert(a->slabs[a->slab_number]);
+  a->slab_number++;
+}
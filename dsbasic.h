@@ -6,7 +6,8 @@
 
    Description::
 
-   Basic Data Structure Implementation: list, queue, deque, stack.
+   Basic Data Structure Implementation: list, queue, deque, stack,
+   arena.
 
 
 */
@@ -130,19 +131,145 @@ void nextDL(DLinkedList *l);
 void *getDL(DLinkedList *l);
 
 
+/********************************************************************************
+                     QUEUE
+ ********************************************************************************/
+
+/* The queue is a sequence of fixed size chunks of memory, each
+   containing many elements which are stored by value. Elements are
+   added at the tail chunk and removed from the head one, so that no
+   allocation is done for the single element. A consumed chunk is
+   kept aside to be reused as the next tail chunk. */
+#define QUEUE_CHUNK_BYTES  (0x1UL << 16)
+
+struct QueueChunk {
+  struct QueueChunk *next;
+  unsigned char data[];
+};
+
+typedef struct {
+  size_t elemsize;          /* Size of an element in bytes */
+  size_t chunk_capacity;    /* Number of elements in a chunk */
+
+  struct QueueChunk *head;
+  struct QueueChunk *tail;
+  struct QueueChunk *spare; /* Empty chunk for later use, or NULL */
+
+  size_t head_pos;          /* Position of the first element in head */
+  size_t tail_pos;          /* First free position in tail */
+
+  size_t length;
+} Queue;
+
+
+Boolean isconsistentQ(Queue *q);
+
+Queue *newQ(size_t elemsize);
+void disposeQ(Queue *q);
+
+void extendQ(Queue *q);
+void shrinkQ(Queue *q);
+
+/* Boolean isemptyQ(Queue *q); */
+static inline Boolean isemptyQ(Queue *q) {
+  assert(q);
+  return (q->length==0);
+}
+
+/* size_t lengthQ(Queue *q); */
+static inline size_t lengthQ(Queue *q) {
+  assert(q);
+  return q->length;
+}
+
+/* Reserve space for a new element at the end of the queue and
+   return a pointer to it. The caller must fill it. */
+static inline void *enqueueQ(Queue *q) {
+  assert(q);
+  if (q->tail==NULL || q->tail_pos==q->chunk_capacity) extendQ(q);
+  q->length++;
+  return q->tail->data + (q->tail_pos++)*q->elemsize;
+}
+
+/* Pointer to the first element of the queue. It is valid until the
+   element is removed. */
+static inline void *frontQ(Queue *q) {
+  assert(q);
+  assert(!isemptyQ(q));
+  return q->head->data + q->head_pos*q->elemsize;
+}
+
+/* Remove the first element of the queue. */
+static inline void popQ(Queue *q) {
+  assert(q);
+  assert(!isemptyQ(q));
+  q->length--;
+  q->head_pos++;
+  if (q->head_pos==q->chunk_capacity) shrinkQ(q);
+}
+
+
+
+/********************************************************************************
+                     ARENA
+ ********************************************************************************/
+
+/* An arena is a growing array of elements of the same size, which
+   are allocated one at a time and freed all together. The elements
+   are kept in slabs of ARENA_SLAB_SIZE elements which never move, so
+   pointers to them are stable. Elements can also be addressed by
+   their index in order of allocation. */
+#define ARENA_SLAB_SHIFT   12
+#define ARENA_SLAB_SIZE    (0x1UL << ARENA_SLAB_SHIFT)
+#define ARENA_SLAB_MASK    (ARENA_SLAB_SIZE - 1)
+
+typedef struct {
+  size_t elemsize;          /* Size of an element in bytes */
+
+  unsigned char **slabs;
+  size_t slab_number;       /* Slabs in use */
+  size_t slab_allocation;   /* Room in the array of slabs */
+
+  size_t size;              /* Elements allocated so far */
+} Arena;
+
+
+Arena *newAR(size_t elemsize);
+void disposeAR(Arena *a);
+
+void extendAR(Arena *a);
+
+/* size_t sizeAR(Arena *a); */
+static inline size_t sizeAR(Arena *a) {
+  assert(a);
+  return a->size;
+}
+
+/* Pointer to the i-th allocated element */
+static inline void *atAR(Arena *a,size_t i) {
+  assert(a);
+  assert(i < a->size);
+  return a->slabs[i >> ARENA_SLAB_SHIFT] + (i & ARENA_SLAB_MASK)*a->elemsize;
+}
+
+/* Allocate a new element at the end of the arena. Its content is
+   undefined. */
+static inline void *allocAR(Arena *a) {
+  assert(a);
+  if ((a->size >> ARENA_SLAB_SHIFT) == a->slab_number) extendAR(a);
+  a->size++;
+  return atAR(a,a->size-1);
+}
+
+
+
 /********************************************************************************
                      OTHER BASIC DATA STRUCTURES
  ********************************************************************************/
 
-typedef LinkedList  Queue;
 typedef DLinkedList Deque;
 typedef LinkedList  Stack;
 
-/* Queue is realized with LinkedList in which the cursos always stays
-   at the beginning. */
-#define enqueue(q,d) (appendSL((q),(d)))
-#define pop(q)       (delete_and_nextSL(q))
-
 /* Deque is realized with Double LinkedList */
 #define  leftenqueue(dq,d) (extendDL((dq),(d),0))
 #define rightenqueue(dq,d) (extendDL((dq),(d),1))
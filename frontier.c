@@ -0,0 +1,293 @@
+/*
+   Description::
+
+   Frontier search for a reversible pebbling within a bound.
+
+   In reversible pebbling each move can be undone, and each move
+   changes the number of pebbles by one. So the neighbors of a level
+   of the breadth-first search which are not new are in the previous
+   level, and only the previous, the current and the next levels are
+   kept: the memory used is proportional to the widest level, not to
+   all the configurations visited.
+
+   The pebbling is recovered by divide and conquer. A first search
+   finds the final configuration and its distance d from the initial
+   one. Then a search between two configurations at distance d keeps,
+   for each configuration beyond level d/2, its ancestor at level d/2
+   (the relay), and the relay of the target splits the problem in two
+   problems at distance d/2, which are solved in the same way.
+
+   The configurations are expanded from their records, so the
+   heuristics which depend on the pebbling which reached a
+   configuration are not used (see unpack_PebbleRecord): with them the
+   moves could not be undone.
+
+   This file is compiled once for each width of the configurations
+   (see bittuple.h), and frontier_pebbling_strategy chooses the build
+   according to the size of the graph.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "common.h"
+#include "dag.h"
+#include "dsbasic.h"
+#include "pebbling.h"
+#include "configuration.h"
+#include "hashtable.h"
+#include "frontier.h"
+
+
+/* Code */
+
+#if REVERSIBLE_PEBBLING
+
+#define NO_RELAY ((unsigned int)-1)
+
+/* A configuration of a level, with its ancestor in the relay level
+   (meaningful only beyond that level). The dictionary of the level
+   reads the record at the beginning of the entry. */
+typedef struct {
+  PebbleRecord record;
+  PebbleRecord relay;
+} FrontierEntry;
+
+typedef struct {
+  Arena *A;
+  Dict  *D;
+} Level;
+
+typedef struct {
+
+  DAG         *g;
+  unsigned int upper_bound;
+  Boolean      start_touched;   /* The sink is touched from the start */
+
+  Boolean (*isfinal)(const DAG *, const PebbleConfiguration *);
+
+  Vertex      *steps;           /* The moves found so far */
+
+} FrontierSearch;
+
+
+static void new_Level(Level *l) {
+  l->A = newAR(sizeof(FrontierEntry));
+  l->D = newDict(0,l->A);
+}
+
+static void dispose_Level(Level *l) {
+  disposeDict(l->D);
+  disposeAR(l->A);
+}
+
+static inline Boolean contains_Level(Level *l,const PebbleConfiguration *c) {
+  DictQueryResult res;
+  queryDict(l->D,&res,c);
+  return res.index!=NO_RECORD;
+}
+
+/* Add a configuration to the level, if it is not there yet. Without
+   a relay the configuration is its own relay. */
+static void add_Level(Level *l,const PebbleConfiguration *c,const PebbleRecord *relay) {
+
+  DictQueryResult res;
+  queryDict(l->D,&res,c);
+  if (res.index!=NO_RECORD) return;
+
+  if (sizeAR(l->A) >= NO_RECORD) {
+    fprintf(stderr,
+            "Error in search procedure: too many configurations "
+            "for the optimized data structures.");
+    exit(EXIT_FAILURE);
+  }
+  FrontierEntry *e=(FrontierEntry*)allocAR(l->A);
+  pack_PebbleConfiguration(&e->record,c);
+  e->relay = relay ? *relay : e->record;
+  unsafe_noquery_writeDict(l->D,&res,(RecordIndex)(sizeAR(l->A)-1));
+}
+
+
+/* Breadth-first search from `from' to `to', or to a final
+   configuration if `to' is NULL, keeping only three levels.
+
+   @param relay_level the level of the relays, or NO_RELAY
+   @param found the record of the configuration reached
+   @param relay the record of its relay
+
+   @return the distance of the configuration reached, or zero if
+   there is none */
+static unsigned int search_FrontierSearch(const FrontierSearch *s,
+                                          const PebbleRecord *from,const PebbleRecord *to,
+                                          unsigned int relay_level,
+                                          PebbleRecord *found,PebbleRecord *relay) {
+
+  DAG *g=s->g;
+  Level levels[3];
+  Level *previous=&levels[0],*current=&levels[1],*next=&levels[2],*t;
+  PebbleConfiguration conf,neighbor;
+  BitTuple moves;
+  Vertex   v;
+  unsigned int distance=0;
+
+  new_Level(previous);
+  new_Level(current);
+  unpack_PebbleRecord(g,&conf,from);
+  add_Level(current,&conf,NULL);
+
+  for(unsigned int level=0; sizeAR(current->A)>0 && distance==0; level++) {
+
+    new_Level(next);
+
+    for(size_t i=0; i<sizeAR(current->A) && distance==0; i++) {
+
+      const FrontierEntry *e=(const FrontierEntry*)atAR(current->A,i);
+      unpack_PebbleRecord(g,&conf,&e->record);
+
+      for(moves=legalmoves(g,&conf,s->upper_bound); !bt_iszero(moves); bt_reset(&moves,v)) {
+
+        v=bt_lowest(moves);
+        if (!next_PebbleConfiguration(v,g,&conf,s->upper_bound,&neighbor)) continue;
+
+        /* Any index but NO_RECORD marks the configuration as not
+           initial. */
+        neighbor.previous_configuration = 0;
+        neighbor.last_changed_vertex = v;
+
+        if (to ? matchDict(to,&neighbor) : s->isfinal(g,&neighbor)) {
+          pack_PebbleConfiguration(found,&neighbor);
+          *relay = (level+1==relay_level) ? *found : e->relay;
+          distance = level+1;
+          break;
+        }
+
+        /* The first configuration which touches the sink is final, and
+           the others are not on a shortest path. */
+        if (neighbor.sink_touched && !s->start_touched) continue;
+
+        assert(!contains_Level(current,&neighbor));
+        if (contains_Level(previous,&neighbor)) continue;
+        add_Level(next,&neighbor,(level+1==relay_level) ? NULL : &e->relay);
+      }
+    }
+
+    dispose_Level(previous);
+    t=previous; previous=current; current=next; next=t;
+  }
+
+  dispose_Level(previous);
+  dispose_Level(current);
+  return distance;
+}
+
+
+/* Find the moves from `a' to `b', which are at distance `d', and
+   write them in the steps of the search from `offset' on. */
+static void solve_FrontierSearch(FrontierSearch *s,
+                                 const PebbleRecord *a,const PebbleRecord *b,
+                                 unsigned int d,size_t offset) {
+
+  assert(d>0);
+
+  if (d==1) {
+    BitTuple changed=bt_or(bt_andnot(a->black_pebbled,b->black_pebbled),
+                           bt_andnot(b->black_pebbled,a->black_pebbled));
+    assert(bt_popcount(changed)==1);
+    s->steps[offset]=(Vertex)bt_lowest(changed);
+    return;
+  }
+
+  PebbleRecord found,relay;
+  unsigned int half=d/2;
+  unsigned int distance=search_FrontierSearch(s,a,b,half,&found,&relay);
+  assert(distance==d);
+  (void)distance;
+
+  solve_FrontierSearch(s,a,&relay,half,offset);
+  solve_FrontierSearch(s,&relay,b,d-half,offset+half);
+}
+
+#endif /* REVERSIBLE_PEBBLING */
+
+
+/**
+   Same as bfs_pebbling_strategy for reversible pebbling, with a
+   frontier search. The pebbling found is a shortest one within the
+   bound, and it may differ from the one of bfs_pebbling_strategy.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *WIDTH_SYMBOL(frontier_pebbling_strategy)(DAG *g,
+                                                   unsigned int upper_bound,
+                                                   Boolean persistent_pebbling) {
+
+#if !REVERSIBLE_PEBBLING
+  (void)g;
+  (void)upper_bound;
+  (void)persistent_pebbling;
+  fprintf(stderr,
+          "Error in search procedure: the frontier search is only "
+          "available for reversible pebbling.");
+  exit(EXIT_FAILURE);
+#else
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  /* The graph is checked by the procedures of search.c */
+  assert(g->size <= BITTUPLE_SIZE);
+  assert(g->sink_number==1);
+
+  FrontierSearch s;
+  PebbleConfiguration init;
+  PebbleRecord start,final,relay;
+
+  init_PebbleConfiguration(g,&init);
+  if (persistent_pebbling) {  init_persistent_pebbling(g, &init); }
+  pack_PebbleConfiguration(&start,&init);
+
+  s.g = g;
+  s.upper_bound = upper_bound;
+  s.start_touched = init.sink_touched;
+  s.isfinal = persistent_pebbling ? isfinal_persistent : isfinal_visiting;
+
+  unsigned int d=search_FrontierSearch(&s,&start,NULL,NO_RELAY,&final,&relay);
+  if (d==0) return NULL;
+
+  s.steps=(Vertex*)malloc(d*sizeof(Vertex));
+  assert(s.steps);
+  solve_FrontierSearch(&s,&start,&final,d,0);
+
+  /* A persistent pebbling is found backward (see
+     finalize_persistent_pebbling), otherwise the moves are repeated
+     backward to remove the pebbles (see
+     finalize_reversible_pebbling). */
+  size_t length = persistent_pebbling ? d : 2*d;
+  Pebbling *solution=new_Pebbling(length);
+  solution->length = length;
+
+  for(size_t i=0;i<d;i++) {
+    if (persistent_pebbling) {
+      solution->steps[i] = s.steps[d-1-i];
+    } else {
+      solution->steps[i]          = s.steps[i];
+      solution->steps[length-1-i] = s.steps[i];
+    }
+  }
+  free(s.steps);
+
+  /* The cost is the largest number of pebbles along the way */
+  BitTuple pebbled=persistent_pebbling ? final.black_pebbled : start.black_pebbled;
+  int cost=(int)bt_popcount(pebbled);
+  for(size_t i=0;i<length;i++) {
+    Vertex w=solution->steps[i];
+    if (bt_get(pebbled,w)) bt_reset(&pebbled,w); else bt_set(&pebbled,w);
+    cost=MAX(cost,(int)bt_popcount(pebbled));
+  }
+  solution->cost = cost;
+
+  return solution;
+#endif
+}
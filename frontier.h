@@ -0,0 +1,39 @@
+/*
+   Description::
+
+   Frontier search for a reversible pebbling within a bound: the
+   breadth-first search keeps only the last levels, and the pebbling
+   is recovered by divide and conquer.
+
+*/
+
+
+/* Preamble */
+#ifndef  FRONTIER_H
+#define  FRONTIER_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+/* Chooses the build of the search for the size of the graph */
+extern Pebbling* frontier_pebbling_strategy(DAG *digraph,
+                                            unsigned int upper_bound,
+                                            Boolean persistent_pebbling);
+
+/* Builds of the search for configurations of 16, 32, 64 and
+   64*WIDE_WORDS vertices (see bittuple.h). */
+#define FRONTIER_DECLARE_WIDTH(suffix)                                  \
+  extern Pebbling* frontier_pebbling_strategy_##suffix(DAG *digraph,    \
+                                                       unsigned int upper_bound, \
+                                                       Boolean persistent_pebbling);
+
+FRONTIER_DECLARE_WIDTH(w16)
+FRONTIER_DECLARE_WIDTH(w32)
+FRONTIER_DECLARE_WIDTH(w64)
+FRONTIER_DECLARE_WIDTH(wide)
+
+#endif /* FRONTIER_H */
@@ -6,7 +6,7 @@
 
    Description::
 
-   An very rought implementation of hash table.
+   An open addressing hash table for pebble configurations.
 
 
 */
@@ -17,154 +17,186 @@
 
 #include "common.h"
 #include "dsbasic.h"
+#include "configuration.h"
 #include "hashtable.h"
 
-extern long int random(void);
 
-Boolean isconsistentDict(Dict *d) {
-  assert(d);
-  assert(d->size <= d->allocation);
-  assert(d->buckets);
-
-  assert(d->key_function);
-  assert(d->eq_function);
-
-#if defined(HASHTABLE_DEBUG)
-  LinkedList *l;
+/* Empty slots are marked by NO_RECORD, so a new array of slots must
+   be filled accordingly. */
+static DictEntry *new_slotsDict(size_t n) {
 
-  for(size_t i=0;i<d->size;i++) {
+  DictEntry *slots=(DictEntry*)malloc(n*sizeof(DictEntry));
+  assert(slots);
+  for(size_t i=0;i<n;i++) {
+    slots[i].hash  = 0;
+    slots[i].index = NO_RECORD;
+  }
+  return slots;
+}
 
-    l=d->buckets[i];
 
-    assert(isconsistentSL(l));
+Boolean isconsistentDict(Dict *d) {
+  assert(d);
+  assert(d->slots);
+  assert(d->records);
+  assert(d->allocation > 0);
+  assert((d->allocation & (d->allocation-1))==0);
+  assert(d->old_slots==NULL || d->migrated < d->old_allocation);
 
-    /* Chech if all elements have the same hash and if they are in the
-       appropriate bucket. It uses linked list internals. */
-    for(resetSL(l);iscursorvalidSL(l);nextSL(l)) {
-      if ((d->key_function(getSL(l)) % d->size)!=i) {
-        return FALSE;
-      }
+#if defined(HASHTABLE_DEBUG)
+  size_t counter=0;
+
+  /* Check that every element is reachable by probing from its home
+     slot, and that the stored hash is the one of the record. */
+  for(size_t i=0;i<d->allocation;i++) {
+    if (d->slots[i].index==NO_RECORD) continue;
+    counter++;
+    if (d->slots[i].index >= sizeAR(d->records)) return FALSE;
+    if (d->slots[i].hash != (uint32_t)hashRecord(atAR(d->records,d->slots[i].index))) return FALSE;
+    for(size_t j=d->slots[i].hash & (d->allocation-1); j!=i; j=(j+1) & (d->allocation-1)) {
+      if (d->slots[j].index==NO_RECORD) return FALSE;
     }
   }
+  /* Elements of the old array which have not been moved yet */
+  for(size_t i=d->migrated;d->old_slots && i<d->old_allocation;i++) {
+    if (d->old_slots[i].index==NO_RECORD) continue;
+    counter++;
+    if (d->old_slots[i].index >= sizeAR(d->records)) return FALSE;
+    if (d->old_slots[i].hash != (uint32_t)hashRecord(atAR(d->records,d->old_slots[i].index))) return FALSE;
+  }
+  if (counter!=d->size) return FALSE;
 #endif
   return TRUE;
 }
 
 
+/* The records are not owned by the dictionary. */
 void disposeDict(Dict *d) {
 
-  LinkedList *ll;
-  void       *ptr;
-
   assert(d);
 
-  /* Remove from memory all objects in the dictionary */
-  if (d->dispose_function!=NULL) {
-    for(size_t i=0;i<d->size;i++) {
-      ll=d->buckets[i];
-      resetSL(ll);
-      while(iscursorvalidSL(ll)) {
-        ptr=getSL(ll);
-        d->dispose_function(ptr);
-        nextSL(ll);
-      }
-    }
-  }
-
-  /* Remove data structure from memory */
-  for(size_t i=0;i<d->size;i++) disposeSL(d->buckets[i]);
-  free(d->buckets);
+  if (d->old_slots) free(d->old_slots);
+  free(d->slots);
   free(d);
 }
 
 
-Dict *newDict(size_t allocation) {
+/*
+   The allocation is the smallest power of two which keeps the
+   dictionary at most 3/4 full when `expected_size' elements are
+   stored, within the allowed limits.
+ */
+Dict *newDict(size_t expected_size,Arena *records) {
+
+  assert(records);
 
   Dict *d=(Dict *)malloc(sizeof(Dict));
   assert(d);
 
-  size_t r=random() % (allocation >> 4);
-  d->allocation = allocation;
-  d->size = allocation - (allocation >> 4) + r;
+  d->allocation = DICT_MIN_ALLOCATION;
+  while(d->allocation < DICT_MAX_ALLOCATION &&
+        3*(d->allocation/4) < expected_size) d->allocation <<= 1;
+  d->size = 0;
 
-  d->key_function = NULL;
-  d->eq_function  = NULL;
-  d->dispose_function = NULL;
+  d->old_slots = NULL;
+  d->old_allocation = 0;
+  d->migrated = 0;
 
-  d-> buckets = (LinkedList**)calloc(d->size,sizeof(LinkedList*));
-  for(size_t i=0;i<d->size;i++) {
-    d->buckets[i]=newSL();
-  }
-  assert(d->buckets);
+  d->records = records;
+
+  d->slots = new_slotsDict(d->allocation);
   return d;
 
 }
 
-/*
-   The query consist of a pointer to an object. The unique key of such
-   object is computed.  The corresponding bucket is explored, to find
-   out if the object exists there. A DictQueryResult object with value
-   field set to NULL means the object is not in the dictionary. The
-   cursor of the LinkedList which implements the bucket stays on the
-   found element.
- */
-void queryDict(Dict* d,DictQueryResult *const result,void *data) {
 
-  assert(d);
-  assert(result);
-  assert(d->eq_function);
-  LinkedList *ll=NULL;
+/* Moves the element in slot `i' of the old array to the new one. */
+static inline void migrate_slotDict(Dict *d,size_t i) {
 
-  /* Compute the hash and then find the position in the array */
-  result->key    = d->key_function(data);
-  result->bucket = result->key % d->size;
-  result->value  = NULL;
-  result->hops=0;
+  const size_t mask = d->allocation - 1;
+  size_t j;
 
-  Boolean (*cmp)(void *,void *)=d->eq_function;
-  void *ptr;
+  if (d->old_slots[i].index==NO_RECORD) return;
+  j = d->old_slots[i].hash & mask;
+  while(d->slots[j].index!=NO_RECORD) j = (j+1) & mask;
+  d->slots[j] = d->old_slots[i];
+}
 
-  ll=d->buckets[result->bucket];
-  resetSL(ll);
-  while(iscursorvalidSL(ll)) {
+/* Moves the next `n' slots of the old array (if any) in the new
+   one. The old array is freed once it has been completely moved. */
+static void rehashDict(Dict *d,size_t n) {
 
-    ptr=getSL(ll);
+  if (d->old_slots==NULL) return;
 
-    if (  cmp(data,ptr)  ) {
-      result->value=ptr;
-      return;
-    }
-    result->hops++;
-    nextSL(ll);
+  while(n-- > 0 && d->migrated < d->old_allocation) {
+    migrate_slotDict(d,d->migrated++);
   }
-  assert(result->value==NULL);
-  return;
+
+  if (d->migrated == d->old_allocation) {
+    free(d->old_slots);
+    d->old_slots = NULL;
+    d->old_allocation = 0;
+    d->migrated = 0;
+  }
+}
+
+/* Doubles the array of slots. The elements are moved in the new one
+   by subsequent writes. Since the slots keep only 32 bits of the
+   hash, the array can't grow beyond 2^32 slots. */
+static void growDict(Dict *d) {
+
+  /* Growth while moving elements should not happen, but in that case
+     we complete the previous rehashing. */
+  if (d->old_slots) rehashDict(d,d->old_allocation);
+
+  assert(d->allocation <= ((size_t)0x1 << 31));
+
+  d->old_slots = d->slots;
+  d->old_allocation = d->allocation;
+  d->migrated = 0;
+
+  d->allocation <<= 1;
+  d->slots = new_slotsDict(d->allocation);
 }
 
 
 /*
  *  It is equivalent to write in behaviour, but assumes it does not
  *  query the dictionary before insertion. It assumes that the result
- *  of such query is in `result'.
+ *  of such query is in `result', and that the record `index' in the
+ *  arena contains the queried configuration.
  */
-void unsafe_noquery_writeDict(Dict *d,DictQueryResult *const result,void *data) {
+void unsafe_noquery_writeDict(Dict *d,DictQueryResult *const result,RecordIndex index) {
 
   assert(d);
   assert(result);
-  assert(result->key    == d->key_function(data));
-  assert(result->bucket == result->key % d->size);
-
-  LinkedList      *ll  = d->buckets[result->bucket];
-  assert(ll);
-
-  if (result->value==NULL) {
-    /* The configuration does not occur in the dictionary */
-    appendSL(ll,data);
-  } else {
-    /* The configuration occur, so we update the old record if there's the need. */
-    /* We use an internal of LinkedList!! */
-    assert(d->eq_function(data,result->value));
-    ll->cursor->data=data;
+  assert(index < sizeAR(d->records));
+  assert(result->key    == hashRecord(atAR(d->records,index)));
+  assert(result->bucket <  (result->old ? d->old_allocation : d->allocation));
+
+  DictEntry *e;
+
+  if (result->index!=NO_RECORD) {
+    /* The configuration occur, so we update the old record. */
+    e = result->old ? &d->old_slots[result->bucket] : &d->slots[result->bucket];
+    assert(e->index==result->index);
+    e->index = index;
+    return;
+  }
+
+  /* The configuration does not occur in the dictionary */
+  e = &d->slots[result->bucket];
+  assert(e->index==NO_RECORD);
+
+  e->hash  = (uint32_t)result->key;
+  e->index = index;
+  d->size++;
+
+  /* Amortized rehashing */
+  if (d->old_slots) {
+    rehashDict(d,DICT_REHASH_STEP);
+  } else if (4*d->size > 3*d->allocation) {
+    growDict(d);
   }
   return;
 }
@@ -174,53 +206,97 @@ void unsafe_noquery_writeDict(Dict *d,DictQueryResult *const result,void *data)
  *  configuration is absent from the dictionary, then a new record is
  *  added to the dictionary, otherwise an old one is overwritten.  The
  *  DictQueryResult object is filled with the result of the query of
- *  the old value (may be NULL) query.
+ *  the old value (may be NO_RECORD) query.
  */
-void writeDict(Dict *d,DictQueryResult *const result,void *data) {
+void writeDict(Dict *d,DictQueryResult *const result,const PebbleConfiguration *data,RecordIndex index) {
 
   assert(d);
   assert(result);
 
   queryDict(d,result,data);
-  unsafe_noquery_writeDict(d,result,data);
+  unsafe_noquery_writeDict(d,result,index);
 
 }
 
+/* Records match if the pebble set is the same and the sink has been
+   touched in both. */
+static inline Boolean match_recordsDict(const PebbleRecord *a,const PebbleRecord *b) {
+
+#if BLACK_WHITE_PEBBLING
+  if (!bt_equal(a->white_pebbled,b->white_pebbled)) return FALSE;
+#endif
+  return (bt_equal(a->black_pebbled,b->black_pebbled) &&
+          (a->flags & RECORD_SINK_TOUCHED) == (b->flags & RECORD_SINK_TOUCHED));
+}
+
+/* Look for the record in an array of slots */
+static RecordIndex lookup_slotsDict(const Dict *d,const DictEntry *slots,size_t allocation,
+                                    const PebbleRecord *r,size_t key) {
+
+  const size_t mask = allocation - 1;
+
+  for(size_t i=key & mask; slots[i].index!=NO_RECORD; i=(i+1) & mask) {
+    if (slots[i].hash==(uint32_t)key &&
+        match_recordsDict(atAR(d->records,slots[i].index),r)) return slots[i].index;
+  }
+  return NO_RECORD;
+}
+
 /**
- * Print the histogram of the hashtable
+ * Find the configuration described by a record among the ones in the
+ * dictionary. Only the pebbles and the sink status of the record are
+ * considered (see undo_PebbleRecord).
  *
- * @param stream Output file
- * @param d Pointer to the dictionary
+ * @param d the dictionary
+ * @param r the record to be found
+ *
+ * @return the index of the stored record, or NO_RECORD
  */
-void histogramDict(FILE *stream,Dict *d) {
+RecordIndex lookupDict(const Dict *d,const PebbleRecord *r) {
 
-  unsigned int len;
-  unsigned int tot;
-
-  struct LinkedListHandle *cursor;
+  assert(d);
+  assert(r);
 
-  if (d==NULL) return;
+  size_t key=hashRecord(r);
+  RecordIndex index=lookup_slotsDict(d,d->slots,d->allocation,r,key);
 
-  fprintf(stream,"HASHTABLE_HISTOGRAM\n");
-  fprintf(stream,"SIZE %lu\nALLOCATION %lu\n",d->size,d->allocation);
-
-  tot=0;
-  for(size_t i=0;i<d->size;i++) {
-    if (i % 50 == 0) fprintf(stream,"\n");
-    len=0;
-    cursor=d->buckets[i]->head;
-    while(cursor) { len++; cursor=cursor->next;}
-    tot+=len;
-    fprintf(stream,"%u ",len);
-  }
+  if (index==NO_RECORD && d->old_slots)
+    index=lookup_slotsDict(d,d->old_slots,d->old_allocation,r,key);
 
-  fprintf(stream,"\nHASHTABLE_HISTOGRAM\n");
+  return index;
 }
 
 
+/**
+ * Print the histogram of the hashtable, i.e. how many elements are
+ * at distance 0,1,2,... from their home slot.
+ *
+ * @param stream Output file
+ * @param d Pointer to the dictionary
+ */
+void histogramDict(FILE *stream,Dict *d) {
 
+  size_t histogram[40];
+  size_t mask;
+  size_t distance;
+
+  if (d==NULL) return;
 
+  for(int i=0;i<40;i++) histogram[i]=0;
+  mask = d->allocation - 1;
 
+  fprintf(stream,"HASHTABLE_HISTOGRAM\n");
+  fprintf(stream,"SIZE %lu\nALLOCATION %lu\nOLD ALLOCATION %lu\n",
+          d->size,d->allocation,d->old_allocation);
 
+  for(size_t i=0;i<d->allocation;i++) {
+    if (d->slots[i].index==NO_RECORD) continue;
+    distance = (i - d->slots[i].hash) & mask;
+    histogram[ distance < 39 ? distance : 39 ]++;
+  }
 
+  for(int i=0;i<39;i++) fprintf(stream," %2d  = %15lu\n",i,histogram[i]);
+  fprintf(stream," ... = %15lu\n",histogram[39]);
 
+  fprintf(stream,"HASHTABLE_HISTOGRAM\n");
+}
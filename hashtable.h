@@ -6,7 +6,9 @@
 
    Description::
 
-   Header file for hashtable.c, a very simple implementation of a dictionary with hashtable.
+   Header file for hashtable.c, a dictionary of pebble configurations
+   implemented as an open addressing hash table. Like the
+   configurations, it is compiled once for each width.
 
 */
 
@@ -16,58 +18,228 @@
 #define  HASHTABLE_H
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
 #include "common.h"
 #include "dsbasic.h"
+#include "configuration.h"
 
-/* Code */
+/* Symbols of the build for the current width (see bittuple.h) */
+#define newDict                   WIDTH_SYMBOL(newDict)
+#define disposeDict               WIDTH_SYMBOL(disposeDict)
+#define isconsistentDict          WIDTH_SYMBOL(isconsistentDict)
+#define writeDict                 WIDTH_SYMBOL(writeDict)
+#define unsafe_noquery_writeDict  WIDTH_SYMBOL(unsafe_noquery_writeDict)
+#define histogramDict             WIDTH_SYMBOL(histogramDict)
+#define lookupDict                WIDTH_SYMBOL(lookupDict)
 
-/* The dictionary has a very simple implementation.  It is an array of
-   lists, each list is indexed by an hash which is reduced modulo the
-   size of the array.  Notice that for performance we statically
-   allocate the array, and the actual size is between 15/16 and 16/16
-   of the allocated size.
+/* Code */
 
-   The dictionary also keeps a list of elements in the buckets. It is
-   sorted with respect to the time of insertion in the dictionary.
+/* The dictionary is a flat array of slots, indexed by an hash of the
+   configuration reduced modulo the size of the array (which is
+   always a power of two). Collisions are resolved by linear probing.
+
+   The configurations are stored as PebbleRecord objects in an arena
+   which is owned by the caller. Each slot keeps the index of a
+   record together with the low 32 bits of its hash: most mismatches
+   are discarded without reading the record, and the slots can be
+   moved without computing the hash again.
+
+   The array is doubled as soon as it gets 3/4 full.  In order to
+   avoid a long pause in the middle of the search, the elements are
+   not moved all at once: the old array is kept around and each write
+   moves DICT_REHASH_STEP slots of it in the new one. Until the old
+   array is empty, queries look in both.
+
+   The initial allocation is chosen by the caller, typically from an
+   estimate of the number of configurations to be stored, and it is
+   kept between DICT_MIN_ALLOCATION and DICT_MAX_ALLOCATION.
  */
+#define DICT_MIN_ALLOCATION  (0x1UL << 10)
+#define DICT_MAX_ALLOCATION  (0x1UL << 23)
+#define DICT_REHASH_STEP     8
+
+typedef struct {
+
+  uint32_t    hash;    /* Low bits of the hash of the record */
+  RecordIndex index;   /* NO_RECORD if the slot is empty */
+
+} DictEntry;
+
 typedef struct {
 
-  size_t allocation;
-  size_t size;
+  size_t allocation;      /* Number of slots (a power of two) */
+  size_t size;            /* Number of configurations in the dictionary */
+
+  DictEntry *slots;
 
-  LinkedList **buckets;
+  DictEntry *old_slots;   /* Array being emptied, or NULL */
+  size_t old_allocation;
+  size_t migrated;        /* Old slots already moved */
 
-  size_t   (*key_function)(void *data);
-  Boolean  ( *eq_function)(void *A,void *B);
-  void     (*dispose_function)(void *data);
+  Arena *records;         /* Storage of the PebbleRecord objects */
 
 } Dict;
 
 /*
- * When the  dictionary is queried the  result is simply  the index of
- * the bucket in which the record  hashes, and a pointer to a matching
- * occurrence  in the  dictionary, if  there  is any.  A null  pointer
- * represent no matching record.
+ * When the  dictionary is queried the  result is the  hash key of the
+ * configuration, the slot where the probing stopped and the index of
+ * a matching record in the dictionary, if  there is any. NO_RECORD
+ * represent no matching record. If the record is still in the old
+ * array, `old' is set.
  */
 typedef struct {
 
   size_t key;
-  void   *value;
+  RecordIndex index;
   size_t bucket;
   size_t hops;
+  Boolean old;
 
 } DictQueryResult;
 
-extern Dict *newDict(size_t allocation);
+extern Dict *newDict(size_t expected_size,Arena *records);
 extern void disposeDict(Dict *d);
 
 extern Boolean isconsistentDict(Dict *d);
 
-extern void queryDict(Dict* d,DictQueryResult *const result,void *data);
-extern void writeDict(Dict *d,DictQueryResult *const result,void *data);
-extern void unsafe_noquery_writeDict(Dict *d,DictQueryResult *const result,void *data);
+extern void writeDict(Dict *d,DictQueryResult *const result,const PebbleConfiguration *data,RecordIndex index);
+extern void unsafe_noquery_writeDict(Dict *d,DictQueryResult *const result,RecordIndex index);
 
 extern void histogramDict(FILE *stream,Dict *d);
 
+extern RecordIndex lookupDict(const Dict *d,const PebbleRecord *r);
+
+
+/*
+ * The hash of a configuration depends only on the pebbled vertices
+ * and on whether the sink has been touched. The bits are mixed with
+ * the finalizer of MurmurHash3, since the table uses the low bits of
+ * the key as an index.
+ */
+static inline size_t mixDict(BitWord black,BitWord white,Boolean sink_touched) {
+  BitWord h = black ^ (white * 0x9e3779b97f4a7c15ULL)
+                    ^ (sink_touched ? 0xc2b2ae3d27d4eb4fULL : 0x0ULL);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return (size_t)h;
+}
+
+static inline size_t hashDict(const PebbleConfiguration *c) {
+#if BLACK_WHITE_PEBBLING
+  return mixDict(bt_fold(c->black_pebbled),bt_fold(c->white_pebbled),c->sink_touched);
+#else
+  return mixDict(bt_fold(c->black_pebbled),0x0ULL,c->sink_touched);
+#endif
+}
+
+static inline size_t hashRecord(const PebbleRecord *r) {
+#if BLACK_WHITE_PEBBLING
+  return mixDict(bt_fold(r->black_pebbled),bt_fold(r->white_pebbled),r->flags & RECORD_SINK_TOUCHED);
+#else
+  return mixDict(bt_fold(r->black_pebbled),0x0ULL,r->flags & RECORD_SINK_TOUCHED);
+#endif
+}
+
+/* Configurations match if the pebble set is the same and the sink
+   has been touched in both. Pebbling cost and history are not
+   considered, since the collision is what we use to cut the
+   search. */
+static inline Boolean matchDict(const PebbleRecord *r,const PebbleConfiguration *c) {
+
+#if BLACK_WHITE_PEBBLING
+  return (bt_equal(r->black_pebbled,c->black_pebbled) &&
+          bt_equal(r->white_pebbled,c->white_pebbled) &&
+          ((r->flags & RECORD_SINK_TOUCHED)!=0) == (c->sink_touched!=0));
+#else
+  return (bt_equal(r->black_pebbled,c->black_pebbled) &&
+          ((r->flags & RECORD_SINK_TOUCHED)!=0) == (c->sink_touched!=0));
+#endif
+}
+
+/* Same, between two configurations */
+static inline Boolean match_configurationsDict(const PebbleConfiguration *a,const PebbleConfiguration *b) {
+
+#if BLACK_WHITE_PEBBLING
+  if (!bt_equal(a->white_pebbled,b->white_pebbled)) return FALSE;
+#endif
+  return (bt_equal(a->black_pebbled,b->black_pebbled) &&
+          (a->sink_touched!=0) == (b->sink_touched!=0));
+}
+
+/*
+   The query consist of a pointer to a configuration and of its hash
+   key, which must be hashDict(data). The slots are scanned from the
+   position indicated by the hash until either the configuration or an
+   empty slot is found. A DictQueryResult object with index field set
+   to NO_RECORD means the configuration is not in the dictionary, and
+   in that case the bucket field is the empty slot where it should be
+   written.
+ */
+static inline void keyed_queryDict(Dict* d,DictQueryResult *const result,
+                                   const PebbleConfiguration *data,size_t key) {
+
+  assert(d);
+  assert(result);
+  assert(key==hashDict(data));
+
+  size_t mask = d->allocation - 1;
+  const DictEntry *slots = d->slots;
+  uint32_t tag;
+  size_t i;
+
+  result->key   = key;
+  result->index = NO_RECORD;
+  result->hops  = 0;
+  result->old   = FALSE;
+  tag = (uint32_t)result->key;
+
+  i = result->key & mask;
+  while(slots[i].index!=NO_RECORD) {
+    if (slots[i].hash==tag &&
+        matchDict((const PebbleRecord*)atAR(d->records,slots[i].index),data)) {
+      result->index  = slots[i].index;
+      result->bucket = i;
+      return;
+    }
+    result->hops++;
+    i = (i+1) & mask;
+  }
+  result->bucket = i;
+
+  /* Elements not yet moved are still in the old array. */
+  if (d->old_slots==NULL) return;
+
+  mask  = d->old_allocation - 1;
+  slots = d->old_slots;
+
+  i = result->key & mask;
+  while(slots[i].index!=NO_RECORD) {
+    if (slots[i].hash==tag &&
+        matchDict((const PebbleRecord*)atAR(d->records,slots[i].index),data)) {
+      result->index  = slots[i].index;
+      result->bucket = i;
+      result->old    = TRUE;
+      return;
+    }
+    result->hops++;
+    i = (i+1) & mask;
+  }
+  return;
+}
+
+/* Same as keyed_queryDict, computing the hash of the configuration. */
+static inline void queryDict(Dict* d,DictQueryResult *const result,const PebbleConfiguration *data) {
+  keyed_queryDict(d,result,data,hashDict(data));
+}
+
+/* Brings in cache the home slot of a key, ahead of its query. */
+static inline void prefetchDict(const Dict* d,size_t key) {
+  PREFETCH(&d->slots[key & (d->allocation - 1)]);
+}
 
 #endif /* HASHTABLE_H */
@@ -148,6 +148,7 @@ DAG *kthparser(FILE *input) {
   assert(vertices>0);
 
   /* Set to null sinks and source vector */
+  dag->bitmask_words=0;
   dag->pred_bitmasks=NULL;
   dag->succ_bitmasks=NULL;
   dag->sources=NULL;
@@ -17,16 +17,63 @@
 #include "timedflags.h"
 #include "pebbling.h"
 #include "bfs.h"
+#include "search.h"
+#include "dfs.h"
+#include "bidir.h"
+#include "frontier.h"
+#include "sat.h"
+#include "symbolic.h"
+#include "bounds.h"
 #include "config.h"
 
 
 #define USAGEMESSAGE "\n\
-Usage: %s [-htZ] -b<int> [-g <dotfile>] [ -p<int> | -2<int> | -i <input> ] [-O <input2> ] \n\
+Usage: %s [-htsPzZ] -b<int> [-e <engine>] [-j <threads>] [-m <megabytes>] [-d <directory>] [-L <length>] [-D <cnffile>] [-g <dotfile>] [ -p<int> | -2<int> | -i <input> ] [-O <input2> ] \n\
 \n\
        -h     help message;\n\
        -Z     search for a 'persistent pebbling' (optional, only useful for black/white pebbling).\n\
-       -t     find shortest pebbling within space limits, instead of minimizing space (optional).\n\
+       -t     find shortest pebbling within space limits, instead of minimizing space (optional,\n\
+              not with the resume, bisect and dfs engines).\n\
+       -s     the bfs engine keeps one configuration for each orbit of the\n\
+              automorphisms of the graph (optional).\n\
+       -P     the bfs engine explores a single order of the moves on\n\
+              vertices which are not adjacent (optional).\n\
+       -z     the bfs engine keeps the visited configurations in a\n\
+              zero-suppressed decision diagram (optional).\n\
        -g <dotfile> graphviz depiction of pebbling save on <dotfile>.\n\
+       -e <engine>  search engine used to minimize space (optional):\n\
+                    bfs     a new breadth-first search for each bound (default);\n\
+                    resume  one breadth-first search resumed at each bound, the\n\
+                            pebbling may not be the shortest one of its cost;\n\
+                    minimax a single search ordered by the peak number of pebbles,\n\
+                            with -t the shortest pebbling of minimum cost is found;\n\
+                    bisect  searches with bounds probed at exponential distance,\n\
+                            then by bisection, running concurrently;\n\
+                    dfs     a depth-first search for each bound, in bounded memory,\n\
+                            the pebbling may not be the shortest one of its cost;\n\
+                    bidir   a search for each bound from both the initial and\n\
+                            the final configuration;\n\
+                    frontier a search for each bound which keeps only the last\n\
+                            levels, only for reversible pebbling;\n\
+                    sat     a SAT solver for each bound, which does not see\n\
+                            the pebblings longer than -L;\n\
+                    symbolic a breadth-first search for each bound, on sets\n\
+                            of configurations represented by BDDs.\n\
+       -j <threads> number of threads used by the search (default 1): the\n\
+                    bfs engine expands each level of the search in parallel,\n\
+                    the bisect engine runs concurrent probes, the dfs engine\n\
+                    steals work among depth-first searches, the minimax engine\n\
+                    with -t runs its last search in parallel.\n\
+       -m <megabytes> memory for the table of visited configurations of the\n\
+                    dfs engine, or to sort the levels of the bfs engine\n\
+                    on disk (default %d).\n\
+       -d <directory> the bfs engine keeps the levels of the search in files\n\
+                    of <directory>, instead of memory.\n\
+       -s, -P, -z, -d are for the bfs engine with one thread, one at a time.\n\
+       -L <length>  maximum length of the pebblings of the sat engine\n\
+                    (default %d times the number of vertices).\n\
+       -D <cnffile> write in <cnffile> the formula of the sat engine for the\n\
+                    bound given by -b and the length given by -L, and exit.\n\
 \n\
        -b M   maximum number of pebbles (mandatory);\n\
 \n\
@@ -57,6 +104,18 @@ c\n\
 5  : 2  4\n"
 
 
+/* Search engines */
+#define ENGINE_BFS     0
+#define ENGINE_RESUME  1
+#define ENGINE_MINIMAX 2
+#define ENGINE_BISECT  3
+#define ENGINE_DFS     4
+#define ENGINE_BIDIR   5
+#define ENGINE_FRONTIER 6
+#define ENGINE_SAT     7
+#define ENGINE_SYMBOLIC 8
+
+
 #if BLACK_WHITE_PEBBLING && REVERSIBLE_PEBBLING
 #error "Invalid compiler options: black/white AND reversible simultaneously."
 #endif
@@ -97,6 +156,18 @@ FILE *openoutputfile(const char* filename) {
 
 extern DAG *kthparser(FILE *stream);
 
+/*
+ *  Print a lower bound on the cost (zero means no bound), and return
+ *  the best between it and `best'.
+ */
+static unsigned int print_lower_bound(const char *argument,unsigned int bound,unsigned int best) {
+
+  if (bound==0) return best;
+
+  printf("c Lower bound from %s: %u\n",argument,bound);
+  return bound > best ? bound : best;
+}
+
 /**
  *  The example test program creates two pyramid graphs and produces
  *  the OR-product graph of them.  Then it prints the DOT
@@ -121,6 +192,15 @@ int main(int argc, char *argv[])
   
   int optimize_time=0;
   int persistent_pebbling=0;
+  int use_symmetries=0;
+  int partial_order=0;
+  int use_zdd=0;
+  int engine=ENGINE_BFS;
+  int threads=1;
+  int table_mb=DFS_DEFAULT_TABLE_MB;
+  char *scratch_directory=NULL;
+  int max_length=0;
+  FILE *cnf_file=NULL;
   int option_code=0;
 
   unsigned int cost=0;
@@ -131,10 +211,10 @@ int main(int argc, char *argv[])
 
   /* Parse option to set Pyramid height,
      pebbling upper bound. */
-  while((option_code = getopt(argc,argv,"htZb:p:2:c:f:i:O:g:"))!=-1) {
+  while((option_code = getopt(argc,argv,"htsPzZb:e:j:m:d:L:D:p:2:c:f:i:O:g:"))!=-1) {
     switch (option_code) {
     case 'h':
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_SUCCESS);
       break;
     case 'Z':
@@ -143,29 +223,77 @@ int main(int argc, char *argv[])
     case 't':
       optimize_time=1;
       break;
+    case 's':
+      use_symmetries=1;
+      break;
+    case 'P':
+      partial_order=1;
+      break;
+    case 'z':
+      use_zdd=1;
+      break;
     case 'b':
       pebbling_bound=atoi(optarg);
       if (pebbling_bound>0) break;
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+      exit(EXIT_FAILURE);
+      break;
+    case 'e':
+      if      (strcmp(optarg,"bfs")==0)    engine=ENGINE_BFS;
+      else if (strcmp(optarg,"resume")==0) engine=ENGINE_RESUME;
+      else if (strcmp(optarg,"minimax")==0) engine=ENGINE_MINIMAX;
+      else if (strcmp(optarg,"bisect")==0)  engine=ENGINE_BISECT;
+      else if (strcmp(optarg,"dfs")==0)     engine=ENGINE_DFS;
+      else if (strcmp(optarg,"bidir")==0)   engine=ENGINE_BIDIR;
+      else if (strcmp(optarg,"frontier")==0) engine=ENGINE_FRONTIER;
+      else if (strcmp(optarg,"sat")==0)     engine=ENGINE_SAT;
+      else if (strcmp(optarg,"symbolic")==0) engine=ENGINE_SYMBOLIC;
+      else {
+        fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case 'j':
+      threads=atoi(optarg);
+      if (threads>0) break;
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+      exit(EXIT_FAILURE);
+      break;
+    case 'm':
+      table_mb=atoi(optarg);
+      if (table_mb>0) break;
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
       break;
+    case 'd':
+      scratch_directory=optarg;
+      break;
+    case 'L':
+      max_length=atoi(optarg);
+      if (max_length>0) break;
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+      exit(EXIT_FAILURE);
+      break;
+    case 'D':
+      cnf_file=openoutputfile(optarg);
+      break;
     /* Input */
     case 'p':
       pyramid_height=atoi(optarg);
       if (pyramid_height>0) {input_directives++; break;}
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
       break;
     case '2':
       tree_height=atoi(optarg);
       if (tree_height>0) {input_directives++; break;}
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
       break;
     case 'c':
       chain_length=atoi(optarg);
       if (chain_length>0) {input_directives++; break;}
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
       break;
     case 'i':
@@ -175,7 +303,7 @@ int main(int argc, char *argv[])
     case 'O':
       input_file_aux=openinputfile(optarg);
       if (input_file!=stdin || input_file_aux!=stdin) break;
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
       break;
       /* Output format */
@@ -184,24 +312,54 @@ int main(int argc, char *argv[])
       break;
     case '?':
     default:
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
     }
   }
 
   /* Test for valid command line */
   if (pebbling_bound==0) {
-      fprintf(stderr,USAGEMESSAGE,argv[0]);
+      fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
       exit(EXIT_FAILURE);
   }
 
   /* Only one input */
   if (input_directives > 1) {
-    fprintf(stderr,USAGEMESSAGE,argv[0]);
+    fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
     exit(EXIT_FAILURE);
   } 
   if (input_directives == 0) input_file = stdin;
 
+  /* The variants of the bfs engine exclude each other, and each of
+     them runs in a single thread */
+  int bfs_variants = (scratch_directory!=NULL) + use_symmetries + partial_order + use_zdd;
+  if (bfs_variants > 1 ||
+      (bfs_variants > 0 && (engine!=ENGINE_BFS || threads>1))) {
+    fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+    exit(EXIT_FAILURE);
+  }
+
+  /* These engines only minimize the cost */
+  if (optimize_time &&
+      (engine==ENGINE_RESUME || engine==ENGINE_BISECT || engine==ENGINE_DFS)) {
+    fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+    exit(EXIT_FAILURE);
+  }
+
+  /* The frontier search needs the moves to be reversible */
+  if (engine==ENGINE_FRONTIER && !reversible_pebbling()) {
+    fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+    exit(EXIT_FAILURE);
+  }
+
+  /* Engines which run in a single thread */
+  if (threads>1 &&
+      !(engine==ENGINE_BFS || engine==ENGINE_BISECT || engine==ENGINE_DFS ||
+        (engine==ENGINE_MINIMAX && optimize_time))) {
+    fprintf(stderr,USAGEMESSAGE,argv[0],DFS_DEFAULT_TABLE_MB,SAT_DEFAULT_STEPS_PER_VERTEX);
+    exit(EXIT_FAILURE);
+  }
+
 
   /* Timer for reporting progress */
 #if PRINT_STATS_INTERVAL > 0
@@ -248,13 +406,179 @@ int main(int argc, char *argv[])
   fprint_DAG(stdout,C,"c ");
   printf("c =====input ends=======\n");
   
+  /* With -t the search is at the bound alone, but the minimax engine
+     finds the minimum cost first */
+  int minimize_cost= !optimize_time || engine==ENGINE_MINIMAX;
+
+  /* Lower bounds on the cost, the searches below them are hopeless */
+  unsigned int lower_bound=1;
+
+  lower_bound=print_lower_bound("indegree",indegree_lower_bound(C),lower_bound);
+  lower_bound=print_lower_bound("longest path",path_lower_bound(C,persistent_pebbling),lower_bound);
+  lower_bound=print_lower_bound("in-tree",intree_lower_bound(C),lower_bound);
+  if (!input_file_aux && pyramid_height>0)
+    lower_bound=print_lower_bound("pyramid",pyramid_lower_bound(pyramid_height),lower_bound);
+  if (!input_file_aux && tree_height>0)
+    lower_bound=print_lower_bound("tree",tree_lower_bound(tree_height),lower_bound);
+
+  if (lower_bound>1 && minimize_cost)
+    printf("c Search for cost below %u skipped\n",lower_bound);
+
+  unsigned int upper_bound=recursive_upper_bound(C);
+  if (upper_bound>0)
+    printf("c Upper bound from recursive pebbling: %u\n",upper_bound);
+
+  /* Automorphisms of the graph, for the search up to symmetries */
+  Vertex *generators=NULL;
+  size_t  generator_number=0;
+  if (use_symmetries) {
+    generators=automorphisms_DAG(C,&generator_number);
+    printf("c Automorphisms of the graph: %lu generators\n",(unsigned long)generator_number);
+  }
+
+  if (max_length==0) max_length=SAT_DEFAULT_STEPS_PER_VERTEX*(int)C->size;
+
+  /* Write the formula instead of searching */
+  if (cnf_file) {
+    fprint_dimacs_pebbling(cnf_file,C,pebbling_bound,persistent_pebbling,max_length);
+    fclose(cnf_file);
+    printf("c Formula for %s of cost %d and length %d written\n",
+           pebbling_type(),pebbling_bound,max_length);
+    dispose_DAG(C);
+    free(generators);
+    exit(EXIT_UNKNOWN);
+  }
+
   /* Search space interval*/
-  cost= optimize_time ? pebbling_bound : 1;
+  cost= minimize_cost ? 1 : pebbling_bound;
+  if (cost<lower_bound) cost=lower_bound;
+
+  /* The black pebbling of an in-tree needs no search, when the
+     minimum cost is asked for */
+  Pebbling *intree= (persistent_pebbling || optimize_time) ? NULL : intree_pebbling_strategy(C);
+
+  if (intree) {
+
+    printf("c Search for %s skipped: the graph is an in-tree, built directly\n",pebbling_type());
+    if (intree->cost <= pebbling_bound) solution=intree;
+    else dispose_Pebbling(intree);
+
+  } else if (engine==ENGINE_MINIMAX) {
+
+    /* The bound is a cap, and -t asks for the shortest pebbling with
+       the cost found. */
+    printf("c Search for %s of minimum cost, between %d and %d\n",pebbling_type(),cost,pebbling_bound);
+    solution=minimax_pebbling_strategy(C,cost,pebbling_bound,persistent_pebbling);
+    if (solution && optimize_time) {
+      cost=solution->cost;
+      dispose_Pebbling(solution);
+      printf("c Search for shortest %s of cost %d\n",pebbling_type(),cost);
+      solution= (threads>1) ?
+        parallel_bfs_pebbling_strategy(C,cost,persistent_pebbling,threads) :
+        bfs_pebbling_strategy(C,cost,persistent_pebbling);
+    }
+
+  } else if (engine==ENGINE_BISECT) {
+
+    printf("c Search for %s of minimum cost, between %d and %d, with %d threads\n",
+           pebbling_type(),cost,pebbling_bound,threads);
+    solution=bisect_pebbling_strategy(C,cost,pebbling_bound,upper_bound,persistent_pebbling,threads);
+
+  } else if (engine==ENGINE_DFS) {
+
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d, depth-first\n",pebbling_type(),cost);
+      solution=dfs_pebbling_strategy(C,cost,persistent_pebbling,threads,(size_t)table_mb << 20);
+      cost++;
+    }
+
+  } else if (engine==ENGINE_BIDIR) {
+
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d, bidirectional\n",pebbling_type(),cost);
+      solution=bidirectional_pebbling_strategy(C,cost,persistent_pebbling);
+      cost++;
+    }
+
+  } else if (engine==ENGINE_FRONTIER) {
 
-  while ( (cost <= pebbling_bound) && !solution ) {
-    printf("c Search for %s of cost %d\n",pebbling_type(),cost);
-    solution=bfs_pebbling_strategy(C,cost,persistent_pebbling);
-    cost++;
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d, frontier\n",pebbling_type(),cost);
+      solution=frontier_pebbling_strategy(C,cost,persistent_pebbling);
+      cost++;
+    }
+
+  } else if (engine==ENGINE_SAT) {
+
+    /* Without a pebbling of at most -L steps a bound is not refuted,
+       in general: the search goes on with the next one, and the cost
+       found may not be the minimum. */
+    Boolean refuted=TRUE;
+    int unrefuted=0;           /* The smallest cost not refuted */
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d, by SAT up to length %d\n",pebbling_type(),cost,max_length);
+      solution=sat_pebbling_strategy(C,cost,persistent_pebbling,max_length,&refuted);
+      if (!solution && !refuted && unrefuted==0) unrefuted=cost;
+      cost++;
+    }
+    if (solution && unrefuted>0) {
+      printf("c Costs %d to %d were refuted only up to %d steps, the cost found "
+             "may not be the minimum (see -L).\n",
+             unrefuted,cost-2,max_length);
+    }
+    if (!solution && unrefuted>0) {
+      printf("c %s does not have a %s of cost %d and at most %d steps, "
+             "longer ones were not searched (see -L).\n",
+             graph_name,pebbling_type(),pebbling_bound,max_length);
+      printf("s UNKNOWN\n");
+      dispose_DAG(C);
+      free(generators);
+      exit(EXIT_UNKNOWN);
+    }
+
+  } else if (engine==ENGINE_SYMBOLIC) {
+
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d, symbolic\n",pebbling_type(),cost);
+      solution=symbolic_pebbling_strategy(C,cost,persistent_pebbling);
+      cost++;
+    }
+
+  } else if (engine==ENGINE_RESUME) {
+
+    ResumableSearch *S=new_ResumableSearch(C,pebbling_bound,persistent_pebbling);
+    while ( (cost <= pebbling_bound) && !solution ) {
+      printf("c Search for %s of cost %d\n",pebbling_type(),cost);
+      solution=resume_ResumableSearch(S,cost);
+      cost++;
+    }
+    dispose_ResumableSearch(S);
+
+  } else {
+
+    while ( (cost <= pebbling_bound) && !solution ) {
+      if (scratch_directory) {
+        printf("c Search for %s of cost %d, on disk\n",pebbling_type(),cost);
+        solution=external_bfs_pebbling_strategy(C,cost,persistent_pebbling,
+                                                scratch_directory,(size_t)table_mb << 20);
+      } else if (generators) {
+        printf("c Search for %s of cost %d, up to symmetries\n",pebbling_type(),cost);
+        solution=symmetric_bfs_pebbling_strategy(C,cost,persistent_pebbling,
+                                                 generators,generator_number);
+      } else if (partial_order) {
+        printf("c Search for %s of cost %d, with partial order reduction\n",pebbling_type(),cost);
+        solution=reduced_bfs_pebbling_strategy(C,cost,persistent_pebbling);
+      } else if (use_zdd) {
+        printf("c Search for %s of cost %d, visited configurations in a ZDD\n",pebbling_type(),cost);
+        solution=zdd_bfs_pebbling_strategy(C,cost,persistent_pebbling);
+      } else {
+        printf("c Search for %s of cost %d\n",pebbling_type(),cost);
+        solution= (threads>1) ?
+          parallel_bfs_pebbling_strategy(C,cost,persistent_pebbling,threads) :
+          bfs_pebbling_strategy(C,cost,persistent_pebbling);
+      }
+      cost++;
+    }
   }
 
   /* Output solution */
@@ -279,6 +603,7 @@ int main(int argc, char *argv[])
   int exit_code=EXIT_SUCCESS;
   
   dispose_DAG(C);
+  free(generators);
 
   if (solution) {
     dispose_Pebbling(solution);
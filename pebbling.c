@@ -7,15 +7,18 @@
    Description::
 
    Pebbling of a graphs: we implement the main data structure for a
-   pebbling, and basic management functions, to recognise which
-   vertices in the graph can be pebbled and which white pebble can be
-   removed.
+   pebbling, and functions to print it.
+
+   The pebble configurations used by the search are in
+   configuration.c, which is compiled once for each width of the
+   representation.
 
 */
 
 /* Preamble */
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <assert.h>
 #include "common.h"
 #include "dag.h"
@@ -87,403 +90,119 @@ void dispose_Pebbling(Pebbling *ptr) {
 }
 
 
-/**
-   Pebbling Configurations
- */
-
-
-/**
- * Create a new empty pebble configuration allocated on the heap
- * memory.
- *
- * @return a pointer to a the configuration.
- */
-PebbleConfiguration *new_PebbleConfiguration(void) {
-
-  PebbleConfiguration *ptr=(PebbleConfiguration*)malloc(sizeof(PebbleConfiguration));
-
-  assert(ptr);
-
-#if BLACK_WHITE_PEBBLING
-  ptr->white_pebbled=0;
-#endif
-
-  ptr->black_pebbled=0;
-
-  ptr->used_pebbles = 0;
-  
-  ptr->sink_touched =FALSE;
-
-  ptr->pebbles=0;
-
-  ptr->previous_configuration=NULL;
-  ptr->last_changed_vertex=0;
-
-  return ptr;
-}
-
 
 /**
- * Allocate a copy of a pebble configuration.
+ * Estimate the number of configurations with at most a given number
+ * of pebbles. This is the number of distinct pebble sets (where each
+ * pebble can be black or white in black-white pebbling), times two
+ * for the sink being touched or not. It is an upper bound on the
+ * configurations visited by the search, and it is used to size the
+ * data structures.
  *
- * @param src a pointer to the configuration to be copied.
+ * @param g the graph to be pebbled
+ * @param max_pebbles the maximum number of pebbles
  *
- * @return a pointer to a new configuration.
+ * @return the estimate, or SIZE_MAX if it does not fit in a size_t
  */
-PebbleConfiguration *copy_PebbleConfiguration(const PebbleConfiguration *src) {
-
-  PebbleConfiguration *dst=(PebbleConfiguration*)malloc(sizeof(PebbleConfiguration));
-
-  assert(src);
-  assert(dst);
-
-#if BLACK_WHITE_PEBBLING
-  dst->white_pebbled=src->white_pebbled;
-#endif
-
-  dst->black_pebbled=src->black_pebbled;
-
-  dst->used_pebbles = src->used_pebbles;
-  
-  dst->sink_touched=src->sink_touched;
-
-  dst->pebbles=src->pebbles;
-
-  dst->previous_configuration=src->previous_configuration;
-  dst->last_changed_vertex=src->last_changed_vertex;
-
-  return dst;
-}
-
-void dispose_PebbleConfiguration(PebbleConfiguration *ptr) {
-  assert(ptr);
-  free(ptr);
-}
-
-/* This function checks if the configuration of pebbles referenced by
-   ptr is a consistent configuration for the graph referenced by
-   graph, which in turns must be consistent. */
-Boolean isconsistent_PebbleConfiguration(const DAG *graph,const PebbleConfiguration *ptr) {
-
-  assert(ptr);
-  assert(graph);
-
-  /* The size of the graph and the number of sinks must fit with the
-     pebbling representation. */
-  if (graph->size > BITTUPLE_SIZE) return FALSE;
-  if (graph->sink_number != 1)    return FALSE;
-
-  /* The configuration must not have both a white and a black pebble
-     on the same vertex */
-#if BLACK_WHITE_PEBBLING
-  if (ptr->white_pebbled & ptr->black_pebbled) return FALSE;
-#endif
-
-  /* If there's a pebble on the sink, sink is touched */
-  if (ptr->black_pebbled & (BITTUPLE_UNIT << graph->sinks[0])) {
-    if (!ptr->sink_touched) return FALSE;
-  }
-
-#if BLACK_WHITE_PEBBLING
-if (ptr->white_pebbled & (BITTUPLE_UNIT << graph->sinks[0])) {
-    if (!ptr->sink_touched) return FALSE;
-  }
-#endif
-  
-  /* If sink is touched in the previous conf, then it must be later */
-  if (ptr->previous_configuration!=NULL &&
-      ptr->previous_configuration->sink_touched==TRUE &&
-      ptr->sink_touched==FALSE
-      ) return FALSE;
-
-  /* Count the number of pebbles in the bitvector and check
-     consistency with the pebble counter */
-  unsigned int counter=0;
-
-  for(size_t i=0; i<graph->size; i++) {
-
-#if BLACK_WHITE_PEBBLING    
-    if GETBIT(ptr->white_pebbled,i) counter++;
-#endif
-
-    if GETBIT(ptr->black_pebbled,i) counter++;
-  }
-
-  if (counter!=ptr->pebbles) return FALSE;
-
-  /* Check that the mask is clean in the residual bits */
-  BitTuple mask = ptr->used_pebbles;
-
-#if BLACK_WHITE_PEBBLING
-  mask |= ptr->white_pebbled;
-#endif
-  
-  mask |= ptr->black_pebbled;
-  
-  if (BITTUPLE_SIZE > graph->size) {
-    if ( mask & /* bit mentioned in the configuration */
-         ~((BITTUPLE_UNIT << graph->size) -1) )      /* A bitmask which is set only on the high bits */
-      return FALSE;
-  }
-
-  return TRUE;
-}
-
-
-inline int configurationcost(const DAG *g,const PebbleConfiguration *c) {
+size_t estimate_configurations(const DAG *g,unsigned int max_pebbles) {
 
   assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
 
-  int cost = 0;
-  BitTuple pebbled = 0;
+  double binomial = 1.0;   /* C(n,i) */
+  double colors   = 1.0;   /* 2^i in black-white pebbling */
+  double total    = 0.0;
 
+  for(size_t i=0; i<=max_pebbles && i<=g->size; i++) {
+    total += binomial * colors;
+    binomial = binomial * (double)(g->size - i) / (double)(i+1);
 #if BLACK_WHITE_PEBBLING
-  pebbled |= c->white_pebbled;
+    colors  *= 2.0;
 #endif
-
-  pebbled |= c->black_pebbled;
-  
-  for(Vertex v=0; v<g->size; v++) {
-    if (GETBIT(pebbled,v)==1) cost++;
   }
-  return cost;
-}
-
-
-/* ------------------------------ Manipulation of pebble status -----------------------------*/
-
-inline void deleteblack(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-  assert(isblack(v,g,c));
-#if REVERSIBLE_PEBBLING
-  assert(isactive(v,g,c));
-#endif
-
-  RESETBIT(c->black_pebbled,v);
-  RESETBIT(c->used_pebbles,v);
-  c->pebbles       -= 1;
-#if REVERSIBLE_PEBBLING
-  c->used_pebbles |= g->pred_bitmasks[v];
-#endif
-}
-
-/* Determines if a vertex is black pebbled according to a specific
-   configuration */
-inline Boolean isblack(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+  total *= 2.0;
 
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-
-  return GETBIT(c->black_pebbled,v);
+  if (total >= (double)SIZE_MAX) return SIZE_MAX;
+  return (size_t)total;
 }
 
-inline void placeblack(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
 
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-  assert(!ispebbled(v,g,c));
-  assert(isactive(v,g,c));
-
-  SETBIT(c->black_pebbled,v);
-  c->pebbles       += 1;
-  c->used_pebbles |= g->pred_bitmasks[v];
-
-  if (v==g->sinks[0] && !c->sink_touched) {
-    c->sink_touched = TRUE;
-    SETBIT(c->used_pebbles,v);
-  }
-}
+/* Pretty printing of pebblings
 
+   A pebbling is a sequence of vertices, and the move on each vertex
+   is determined by the current configuration. Printing does not need
+   the compact representation used by the search (which depends on
+   the size of the graph), so the configuration is simulated here
+   with one status per vertex. */
 
-#if BLACK_WHITE_PEBBLING
-
-inline void deletewhite(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-  assert(iswhite(v,g,c));
-  assert(isactive(v,g,c));
-
-  RESETBIT(c->white_pebbled,v);
-  RESETBIT(c->used_pebbles,v);
-  c->pebbles       -= 1;
-  c->used_pebbles |= g->pred_bitmasks[v];
-}
-
-
-/* Determines if a vertex is white pebbled according to a specific
-   configuration */
-inline Boolean iswhite(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-
-  return GETBIT(c->white_pebbled,v);
-}
-
-inline void placewhite(const Vertex v,const DAG *g,PebbleConfiguration *const c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-  assert(!ispebbled(v,g,c));
-
-  SETBIT(c->white_pebbled,v);
-  c->pebbles       += 1;
-
-  if (v==g->sinks[0] && !c->sink_touched) {
-    c->sink_touched=TRUE;
-    SETBIT(c->used_pebbles,v);
-  }
-}
-
-#endif /* BLACK_WHITE_PEBBLING */
-
-/* Vertex Statuses */
-
-/* Determines if a vertex is pebbled according to a specific
-   configuration */
-inline Boolean ispebbled(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
-
-#if BLACK_WHITE_PEBBLING
-  return GETBIT(c->white_pebbled | c->black_pebbled,v);
-#else
-  return GETBIT(c->black_pebbled,v);
-#endif
-}
-
+#define NO_PEBBLE     0
+#define BLACK_PEBBLE  1
+#define WHITE_PEBBLE  2
 
 /* Determines if there is a pebble on all predecessors of a given
-   vertex */
-inline Boolean isactive(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(v<g->size);
+   vertex. White pebbles count only in black-white pebbling. */
+static Boolean isactive_status(const DAG *g,const unsigned char *status,Vertex v) {
 
+  for(size_t i=0;i<g->indegree[v];i++) {
 #if BLACK_WHITE_PEBBLING
-  return (((c->white_pebbled | c->black_pebbled) & g->pred_bitmasks[v])
-          == g->pred_bitmasks[v])?TRUE:FALSE;
+    if (status[g->in[v][i]]==NO_PEBBLE) return FALSE;
 #else
-  return ((c->black_pebbled & g->pred_bitmasks[v])
-          == g->pred_bitmasks[v])?TRUE:FALSE;
+    if (status[g->in[v][i]]!=BLACK_PEBBLE) return FALSE;
 #endif
+  }
+  return TRUE;
 }
 
+/* Performs the move on vertex v. The logical sequence of tests ensure
+   correctness of the moves, assuming the pebbling is legal.
 
-inline Boolean isused(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
+   @return TRUE if the move is a deletion, FALSE if it is a placement */
+static Boolean move_status(const DAG *g,unsigned char *status,Vertex v) {
 
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
   assert(v<g->size);
 
-  return GETBIT(c->used_pebbles,v);
-}
-
-/* Persistent pebbling is realized by placing a pebble on top and then
-   by reaching the empty configuration. In both black-white
-   andreversible pebble the actual pebbling is inverted to result in
-   the desired pebbling that ends with a pebble on the sink.  */
-void    init_persistent_pebbling(const DAG *g, PebbleConfiguration *const c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-
-  assert(g->sink_number==1);
-  assert(!ispebbled(g->sinks[0],g,c));
+  /* Deletions */
+  if (status[v]!=NO_PEBBLE) {
 #if REVERSIBLE_PEBBLING
-  SETBIT(c->black_pebbled,g->sinks[0]);
-#elif BLACK_WHITE_PEBBLING
-  SETBIT(c->black_pebbled,g->sinks[0]);
-#else
-  assert(0);
+    assert(isactive_status(g,status,v));
 #endif
-  
-  c->pebbles       += 1;
-  c->sink_touched = TRUE;
-  SETBIT(c->used_pebbles,g->sinks[0]);
-}
-
-
-/* Determines if the configuration is final for a visiting
-   pebbling. In a visiting pebbling we start with an empty
-   configuration an we try to touch the sink. And reach a
-   configuration without white pebbles. */
-inline Boolean isfinal_visiting(const DAG *g,const PebbleConfiguration *c) {
-
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-
 #if BLACK_WHITE_PEBBLING
-  if (c->white_pebbled!=0) return FALSE;
+    assert(status[v]==BLACK_PEBBLE || isactive_status(g,status,v));
 #endif
+    status[v]=NO_PEBBLE;
+    return TRUE;
+  }
 
-  if (c->sink_touched==TRUE) return TRUE;
-  else return FALSE;
-}
-
-/* Determines if the configuration is final for a persistent
-   pebbling. In a persistent pebbling we start with a configuration
-   with a hard to remove pebble on the sink (i.e. makes sense for
-   white and reversible) and we try to reach the configuration with no
-   hard to remove pebbles. */
-inline Boolean isfinal_persistent(const DAG *g,const PebbleConfiguration *c) {
+  /* Placements */
+  if (isactive_status(g,status,v)) {
+    status[v]=BLACK_PEBBLE;
+    return FALSE;
+  }
 
-  assert(isconsistent_DAG(g));
-  assert(isconsistent_PebbleConfiguration(g,c));
-  assert(c->sink_touched);
-  
 #if BLACK_WHITE_PEBBLING
-  if (c->white_pebbled!=0) return FALSE;
-#elif REVERSIBLE_PEBBLING
-  if (c->black_pebbled!=0) return FALSE;
+  status[v]=WHITE_PEBBLE;
 #else
-  assert(FALSE);           /* persistent pebbling makes sense only for reversible and black/white pebblings */
+  assert(FALSE);
 #endif
-
-  return TRUE;
+  return FALSE;
 }
 
-
-
-/* Print a graph with a pebble configuration, with dot.  If the `peb'
-   is NULL it does assume that the pebbling to be printed is empty.
-   */
-void fprint_dot_PebbleConfiguration(FILE *outfile,const DAG *g, const PebbleConfiguration *peb,
-                        char *name,char* options) {
-  assert(isconsistent_DAG(g));
-  assert(peb==NULL || isconsistent_PebbleConfiguration(g,peb));
+/* Print a graph with a pebble configuration, with dot. */
+static void fprint_dot_status(FILE *outfile,const DAG *g,const unsigned char *status,
+                              char *name,char* options) {
 
   char *vertexopts[g->size];
 
   for(Vertex v=0;v<g->size;v++) {
-
-#if BLACK_WHITE_PEBBLING
-    if (peb && iswhite(v,g,peb)) {
+    switch(status[v]) {
+    case WHITE_PEBBLE:
       vertexopts[v]="color=gray,fontcolor=black,fillcolor=white";
-      continue;
-    }
-#endif
-
-    if (peb && isblack(v,g,peb)) {
+      break;
+    case BLACK_PEBBLE:
       vertexopts[v]="color=gray,fontcolor=white,fillcolor=black";
-      continue;
+      break;
+    default:
+      vertexopts[v]="color=gray,fontcolor=black,fillcolor=lightgray";
     }
-
-    vertexopts[v]="color=gray,fontcolor=black,fillcolor=lightgray";
-
   }
   fprint_dot_DAG(outfile,g,name,options,vertexopts);
 }
@@ -492,274 +211,38 @@ void fprint_dot_PebbleConfiguration(FILE *outfile,const DAG *g, const PebbleConf
 /* Print a pebbling, using dot tool */
 void fprint_dot_Pebbling(FILE *outfile,const DAG *g, const Pebbling *ptr) {
 
-  PebbleConfiguration conf;
-  
-  conf.sink_touched=FALSE;
-
-#if BLACK_WHITE_PEBBLING
-  conf.white_pebbled = 0;
-#endif
+  assert(isconsistent_DAG(g));
+  assert(ptr);
 
-  conf.black_pebbled = 0;
-  conf.used_pebbles = 0;
-  conf.pebbles = 0;
-  conf.previous_configuration = NULL;
-  conf.last_changed_vertex = 0;
+  unsigned char *status=(unsigned char*)calloc(g->size,sizeof(unsigned char));
+  assert(status);
 
-  fprint_dot_PebbleConfiguration(outfile,g,NULL,"X",NULL);
-  Vertex v;
+  fprint_dot_status(outfile,g,status,"X",NULL);
   for (size_t i=0; i < ptr->length; ++i) {
-    v=ptr->steps[i];
-    /* The logical sequence of tests ensure correctness of the moves,
-       assuming the pebbling is legal */
-
-    /* Deletions */
-    if (isblack(v,g,&conf)) {
-      deleteblack(v,g,&conf);
-      fprint_dot_PebbleConfiguration(outfile,g,&conf,"X",NULL);
-      continue;
-    }
-
-#if BLACK_WHITE_PEBBLING
-    if (iswhite(v,g,&conf)) {
-      deletewhite(v,g,&conf);
-      fprint_dot_PebbleConfiguration(outfile,g,&conf,"X",NULL);
-      continue;
-    }
-#endif
-
-    /* Placements */
-    if (isactive(v,g,&conf)) {
-      placeblack(v,g,&conf);
-      fprint_dot_PebbleConfiguration(outfile,g,&conf,"X",NULL);
-      continue;
-    }
-    
-#if BLACK_WHITE_PEBBLING        
-    placewhite(v,g,&conf);
-    fprint_dot_PebbleConfiguration(outfile,g,&conf,"X",NULL);
-#endif
+    move_status(g,status,ptr->steps[i]);
+    fprint_dot_status(outfile,g,status,"X",NULL);
   }
+  free(status);
 }
 
-/* Print a pebbling, using dot tool */
+/* Print a pebbling, as a sequence of placements and deletions */
 void fprint_text_Pebbling(FILE *outfile,const DAG *g, const Pebbling *ptr) {
 
-  PebbleConfiguration conf;
-  
-  conf.sink_touched=FALSE;
-#if BLACK_WHITE_PEBBLING
-  conf.white_pebbled = 0;
-#endif
-  conf.black_pebbled = 0;
-  conf.used_pebbles = 0;
-  conf.pebbles = 0;
-  conf.previous_configuration = NULL;
-  conf.last_changed_vertex = 0;
+  assert(isconsistent_DAG(g));
+  assert(ptr);
+
+  unsigned char *status=(unsigned char*)calloc(g->size,sizeof(unsigned char));
+  assert(status);
 
   Vertex v;
   fprintf(outfile,"v");
   for (size_t i=0; i < ptr->length; ++i) {
     v=ptr->steps[i];
-    /* The logical sequence of tests ensure correctness of the moves,
-       assuming the pebbling is legal */
-
-    /* Deletions */
-    if (isblack(v,g,&conf)) {
-      deleteblack(v,g,&conf);
-      fprintf(outfile," -%lu",v+1);
-      continue;
-    }
-
-#if BLACK_WHITE_PEBBLING
-    if (iswhite(v,g,&conf)) {
-      deletewhite(v,g,&conf);
+    if (move_status(g,status,v))
       fprintf(outfile," -%lu",v+1);
-      continue;
-    }
-#endif
-
-    /* Placements */
-    if (isactive(v,g,&conf)) {
-      placeblack(v,g,&conf);
+    else
       fprintf(outfile," %lu",v+1);
-      continue;
-    }
-    
-#if BLACK_WHITE_PEBBLING        
-    placewhite(v,g,&conf);
-    fprintf(outfile," %lu",v+1);
-#endif
   }
-
   fprintf(outfile,"\n");
+  free(status);
 }
-
-
-
-/* Heuristics */
-
-#if BLACK_WHITE_PEBBLING==1
-
-static inline Boolean place_white_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  if (c->previous_configuration==NULL) return FALSE;
-  if (v==c->last_changed_vertex) return TRUE;
-
-  /* Never place two pebbles on vertices with decreasing
-     rank. Notice that successors always have bigger rank.  */
-  if (ispebbled(c->last_changed_vertex,g,c) && (v < c->last_changed_vertex)) return TRUE;
-
-  return FALSE;
-}
-
-#endif
-
-static inline Boolean place_black_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  if (c->previous_configuration==NULL) return FALSE;
-  if (v==c->last_changed_vertex) return TRUE;
-
-  /* Never place two pebbles on vertices with decreasing
-     rank. Notice that successors always have bigger rank.  */
-  if (ispebbled(c->last_changed_vertex,g,c) && (v < c->last_changed_vertex)) return TRUE;
-
-  return FALSE;
-}
-
-
-#if BLACK_WHITE_PEBBLING
-static inline Boolean delete_white_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  if (!isused(v, g, c)) return TRUE;
-
-  Vertex w=c->last_changed_vertex;
-  if (c->previous_configuration==NULL) return FALSE;
-  if (v==w) return TRUE;  /* White pebble can't be placed and removed,
-                             not even of the sink */
-
-  /* Never remove pebbles on vertices with increasing
-     rank. Notice that predecessors always have smaller rank.  */
-  if (!ispebbled(w,g,c) && (v > w)) return TRUE;
-
-  /* If a white pebble removal is after a placement, ... */
-  if (ispebbled(w,g,c)) {
-    /* either the placed pebble is necessary for the removal ... */
-    if (GETBIT(g->pred_bitmasks[v],w)) return FALSE;
-    /* or the white pebble was necessary for the placement ... */
-    if (GETBIT(g->succ_bitmasks[v],w) && isblack(w,g,c)) return FALSE;
-    return TRUE;
-  } else {
-    return FALSE;
-  }
-
-}
-#endif
- 
-static inline Boolean delete_black_heuristics_cut(const Vertex v,const DAG *g,const PebbleConfiguration *c) {
-
-  if (!isused(v, g, c)) return TRUE;
-
-  Vertex w=c->last_changed_vertex;
-  if (c->previous_configuration==NULL) return FALSE;
-  if (v==w) return (g->sinks[0]!=w);    /* A black pebble may be
-                                           placed and then removed iff
-                                           it's on the sink. */
-
-  /* Never remove pebbles on vertices with increasing
-     rank. Notice that predecessors always have smaller rank.  */
-  if (!ispebbled(w,g,c) && (v > w)) return TRUE;
-
-  /* If a black pebble removal is after a placement, then the placed
-     vertex must be a black pebbled successor, unless we are doing a
-     reversible pebbling.
-  */
-#if !REVERSIBLE_PEBBLING
-  if (ispebbled(w,g,c)) {
-    if (!isblack(w,g,c)) return TRUE;
-    if (!GETBIT(g->succ_bitmasks[v],w)) return TRUE;
-  }
-#endif
-  
-  return FALSE;
-}
-
-
-
-/* Each pebble configuration has a number of neightbours less than or
-   equal to the number of vertices.  For each vertex you can either
-   add a pebble (if possible) or remove one (if present).  The
-   possible move is unique for every vertex.
-*/
-PebbleConfiguration *next_PebbleConfiguration(const Vertex v,
-                                              const DAG *g,
-                                              const PebbleConfiguration *old,
-                                              unsigned int max_pebbles) {
-
-  PebbleConfiguration *nconf=NULL;
-
-  assert(isconsistent_PebbleConfiguration(g,old));
-
-#if REVERSIBLE_PEBBLING
-  if ( isblack(v,g,old) && isactive(v,g,old)) {
-#else
-  if ( isblack(v,g,old) ) {
-#endif
-
-    if (delete_black_heuristics_cut(v,g,old)) return NULL;
-
-    /* Delete BLACK */
-    nconf=copy_PebbleConfiguration(old);
-    deleteblack(v,g,nconf);
-
-    assert(isconsistent_PebbleConfiguration(g,nconf));
-    return nconf;
-    }
-
-#if BLACK_WHITE_PEBBLING
-  
-  if ( iswhite(v,g,old) && isactive(v,g,old) ) { /* Delete WHITE */
-
-    if (delete_white_heuristics_cut(v,g,old)) return NULL;
-
-    nconf=copy_PebbleConfiguration(old);
-    deletewhite(v,g,nconf);
-
-    assert(isconsistent_PebbleConfiguration(g,nconf));
-    return nconf;
-  }
-#endif /* BLACK_WHITE_PEBBLING */
-  
-  if ( !ispebbled(v,g,old) && isactive(v,g,old) ) { /* Place BLACK */
-
-    if (old->pebbles >= max_pebbles) return NULL;
-    if (place_black_heuristics_cut(v,g,old)) return NULL;
-
-    nconf=copy_PebbleConfiguration(old);
-
-    placeblack(v,g,nconf);
-
-    assert(isconsistent_PebbleConfiguration(g,nconf));
-    return nconf;
-  }
-
-#if BLACK_WHITE_PEBBLING
-  if ( !ispebbled(v,g,old) && !isactive(v,g,old)) { /* Place WHITE */
-
-    if (old->pebbles >= max_pebbles) return NULL;
-    if (place_white_heuristics_cut(v,g,old)) return NULL;
-
-
-    nconf=copy_PebbleConfiguration(old);
-    placewhite(v,g,nconf);
-
-    assert(isconsistent_PebbleConfiguration(g,nconf));
-    return nconf;
-  }
-#endif /* BLACK_WHITE_PEBBLING */
-
-  /* No operation allowed on the chosen vertex. */
-  return NULL;
-}
-
-
@@ -0,0 +1,540 @@
+/*
+   Description::
+
+   Search for a pebbling within a bound by a SAT solver.
+
+   The configuration at each time t is encoded by a variable for each
+   vertex, true if the vertex has a black pebble (and another one for
+   the white pebble, in black-white pebbling). From each time to the
+   next one at most one vertex changes, by a legal move, and once a
+   step makes no move the next ones make none either. At each time
+   there are at most as many pebbles as the bound, counted by a
+   sequential counter. So the configuration at time T is final if and
+   only if there is a pebbling of at most T steps.
+
+   The formula grows one time at a time, and the final configuration
+   at time T is required by an assumption, so that a single
+   incremental solver (see cdcl.h) answers for all T, keeping what it
+   learns. T doubles until the formula is satisfiable, then the
+   shortest length is found by bisection.
+
+   The configurations do not need the compact representation of the
+   search, so this file is compiled once for each kind of pebbling,
+   for graphs of any size.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "config.h"
+#include "cdcl.h"
+#include "sat.h"
+#include "search.h"
+
+
+/* Code */
+
+typedef struct {
+
+  DAG         *g;
+  SatSolver   *S;
+  unsigned int upper_bound;
+  Boolean      persistent_pebbling;
+
+  size_t       frames;          /* Times encoded so far */
+  size_t       capacity;
+
+  /* Variables at each time. The ones of the vertices are consecutive,
+     from the first one given here. */
+  int         *black;           /* Black pebble on the vertex */
+  int         *white;           /* White pebble on the vertex */
+  int         *empty;           /* No pebble on the vertex (if true) */
+  int         *touched;         /* The sink has been pebbled */
+  int         *change;          /* Move on the vertex, in the step to this time */
+  int         *below;           /* Move on the vertex or on a smaller one, same step */
+  int         *placement;       /* The step to this time places a pebble */
+  int         *removal;         /* The step to this time removes a pebble */
+  int         *final;           /* The configuration is final */
+
+} SatEncoding;
+
+#define BLACK(e,t,v) ((e)->black[(t)]+(int)(v))
+#define WHITE(e,t,v) ((e)->white[(t)]+(int)(v))
+#define EMPTY(e,t,v) ((e)->empty[(t)]+(int)(v))
+#define CHANGE(e,t,v) ((e)->change[(t)]+(int)(v))
+#define BELOW(e,t,v)  ((e)->below[(t)]+(int)(v))
+#define MOVED(e,t)    BELOW((e),(t),(e)->g->size-1)
+
+#if BLACK_WHITE_PEBBLING
+#define PEBBLED(e,t,v) (-EMPTY((e),(t),(v)))
+#else
+#define PEBBLED(e,t,v) BLACK((e),(t),(v))
+#endif
+
+
+static inline void clause1(SatEncoding *e,int a) {
+  addclause_SatSolver(e->S,&a,1);
+}
+
+static inline void clause2(SatEncoding *e,int a,int b) {
+  int c[2]={a,b};
+  addclause_SatSolver(e->S,c,2);
+}
+
+static inline void clause3(SatEncoding *e,int a,int b,int c) {
+  int d[3]={a,b,c};
+  addclause_SatSolver(e->S,d,3);
+}
+
+static inline void clause4(SatEncoding *e,int a,int b,int c,int d) {
+  int f[4]={a,b,c,d};
+  addclause_SatSolver(e->S,f,4);
+}
+
+/* New consecutive variables, @return the first one */
+static int newvars(SatEncoding *e,size_t n) {
+  int first=newvar_SatSolver(e->S);
+  for(size_t i=1;i<n;i++) newvar_SatSolver(e->S);
+  return first;
+}
+
+
+/* At most k of the m literals in x are true (sequential counter) */
+static void atmost(SatEncoding *e,const int *x,size_t m,unsigned int k) {
+
+  if (k>=m) return;
+  if (k==0) {
+    for(size_t i=0;i<m;i++) clause1(e,-x[i]);
+    return;
+  }
+
+  /* s(i,j): at least j+1 of the first i+1 literals are true */
+  int prev=0,s=0;
+  for(size_t i=0;i+1<m;i++) {
+    s=newvars(e,k);
+    clause2(e,-x[i],s);
+    if (i==0) {
+      for(unsigned int j=1;j<k;j++) clause1(e,-(s+(int)j));
+    } else {
+      clause2(e,-prev,s);
+      for(unsigned int j=1;j<k;j++) {
+        clause3(e,-x[i],-(prev+(int)j-1),s+(int)j);
+        clause2(e,-(prev+(int)j),s+(int)j);
+      }
+      clause2(e,-x[i],-(prev+(int)k-1));
+    }
+    prev=s;
+  }
+  clause2(e,-x[m-1],-(prev+(int)k-1));
+}
+
+
+/* The moves from time t-1 to time t */
+static void add_step(SatEncoding *e,size_t t) {
+
+  const DAG *g=e->g;
+  size_t p=t-1;
+  int *lits=(int*)malloc((g->size+4)*sizeof(int));
+  assert(lits);
+
+  e->change[t]=newvars(e,g->size);
+  e->below[t]=newvars(e,g->size);
+  e->placement[t]=newvar_SatSolver(e->S);
+  e->removal[t]=newvar_SatSolver(e->S);
+
+  for(Vertex v=0;v<g->size;v++) {
+
+    int c=CHANGE(e,t,v);
+
+#if BLACK_WHITE_PEBBLING
+    /* A change adds or removes a pebble, never switches its color */
+    int d[5]={-c,BLACK(e,p,v),BLACK(e,t,v),WHITE(e,p,v),WHITE(e,t,v)};
+    addclause_SatSolver(e->S,d,5);
+    clause3(e,-c,-BLACK(e,p,v),-BLACK(e,t,v));
+    clause3(e,-c,-WHITE(e,p,v),-WHITE(e,t,v));
+    clause2(e,-BLACK(e,p,v),-WHITE(e,t,v));
+    clause2(e,-WHITE(e,p,v),-BLACK(e,t,v));
+    clause3(e,c,-WHITE(e,p,v),WHITE(e,t,v));
+    clause3(e,c,WHITE(e,p,v),-WHITE(e,t,v));
+#else
+    clause3(e,-c,BLACK(e,p,v),BLACK(e,t,v));
+    clause3(e,-c,-BLACK(e,p,v),-BLACK(e,t,v));
+#endif
+    clause3(e,c,-BLACK(e,p,v),BLACK(e,t,v));
+    clause3(e,c,BLACK(e,p,v),-BLACK(e,t,v));
+
+    /* Rules of the game */
+    for(size_t i=0;i<g->indegree[v];i++) {
+      Vertex u=g->in[v][i];
+#if BLACK_WHITE_PEBBLING
+      clause4(e,BLACK(e,p,v),-BLACK(e,t,v),BLACK(e,p,u),WHITE(e,p,u));
+      clause4(e,-WHITE(e,p,v),WHITE(e,t,v),BLACK(e,p,u),WHITE(e,p,u));
+#elif REVERSIBLE_PEBBLING
+      clause2(e,-c,BLACK(e,p,u));
+#else
+      clause3(e,BLACK(e,p,v),-BLACK(e,t,v),BLACK(e,p,u));
+#endif
+    }
+
+#if BLACK_WHITE_PEBBLING
+    /* A white pebble goes only where a black one can't (see
+       fprint_text_Pebbling) */
+    size_t n=0;
+    lits[n++]=WHITE(e,p,v);
+    lits[n++]=-WHITE(e,t,v);
+    for(size_t i=0;i<g->indegree[v];i++) lits[n++]=EMPTY(e,p,g->in[v][i]);
+    addclause_SatSolver(e->S,lits,n);
+#endif
+
+    /* Kind of the move */
+    clause3(e,-c,-PEBBLED(e,t,v),e->placement[t]);
+    clause3(e,-c,PEBBLED(e,t,v),e->removal[t]);
+  }
+
+  /* At most one move, and no move after a step without one */
+  for(Vertex v=0;v<g->size;v++) {
+    clause2(e,-CHANGE(e,t,v),BELOW(e,t,v));
+    if (v>0) {
+      clause2(e,-BELOW(e,t,v-1),BELOW(e,t,v));
+      clause2(e,-BELOW(e,t,v-1),-CHANGE(e,t,v));
+    }
+  }
+  for(Vertex v=0;v<g->size;v++) lits[v]=CHANGE(e,t,v);
+  lits[g->size]=-MOVED(e,t);
+  addclause_SatSolver(e->S,lits,g->size+1);
+  clause2(e,-e->placement[t],-e->removal[t]);
+  clause2(e,-e->placement[t],MOVED(e,t));
+  clause2(e,-e->removal[t],MOVED(e,t));
+  if (t>1) clause2(e,-MOVED(e,t),MOVED(e,t-1));
+
+  /* Two consecutive moves on vertices which are not adjacent commute,
+     so only one order is allowed: the removals before the placements,
+     the removals from the largest vertex, the placements from the
+     smallest one (as in the heuristics of the breadth-first search).
+     The other order never needs fewer pebbles. A move is not undone
+     by the next one either, but for touching the sink. In the other
+     games these clauses make the solver slower. */
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  for(Vertex u=0; t>1 && u<g->size; u++) {
+
+    size_t n;
+
+    /* Placement on u, then a placement on a smaller vertex */
+    if (u>0) {
+      n=0;
+      lits[n++]=-CHANGE(e,p,u);
+      lits[n++]=-PEBBLED(e,p,u);
+      lits[n++]=-BELOW(e,t,u-1);
+      lits[n++]=-e->placement[t];
+      for(size_t i=0;i<g->indegree[u];i++) if (g->in[u][i]<u) lits[n++]=CHANGE(e,t,g->in[u][i]);
+      for(size_t i=0;i<g->outdegree[u];i++) if (g->out[u][i]<u) lits[n++]=CHANGE(e,t,g->out[u][i]);
+      addclause_SatSolver(e->S,lits,n);
+    }
+
+    /* Placement on u, then a removal (from u only if it is the sink
+       to be touched) */
+    n=0;
+    lits[n++]=-CHANGE(e,p,u);
+    lits[n++]=-PEBBLED(e,p,u);
+    lits[n++]=-e->removal[t];
+    if (!e->persistent_pebbling && u==g->sinks[0]) lits[n++]=CHANGE(e,t,u);
+    for(size_t i=0;i<g->indegree[u];i++) lits[n++]=CHANGE(e,t,g->in[u][i]);
+    for(size_t i=0;i<g->outdegree[u];i++) lits[n++]=CHANGE(e,t,g->out[u][i]);
+    addclause_SatSolver(e->S,lits,n);
+
+    /* Removal from u, then a removal from a larger vertex */
+    n=0;
+    lits[n++]=-CHANGE(e,p,u);
+    lits[n++]=PEBBLED(e,p,u);
+    lits[n++]=-e->removal[t];
+    lits[n++]=BELOW(e,t,u);
+    for(size_t i=0;i<g->indegree[u];i++) if (g->in[u][i]>u) lits[n++]=CHANGE(e,t,g->in[u][i]);
+    for(size_t i=0;i<g->outdegree[u];i++) if (g->out[u][i]>u) lits[n++]=CHANGE(e,t,g->out[u][i]);
+    addclause_SatSolver(e->S,lits,n);
+
+    /* Removal from u, then a placement on u */
+    clause3(e,-CHANGE(e,p,u),PEBBLED(e,p,u),-CHANGE(e,t,u));
+  }
+#endif
+
+  /* Sink touched */
+  if (!e->persistent_pebbling) {
+    Vertex z=g->sinks[0];
+#if BLACK_WHITE_PEBBLING
+    clause4(e,-e->touched[t],e->touched[p],BLACK(e,t,z),WHITE(e,t,z));
+#else
+    clause3(e,-e->touched[t],e->touched[p],BLACK(e,t,z));
+#endif
+  }
+
+  free(lits);
+}
+
+
+/* Encode the configuration at the next time */
+static void add_frame(SatEncoding *e) {
+
+  const DAG *g=e->g;
+
+  if (e->frames==e->capacity) {
+    e->capacity = e->capacity ? 2*e->capacity : 64;
+    e->black   = (int*)realloc(e->black,e->capacity*sizeof(int));
+    e->white   = (int*)realloc(e->white,e->capacity*sizeof(int));
+    e->empty   = (int*)realloc(e->empty,e->capacity*sizeof(int));
+    e->touched = (int*)realloc(e->touched,e->capacity*sizeof(int));
+    e->final   = (int*)realloc(e->final,e->capacity*sizeof(int));
+    e->change  = (int*)realloc(e->change,e->capacity*sizeof(int));
+    e->below   = (int*)realloc(e->below,e->capacity*sizeof(int));
+    e->placement = (int*)realloc(e->placement,e->capacity*sizeof(int));
+    e->removal = (int*)realloc(e->removal,e->capacity*sizeof(int));
+    assert(e->black && e->white && e->empty && e->touched && e->final);
+    assert(e->change && e->below && e->placement && e->removal);
+  }
+  size_t t=e->frames++;
+
+  e->black[t]=newvars(e,g->size);
+#if BLACK_WHITE_PEBBLING
+  e->white[t]=newvars(e,g->size);
+  e->empty[t]=newvars(e,g->size);
+  for(Vertex v=0;v<g->size;v++) {
+    clause2(e,-BLACK(e,t,v),-WHITE(e,t,v));
+    clause2(e,-EMPTY(e,t,v),-BLACK(e,t,v));
+    clause2(e,-EMPTY(e,t,v),-WHITE(e,t,v));
+    clause3(e,EMPTY(e,t,v),BLACK(e,t,v),WHITE(e,t,v));
+  }
+#endif
+  e->touched[t] = e->persistent_pebbling ? 0 : newvar_SatSolver(e->S);
+  e->final[t]   = newvar_SatSolver(e->S);
+
+  /* At most upper_bound pebbles */
+  size_t m=0;
+  int *x=(int*)malloc(2*g->size*sizeof(int));
+  assert(x);
+  for(Vertex v=0;v<g->size;v++) {
+    x[m++]=BLACK(e,t,v);
+#if BLACK_WHITE_PEBBLING
+    x[m++]=WHITE(e,t,v);
+#endif
+  }
+  atmost(e,x,m,e->upper_bound);
+  free(x);
+
+  /* The pebbling starts from the empty configuration */
+  if (t==0) {
+    for(Vertex v=0;v<g->size;v++) {
+      clause1(e,-BLACK(e,0,v));
+#if BLACK_WHITE_PEBBLING
+      clause1(e,-WHITE(e,0,v));
+#endif
+    }
+    if (!e->persistent_pebbling) clause1(e,-e->touched[0]);
+  } else {
+    add_step(e,t);
+  }
+
+  /* Final configuration: empty after touching the sink, or with a
+     single black pebble on the sink */
+  int a=e->final[t];
+  Vertex z=g->sinks[0];
+  for(Vertex v=0;v<g->size;v++) {
+    if (e->persistent_pebbling && v==z) clause2(e,-a,BLACK(e,t,v));
+    else clause2(e,-a,-BLACK(e,t,v));
+#if BLACK_WHITE_PEBBLING
+    clause2(e,-a,-WHITE(e,t,v));
+#endif
+  }
+  if (!e->persistent_pebbling) clause2(e,-a,e->touched[t]);
+}
+
+
+static SatEncoding *new_SatEncoding(DAG *g,unsigned int upper_bound,Boolean persistent_pebbling) {
+
+  check_single_sink(g);
+
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  persistent_pebbling = FALSE;
+#endif
+
+  SatEncoding *e=(SatEncoding*)calloc(1,sizeof(SatEncoding));
+  assert(e);
+  e->g = g;
+  e->S = new_SatSolver();
+  e->upper_bound = upper_bound;
+  e->persistent_pebbling = persistent_pebbling;
+  add_frame(e);
+  return e;
+}
+
+static void dispose_SatEncoding(SatEncoding *e) {
+  dispose_SatSolver(e->S);
+  free(e->black);
+  free(e->white);
+  free(e->empty);
+  free(e->touched);
+  free(e->change);
+  free(e->below);
+  free(e->placement);
+  free(e->removal);
+  free(e->final);
+  free(e);
+}
+
+
+/* Is there a pebbling of at most `length' steps? A negative answer
+   is added to the formula. A positive one sets `length' to the time
+   of the final configuration in the assignment. */
+static Boolean solve_SatEncoding(SatEncoding *e,size_t *length) {
+
+  size_t T=*length;
+
+  /* Each pebble placed is removed, but the one on the sink in a
+     persistent pebbling: the parity of the length is known. */
+  if ((T % 2) != (e->persistent_pebbling ? 1 : 0)) {
+    if (T==0) return FALSE;
+    T--;
+  }
+
+  while (e->frames <= T) add_frame(e);
+
+  int a=e->final[T];
+  if (solve_SatSolver(e->S,&a,1)) { *length=T; return TRUE; }
+  clause1(e,-a);
+  return FALSE;
+}
+
+
+/* The pebbling in the assignment found for `length' steps */
+static Pebbling *decode_SatEncoding(const SatEncoding *e,size_t length) {
+
+  const DAG *g=e->g;
+  Vertex *steps=(Vertex*)malloc(length*sizeof(Vertex));
+  assert(steps);
+  size_t n=0;
+  int pebbles=0,cost=0;
+
+  for(size_t t=1;t<=length;t++) {
+    for(Vertex v=0;v<g->size;v++) {
+      Boolean before=value_SatSolver(e->S,BLACK(e,t-1,v));
+      Boolean after =value_SatSolver(e->S,BLACK(e,t,v));
+#if BLACK_WHITE_PEBBLING
+      before = before || value_SatSolver(e->S,WHITE(e,t-1,v));
+      after  = after  || value_SatSolver(e->S,WHITE(e,t,v));
+#endif
+      if (before==after) continue;
+      steps[n++]=v;
+      pebbles += after ? 1 : -1;
+      cost = MAX(cost,pebbles);
+      break;
+    }
+  }
+
+  assert(n>0);
+  Pebbling *solution=new_Pebbling(n);
+  solution->length = n;
+  solution->cost   = cost;
+  for(size_t i=0;i<n;i++) solution->steps[i]=steps[i];
+  free(steps);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with a SAT solver. The pebbling found
+   is a shortest one within the bound, counting all its moves (the
+   one of bfs_pebbling_strategy is the shortest before the clean up).
+   Only the pebblings of at most `max_length' steps are considered.
+
+   @param refuted set to TRUE if there is no pebbling of any length
+   within the bound, to FALSE if there may be a longer one.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *sat_pebbling_strategy(DAG *g,
+                                unsigned int upper_bound,
+                                Boolean persistent_pebbling,
+                                size_t max_length,
+                                Boolean *refuted) {
+
+  assert(max_length>0);
+  assert(refuted);
+
+  *refuted=TRUE;
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  SatEncoding *e=new_SatEncoding(g,upper_bound,persistent_pebbling);
+  Pebbling *solution=NULL;
+  size_t L;
+
+  /* There is no pebbling this short: every vertex is an ancestor of
+     the sink, so it is pebbled and then cleared, but the sink of a
+     persistent pebbling. The shorter lengths are not tried, their
+     formulas are unsatisfiable for counting reasons, which are very
+     hard for the solver. */
+  size_t shorter=2*g->size - (e->persistent_pebbling ? 2 : 1);
+
+  for(size_t T=shorter+1; T<=max_length; T = (2*T < max_length) ? 2*T : max_length) {
+    L=T;
+    if (solve_SatEncoding(e,&L)) { solution=decode_SatEncoding(e,L); break; }
+    shorter=T;
+    if (T==max_length) break;
+  }
+
+  while (solution && shorter+1 < solution->length) {
+    L=(shorter+solution->length)/2;
+    size_t T=L;
+    if (solve_SatEncoding(e,&L)) {
+      dispose_Pebbling(solution);
+      solution=decode_SatEncoding(e,L);
+    } else {
+      shorter=T;
+    }
+  }
+
+  /* A shortest pebbling never visits a configuration twice, so the
+     search is complete if the length reaches their number */
+  if (!solution) {
+    size_t configurations=estimate_configurations(g,upper_bound);
+    *refuted = (configurations!=SIZE_MAX && configurations <= max_length+1);
+  }
+
+  dispose_SatEncoding(e);
+  return solution;
+}
+
+
+/**
+   Print the formula for a pebbling within the bound of at most
+   `length' steps, in DIMACS format. The comments give the variables
+   of the pebbles at each time.
+*/
+void fprint_dimacs_pebbling(FILE *outfile,
+                            DAG *g,
+                            unsigned int upper_bound,
+                            Boolean persistent_pebbling,
+                            size_t length) {
+
+  SatEncoding *e=new_SatEncoding(g,upper_bound,persistent_pebbling);
+  while (e->frames <= length) add_frame(e);
+
+  fprintf(outfile,"c %s%s of %lu vertices, with at most %u pebbles and %lu steps\n",
+          e->persistent_pebbling ? "persistent " : "",
+          pebbling_type(),(unsigned long)g->size,upper_bound,(unsigned long)length);
+  fprintf(outfile,"c the pebble on vertex v (from 1) at time t is variable x+v-1,\n");
+  fprintf(outfile,"c with x given below for each time\n");
+  for(size_t t=0;t<=length;t++) {
+#if BLACK_WHITE_PEBBLING
+    fprintf(outfile,"c time %lu: black %d, white %d\n",(unsigned long)t,e->black[t],e->white[t]);
+#else
+    fprintf(outfile,"c time %lu: black %d\n",(unsigned long)t,e->black[t]);
+#endif
+  }
+
+  fprint_dimacs_SatSolver(outfile,e->S,&e->final[length],1);
+  dispose_SatEncoding(e);
+}
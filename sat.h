@@ -0,0 +1,40 @@
+/*
+   Description::
+
+   Search for a pebbling within a bound by a SAT solver: the pebbling
+   of at most T steps is encoded in conjunctive normal form, and T
+   grows until the formula is satisfiable.
+
+*/
+
+
+/* Preamble */
+#ifndef  SAT_H
+#define  SAT_H
+
+#include <stdio.h>
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+/* The default cap on the length of the pebbling is this number of
+   steps per vertex of the graph */
+#define SAT_DEFAULT_STEPS_PER_VERTEX 8
+
+extern Pebbling* sat_pebbling_strategy(DAG *digraph,
+                                       unsigned int upper_bound,
+                                       Boolean persistent_pebbling,
+                                       size_t max_length,
+                                       Boolean *refuted);
+
+/* Print the formula for a pebbling of at most `length' steps */
+extern void fprint_dimacs_pebbling(FILE *outfile,
+                                   DAG *digraph,
+                                   unsigned int upper_bound,
+                                   Boolean persistent_pebbling,
+                                   size_t length);
+
+#endif /* SAT_H */
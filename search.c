@@ -0,0 +1,434 @@
+/*
+   Description::
+
+   Choice of the build of the search procedure. The search is
+   compiled once for each width of the pebble configurations (see
+   bittuple.h), and the narrowest one which fits the graph is used:
+   small graphs get smaller configurations and records, and thus
+   smaller queues and dictionaries.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "bfs.h"
+#include "dfs.h"
+#include "bidir.h"
+#include "frontier.h"
+#include "search.h"
+
+#ifndef WIDE_WORDS
+#define WIDE_WORDS 4
+#endif
+
+/* Code */
+
+/* Largest graph handled by the widest build */
+#define MAX_SEARCH_SIZE (WIDE_WORDS*BITWORD_SIZE)
+
+static void graph_too_big(void) {
+  fprintf(stderr,
+          "Error in search procedure: the graph is too "
+          "big for the optimized data structures "
+          "(at most %lu vertices, rebuild with a larger WIDE_WORDS).",
+          (unsigned long)MAX_SEARCH_SIZE);
+  exit(EXIT_FAILURE);
+}
+
+/**
+   Stops the program with an error unless the graph has a single
+   sink, which is the vertex pebbled by the search procedures.
+
+   @param g the graph to be pebbled
+*/
+void check_single_sink(const DAG *g) {
+  if (g->sink_number!=1) {
+    fprintf(stderr,
+            "Error in search procedure: the graph has more than "
+            "one sink vertex.");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/* Check the graph `g', then return the result of the build of
+   `strategy' for its size, called on `g' and the other arguments. */
+#define SEARCH_BY_WIDTH(strategy,g,...)                                      \
+  do {                                                                       \
+    check_single_sink(g);                                                    \
+    if ((g)->size <= 16) return strategy##_w16(g,__VA_ARGS__);               \
+    if ((g)->size <= 32) return strategy##_w32(g,__VA_ARGS__);               \
+    if ((g)->size <= 64) return strategy##_w64(g,__VA_ARGS__);               \
+    if ((g)->size <= MAX_SEARCH_SIZE) return strategy##_wide(g,__VA_ARGS__); \
+    graph_too_big();                                                         \
+    return NULL;                                                             \
+  } while(0)
+
+
+Pebbling *bfs_pebbling_strategy(DAG *g,
+                                unsigned int upper_bound,
+                                Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(bfs_pebbling_strategy,g,upper_bound,persistent_pebbling);
+}
+
+
+Pebbling *parallel_bfs_pebbling_strategy(DAG *g,
+                                         unsigned int upper_bound,
+                                         Boolean persistent_pebbling,
+                                         unsigned int threads) {
+
+  SEARCH_BY_WIDTH(parallel_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling,threads);
+}
+
+
+Pebbling *cancellable_bfs_pebbling_strategy(DAG *g,
+                                            unsigned int upper_bound,
+                                            Boolean persistent_pebbling,
+                                            const int *cancel) {
+
+  SEARCH_BY_WIDTH(cancellable_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling,cancel);
+}
+
+
+Pebbling *external_bfs_pebbling_strategy(DAG *g,
+                                         unsigned int upper_bound,
+                                         Boolean persistent_pebbling,
+                                         const char *directory,
+                                         size_t memory_bytes) {
+
+  SEARCH_BY_WIDTH(external_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling,
+                  directory,memory_bytes);
+}
+
+
+Pebbling *symmetric_bfs_pebbling_strategy(DAG *g,
+                                          unsigned int upper_bound,
+                                          Boolean persistent_pebbling,
+                                          const Vertex *generators,
+                                          size_t generator_number) {
+
+  SEARCH_BY_WIDTH(symmetric_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling,
+                  generators,generator_number);
+}
+
+
+Pebbling *reduced_bfs_pebbling_strategy(DAG *g,
+                                        unsigned int upper_bound,
+                                        Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(reduced_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling);
+}
+
+
+Pebbling *zdd_bfs_pebbling_strategy(DAG *g,
+                                    unsigned int upper_bound,
+                                    Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(zdd_bfs_pebbling_strategy,g,upper_bound,persistent_pebbling);
+}
+
+
+Pebbling *minimax_pebbling_strategy(DAG *g,
+                                    unsigned int min_bound,
+                                    unsigned int max_bound,
+                                    Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(minimax_pebbling_strategy,g,min_bound,max_bound,persistent_pebbling);
+}
+
+
+Pebbling *dfs_pebbling_strategy(DAG *g,
+                                unsigned int upper_bound,
+                                Boolean persistent_pebbling,
+                                unsigned int threads,
+                                size_t table_bytes) {
+
+  SEARCH_BY_WIDTH(dfs_pebbling_strategy,g,upper_bound,persistent_pebbling,
+                  threads,table_bytes);
+}
+
+
+Pebbling *bidirectional_pebbling_strategy(DAG *g,
+                                          unsigned int upper_bound,
+                                          Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(bidirectional_pebbling_strategy,g,upper_bound,persistent_pebbling);
+}
+
+
+Pebbling *frontier_pebbling_strategy(DAG *g,
+                                     unsigned int upper_bound,
+                                     Boolean persistent_pebbling) {
+
+  SEARCH_BY_WIDTH(frontier_pebbling_strategy,g,upper_bound,persistent_pebbling);
+}
+
+
+/* The resumable search keeps the state of the build chosen for the
+   graph, together with its functions. */
+struct _ResumableSearch {
+
+  void *state;
+
+  Pebbling* (*resume)(void *search,unsigned int upper_bound);
+  void      (*dispose)(void *search);
+
+};
+
+ResumableSearch *new_ResumableSearch(DAG *g,
+                                     unsigned int max_bound,
+                                     Boolean persistent_pebbling) {
+
+  ResumableSearch *s=(ResumableSearch*)malloc(sizeof(ResumableSearch));
+  assert(s);
+
+  check_single_sink(g);
+  if (g->size <= 16) {
+    s->state   = new_bfs_search_w16(g,max_bound,persistent_pebbling);
+    s->resume  = resume_bfs_search_w16;
+    s->dispose = dispose_bfs_search_w16;
+  } else if (g->size <= 32) {
+    s->state   = new_bfs_search_w32(g,max_bound,persistent_pebbling);
+    s->resume  = resume_bfs_search_w32;
+    s->dispose = dispose_bfs_search_w32;
+  } else if (g->size <= 64) {
+    s->state   = new_bfs_search_w64(g,max_bound,persistent_pebbling);
+    s->resume  = resume_bfs_search_w64;
+    s->dispose = dispose_bfs_search_w64;
+  } else if (g->size <= MAX_SEARCH_SIZE) {
+    s->state   = new_bfs_search_wide(g,max_bound,persistent_pebbling);
+    s->resume  = resume_bfs_search_wide;
+    s->dispose = dispose_bfs_search_wide;
+  } else {
+    graph_too_big();
+  }
+  return s;
+}
+
+Pebbling *resume_ResumableSearch(ResumableSearch *s,unsigned int upper_bound) {
+  assert(s);
+  return s->resume(s->state,upper_bound);
+}
+
+void dispose_ResumableSearch(ResumableSearch *s) {
+  assert(s);
+  s->dispose(s->state);
+  free(s);
+}
+
+
+/* Concurrent bisection of the cost
+
+   Each probe is a breadth-first search with a given bound, running
+   in its own thread. A probe which finds a pebbling tells that its
+   cost is feasible, and that is usually below the bound of the
+   probe. A probe which fails tells that all smaller bounds are
+   infeasible as well. The probes which become useless are cancelled.
+
+   Until a pebbling is found the bounds are probed at exponentially
+   increasing distances from the first one, afterwards the probes
+   split the interval of costs still undecided.
+*/
+#define PROBE_IDLE     0
+#define PROBE_RUNNING  1
+#define PROBE_DONE     2
+
+typedef struct {
+
+  unsigned int bound;
+  int          state;
+  int          cancel;     /* Set by the coordinator, read by the probe */
+  Pebbling    *solution;
+  pthread_t    thread;
+
+  /* Shared with the coordinator */
+  DAG             *g;
+  Boolean          persistent_pebbling;
+  pthread_mutex_t *lock;
+  pthread_cond_t  *done;
+
+} Probe;
+
+static void *run_Probe(void *arg) {
+
+  Probe *p=(Probe*)arg;
+  Pebbling *solution=cancellable_bfs_pebbling_strategy(p->g,p->bound,
+                                                       p->persistent_pebbling,
+                                                       &p->cancel);
+  pthread_mutex_lock(p->lock);
+  p->solution = solution;
+  p->state    = PROBE_DONE;
+  pthread_cond_signal(p->done);
+  pthread_mutex_unlock(p->lock);
+  return NULL;
+}
+
+/* Whether some probe is running with the given bound */
+static Boolean isprobed(const Probe *probes,unsigned int n,unsigned int bound) {
+  for(unsigned int i=0;i<n;i++) {
+    if (probes[i].state!=PROBE_IDLE && probes[i].bound==bound) return TRUE;
+  }
+  return FALSE;
+}
+
+/* The next bound to be probed, or zero if the undecided costs from
+   `low' to `high'-1 are all being probed. Before any pebbling is
+   found, the probes gallop from `start' up to `top'. */
+static unsigned int next_probe(const Probe *probes,unsigned int n,
+                               unsigned int start,unsigned int top,
+                               unsigned int low,unsigned int high,
+                               Boolean gallop) {
+
+  unsigned int best=0,bestgap=0;
+
+  if (gallop) {
+    if (top>=high) top=high-1;
+    /* Bounds start, start+1, start+3, start+7, ... */
+    for(unsigned int step=1; ; step*=2) {
+      unsigned int b=start+step-1;
+      if (b>=top) b=top;
+      if (b>=low && !isprobed(probes,n,b)) return b;
+      if (b==top) return 0;
+    }
+  }
+
+  /* Middle of the largest interval of costs without probes */
+  unsigned int prev=low-1;
+  for(unsigned int b=low; b<=high; b++) {
+    if (b<high && !isprobed(probes,n,b)) continue;
+    if (b-prev-1 > bestgap) { bestgap=b-prev-1; best=prev+1+(b-prev-1)/2; }
+    prev=b;
+  }
+  return best;
+}
+
+/**
+ * Find a pebbling of minimum cost by probing several bounds
+ * concurrently.
+ *
+ * A probe with bound B gives the shortest pebbling with at most B
+ * pebbles, and if such pebbling has cost C then it is also the
+ * shortest with at most C pebbles. Hence the pebbling returned is
+ * the same one found by a search with the minimum cost as bound.
+ *
+ * @param min_bound a lower bound on the cost
+ * @param max_bound the maximum number of pebbles
+ * @param feasible_bound a cost known to be feasible, or zero. The
+ * probes never go above it, since the ones above the minimum cost
+ * are usually the most expensive.
+ * @param threads the number of concurrent probes
+ *
+ * @return a pebbling of minimum cost if exists, NULL otherwise.
+ */
+Pebbling *bisect_pebbling_strategy(DAG *g,
+                                   unsigned int min_bound,
+                                   unsigned int max_bound,
+                                   unsigned int feasible_bound,
+                                   Boolean persistent_pebbling,
+                                   unsigned int threads) {
+
+  assert(threads>0);
+
+  pthread_mutex_t lock;
+  pthread_cond_t  done;
+  pthread_mutex_init(&lock,NULL);
+  pthread_cond_init(&done,NULL);
+
+  Probe *probes=(Probe*)malloc(threads*sizeof(Probe));
+  assert(probes);
+  for(unsigned int i=0;i<threads;i++) {
+    probes[i].state = PROBE_IDLE;
+    probes[i].g     = g;
+    probes[i].persistent_pebbling = persistent_pebbling;
+    probes[i].lock  = &lock;
+    probes[i].done  = &done;
+  }
+
+  /* Costs below `low' are infeasible, `high' is the smallest feasible
+     cost known so far (or max_bound+1 if none). */
+  unsigned int start= (min_bound<1) ? 1 : min_bound;
+  unsigned int top  = (feasible_bound>0 && feasible_bound<max_bound) ? feasible_bound : max_bound;
+  unsigned int low  = start;
+  unsigned int high = max_bound+1;
+  Pebbling    *best = NULL;
+  unsigned int b;
+  Probe       *p;
+
+  pthread_mutex_lock(&lock);
+  while(low < high) {
+
+    /* Fill the idle threads with new probes */
+    for(unsigned int i=0;i<threads;i++) {
+      p=&probes[i];
+      if (p->state!=PROBE_IDLE) continue;
+      b=next_probe(probes,threads,start,top,low,high,best==NULL);
+      if (b==0) break;
+      p->bound    = b;
+      p->state    = PROBE_RUNNING;
+      p->cancel   = 0;
+      p->solution = NULL;
+      if (pthread_create(&p->thread,NULL,run_Probe,p)!=0) {
+        fprintf(stderr,"Error in search procedure: unable to start a thread.");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    /* Wait for some results */
+    for(;;) {
+      unsigned int i=0;
+      while(i<threads && probes[i].state!=PROBE_DONE) i++;
+      if (i<threads) break;
+      pthread_cond_wait(&done,&lock);
+    }
+
+    for(unsigned int i=0;i<threads;i++) {
+      p=&probes[i];
+      if (p->state!=PROBE_DONE) continue;
+      pthread_join(p->thread,NULL);
+      p->state=PROBE_IDLE;
+
+      if (p->solution && p->solution->cost < high) {
+        high=p->solution->cost;
+        if (best) dispose_Pebbling(best);
+        best=p->solution;
+      } else if (p->solution) {
+        dispose_Pebbling(p->solution);
+      } else if (!ATOMIC_LOAD(&p->cancel) && p->bound >= low) {
+        low=p->bound+1;
+      }
+    }
+
+    /* Cancel the probes which can't tell anything new */
+    for(unsigned int i=0;i<threads;i++) {
+      p=&probes[i];
+      if (p->state==PROBE_RUNNING && (p->bound < low || p->bound >= high))
+        ATOMIC_STORE(&p->cancel,1);
+    }
+  }
+
+  /* Stop the probes still running */
+  for(unsigned int i=0;i<threads;i++) {
+    p=&probes[i];
+    if (p->state==PROBE_IDLE) continue;
+    ATOMIC_STORE(&p->cancel,1);
+    pthread_mutex_unlock(&lock);
+    pthread_join(p->thread,NULL);
+    pthread_mutex_lock(&lock);
+    if (p->solution) dispose_Pebbling(p->solution);
+  }
+  pthread_mutex_unlock(&lock);
+
+  free(probes);
+  pthread_cond_destroy(&done);
+  pthread_mutex_destroy(&lock);
+
+  assert(best==NULL || best->cost==high);
+  return best;
+}
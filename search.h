@@ -0,0 +1,47 @@
+/*
+   Description::
+
+   Search procedures which do not depend on the representation of
+   the configurations: they choose the build for the size of the
+   graph.
+
+*/
+
+
+/* Preamble */
+#ifndef  SEARCH_H
+#define  SEARCH_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "bfs.h"
+
+
+/* Code */
+
+/* Exit with an error if the graph has more than one sink: every
+   search procedure pebbles the single sink of the graph. */
+extern void check_single_sink(const DAG *g);
+
+/* A breadth-first search which can be resumed with larger bounds on
+   the number of pebbles, without exploring again the configurations
+   already visited. */
+typedef struct _ResumableSearch ResumableSearch;
+
+extern ResumableSearch* new_ResumableSearch(DAG *digraph,
+                                            unsigned int max_bound,
+                                            Boolean persistent_pebbling);
+extern Pebbling*        resume_ResumableSearch(ResumableSearch *s,unsigned int upper_bound);
+extern void             dispose_ResumableSearch(ResumableSearch *s);
+
+/* Search of the minimum cost between two bounds, by concurrent
+   searches with several bounds. */
+extern Pebbling* bisect_pebbling_strategy(DAG *digraph,
+                                          unsigned int min_bound,
+                                          unsigned int max_bound,
+                                          unsigned int feasible_bound,
+                                          Boolean persistent_pebbling,
+                                          unsigned int threads);
+
+#endif /* SEARCH_H */
@@ -0,0 +1,471 @@
+/*
+   Description::
+
+   Symbolic breadth-first search for a pebbling within a bound.
+
+   A configuration is an assignment to a variable for each vertex,
+   true if the vertex has a black pebble (and another one for the
+   white pebble, in black-white pebbling), and to a variable true if
+   the sink has been pebbled. The variables of a vertex are next to
+   each other, and the one of the sink comes last.
+
+   Each level of the search is the set of configurations at that
+   distance from the initial one, represented by a BDD. The next
+   level is the image of the last one through the moves, minus the
+   configurations already reached. The moves are the ones of
+   next_PebbleConfiguration, without the heuristic cuts: the move on
+   a vertex is unique, so the transition relation is partitioned by
+   vertex and by kind of move. The image of each part is computed on
+   the set of the configurations where the move is legal, by setting
+   the variables of the vertex to their values after the move: there
+   are no variables for the configuration after the move.
+
+   A placement is legal only in the configurations with fewer pebbles
+   than the bound, which are given by a BDD built once, as the one
+   of the predecessors of each vertex.
+
+   The levels are kept, and once one of them has a final
+   configuration a pebbling is found backward: the configuration at
+   each level is one in the level which has a move to the
+   configuration at the next one.
+
+   The configurations do not need the compact representation of the
+   search, so this file is compiled once for each kind of pebbling,
+   for graphs of any size.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+#include "bdd.h"
+#include "symbolic.h"
+#include "search.h"
+
+
+/* Code */
+
+/* State of a vertex, before and after a move */
+#define SYMBOLIC_EMPTY 0
+#define SYMBOLIC_BLACK 1
+#define SYMBOLIC_WHITE 2
+
+typedef struct {
+
+  Vertex   v;
+  BDDNode  condition;     /* Configurations where the move is legal... */
+  uint8_t  from;          /* ...with this state of the vertex */
+  uint8_t  to;
+  Boolean  touch;         /* The move pebbles the sink */
+
+} SymbolicMove;
+
+/* Moves on each vertex, at most */
+#if BLACK_WHITE_PEBBLING
+#define SYMBOLIC_MOVES_PER_VERTEX 4
+#define VARS_PER_VERTEX 2
+#else
+#define SYMBOLIC_MOVES_PER_VERTEX 2
+#define VARS_PER_VERTEX 1
+#endif
+
+#define BLACKVAR(v)   ((uint32_t)(VARS_PER_VERTEX*(v)))
+#define WHITEVAR(v)   ((uint32_t)(VARS_PER_VERTEX*(v)+1))
+
+typedef struct {
+
+  const DAG   *g;
+  BDD         *B;
+  Boolean      persistent_pebbling;
+  uint32_t     touched;       /* Variable of the sink pebbled */
+
+  SymbolicMove *moves;
+  size_t       move_number;
+
+  /* The functions in use, which survive the collections: the final
+     configurations, the reached ones, a function being computed, the
+     conditions of the moves, and the levels. */
+  BDDNode     *roots;
+  size_t       root_number;
+  size_t       capacity;
+  size_t       level_number;
+
+} SymbolicSearch;
+
+#define ROOT_FINAL    0
+#define ROOT_REACHED  1
+#define ROOT_WORK     2
+#define ROOT_MOVES    3
+#define LEVEL(s,l)    ((s)->roots[ROOT_MOVES+(s)->move_number+(l)])
+
+
+/* The literal of `var' with the given value */
+static BDDNode literal(BDD *B,uint32_t var,Boolean value) {
+
+  BDDNode x=varBDD(B,var);
+  return value ? x : notBDD(B,x);
+}
+
+/* Configurations where the vertex is in the given state */
+static BDDNode state_BDD(BDD *B,Vertex v,uint8_t state) {
+
+  BDDNode f=literal(B,BLACKVAR(v),state==SYMBOLIC_BLACK);
+#if BLACK_WHITE_PEBBLING
+  f=andBDD(B,f,literal(B,WHITEVAR(v),state==SYMBOLIC_WHITE));
+#endif
+  return f;
+}
+
+/* The function `f' with the vertex set in the given state */
+static BDDNode setstate_BDD(BDD *B,BDDNode f,Vertex v,uint8_t state) {
+
+  f=cofactorBDD(B,f,BLACKVAR(v),state==SYMBOLIC_BLACK);
+#if BLACK_WHITE_PEBBLING
+  f=cofactorBDD(B,f,WHITEVAR(v),state==SYMBOLIC_WHITE);
+#endif
+  return f;
+}
+
+
+/* Configurations with at most `k' pebbles. The function of the
+   vertices from `v' on for `c' pebbles on the vertices before it is
+   computed from the last vertex to the first one. */
+static BDDNode atmost_BDD(BDD *B,const DAG *g,unsigned int k) {
+
+  BDDNode *f=(BDDNode*)malloc((k+2)*sizeof(BDDNode));
+  BDDNode *h=(BDDNode*)malloc((k+2)*sizeof(BDDNode));
+  assert(f && h);
+
+  for(unsigned int c=0;c<=k;c++) f[c]=BDD_TRUE;
+  f[k+1]=BDD_FALSE;
+  h[k+1]=BDD_FALSE;
+
+  for(Vertex v=g->size;v-- > 0;) {
+    for(unsigned int c=0;c<=k;c++) {
+      BDDNode empty=f[c];
+#if BLACK_WHITE_PEBBLING
+      BDDNode w=varBDD(B,WHITEVAR(v));
+      empty=orBDD(B,andBDD(B,w,f[c+1]),diffBDD(B,f[c],w));
+#endif
+      BDDNode b=varBDD(B,BLACKVAR(v));
+      h[c]=orBDD(B,andBDD(B,b,f[c+1]),diffBDD(B,empty,b));
+    }
+    BDDNode *t=f; f=h; h=t;
+  }
+
+  BDDNode r=f[0];
+  free(f);
+  free(h);
+  return r;
+}
+
+
+/* Configurations with a pebble on each predecessor of `v' */
+static BDDNode active_BDD(BDD *B,const DAG *g,Vertex v) {
+
+  BDDNode f=BDD_TRUE;
+  for(Vertex u=v;u-- > 0;) {
+    if (!GETWORDSBIT(PRED_BITMASK(g,v),u)) continue;
+    BDDNode p=varBDD(B,BLACKVAR(u));
+#if BLACK_WHITE_PEBBLING
+    p=orBDD(B,p,varBDD(B,WHITEVAR(u)));
+#endif
+    f=andBDD(B,f,p);
+  }
+  return f;
+}
+
+
+static void add_move(SymbolicSearch *s,Vertex v,BDDNode condition,
+                     uint8_t from,uint8_t to) {
+
+  assert(s->move_number < SYMBOLIC_MOVES_PER_VERTEX*s->g->size);
+
+  SymbolicMove *m=&s->moves[s->move_number++];
+  m->v = v;
+  m->condition = condition;
+  m->from = from;
+  m->to = to;
+  m->touch = (to!=SYMBOLIC_EMPTY && v==s->g->sinks[0]);
+}
+
+
+static SymbolicSearch *new_SymbolicSearch(const DAG *g,unsigned int upper_bound,
+                                          Boolean persistent_pebbling) {
+
+  assert(upper_bound>0);
+
+  SymbolicSearch *s=(SymbolicSearch*)malloc(sizeof(SymbolicSearch));
+  assert(s);
+
+  s->g = g;
+  s->persistent_pebbling = persistent_pebbling;
+  s->touched = (uint32_t)(VARS_PER_VERTEX*g->size);
+  s->B = newBDD(VARS_PER_VERTEX*g->size+1);
+  BDD *B=s->B;
+
+  /* The moves of next_PebbleConfiguration */
+  s->moves=(SymbolicMove*)malloc(SYMBOLIC_MOVES_PER_VERTEX*g->size*sizeof(SymbolicMove));
+  assert(s->moves);
+  s->move_number=0;
+
+  BDDNode room=atmost_BDD(B,g,upper_bound-1);
+  for(Vertex v=0;v<g->size;v++) {
+    BDDNode active=active_BDD(B,g,v);
+#if BLACK_WHITE_PEBBLING
+    add_move(s,v,BDD_TRUE,SYMBOLIC_BLACK,SYMBOLIC_EMPTY);
+    add_move(s,v,active,SYMBOLIC_WHITE,SYMBOLIC_EMPTY);
+    add_move(s,v,andBDD(B,active,room),SYMBOLIC_EMPTY,SYMBOLIC_BLACK);
+    add_move(s,v,diffBDD(B,room,active),SYMBOLIC_EMPTY,SYMBOLIC_WHITE);
+#elif REVERSIBLE_PEBBLING
+    add_move(s,v,active,SYMBOLIC_BLACK,SYMBOLIC_EMPTY);
+    add_move(s,v,andBDD(B,active,room),SYMBOLIC_EMPTY,SYMBOLIC_BLACK);
+#else
+    add_move(s,v,BDD_TRUE,SYMBOLIC_BLACK,SYMBOLIC_EMPTY);
+    add_move(s,v,andBDD(B,active,room),SYMBOLIC_EMPTY,SYMBOLIC_BLACK);
+#endif
+  }
+
+  s->capacity = ROOT_MOVES+s->move_number+16;
+  s->roots=(BDDNode*)malloc(s->capacity*sizeof(BDDNode));
+  assert(s->roots);
+  for(size_t i=0;i<s->move_number;i++) s->roots[ROOT_MOVES+i]=s->moves[i].condition;
+  s->level_number=0;
+  s->root_number=ROOT_MOVES+s->move_number;
+
+  /* Final configurations, see isfinal_visiting and isfinal_persistent */
+  BDDNode final=BDD_TRUE;
+  for(Vertex v=0;v<g->size;v++) {
+#if BLACK_WHITE_PEBBLING
+    final=diffBDD(B,final,varBDD(B,WHITEVAR(v)));
+#elif REVERSIBLE_PEBBLING
+    if (persistent_pebbling) final=diffBDD(B,final,varBDD(B,BLACKVAR(v)));
+#endif
+  }
+  if (!persistent_pebbling) final=andBDD(B,final,varBDD(B,s->touched));
+#if (!BLACK_WHITE_PEBBLING && !REVERSIBLE_PEBBLING)
+  assert(!persistent_pebbling);
+#endif
+  s->roots[ROOT_FINAL]=final;
+  s->roots[ROOT_REACHED]=BDD_FALSE;
+  s->roots[ROOT_WORK]=BDD_FALSE;
+
+  return s;
+}
+
+
+static void dispose_SymbolicSearch(SymbolicSearch *s) {
+
+  disposeBDD(s->B);
+  free(s->moves);
+  free(s->roots);
+  free(s);
+}
+
+
+static void add_level(SymbolicSearch *s,BDDNode level) {
+
+  if (s->root_number == s->capacity) {
+    s->capacity *= 2;
+    s->roots=(BDDNode*)realloc(s->roots,s->capacity*sizeof(BDDNode));
+    assert(s->roots);
+  }
+  s->roots[s->root_number++]=level;
+  s->level_number++;
+  s->roots[ROOT_REACHED]=orBDD(s->B,s->roots[ROOT_REACHED],level);
+}
+
+
+/* Configurations reached by the move `m' from the ones in `f' */
+static BDDNode image_move(SymbolicSearch *s,const SymbolicMove *m,BDDNode f) {
+
+  BDD *B=s->B;
+
+  f=andBDD(B,f,m->condition);
+  f=andBDD(B,f,state_BDD(B,m->v,m->from));
+  f=setstate_BDD(B,f,m->v,m->from);
+  if (f==BDD_FALSE) return f;
+  if (m->touch) {
+    f=orBDD(B,cofactorBDD(B,f,s->touched,FALSE),cofactorBDD(B,f,s->touched,TRUE));
+    f=andBDD(B,f,varBDD(B,s->touched));
+  }
+  return andBDD(B,f,state_BDD(B,m->v,m->to));
+}
+
+/* Configurations with the move `m' to one in `f' */
+static BDDNode preimage_move(SymbolicSearch *s,const SymbolicMove *m,BDDNode f) {
+
+  BDD *B=s->B;
+
+  f=setstate_BDD(B,f,m->v,m->to);
+  if (m->touch) f=cofactorBDD(B,f,s->touched,TRUE);
+  f=andBDD(B,f,state_BDD(B,m->v,m->from));
+  return andBDD(B,f,m->condition);
+}
+
+
+/* The configurations reached from the last level which are not in
+   any level */
+static BDDNode next_level(SymbolicSearch *s) {
+
+  BDDNode last=LEVEL(s,s->level_number-1);
+
+  s->roots[ROOT_WORK]=BDD_FALSE;
+  for(size_t i=0;i<s->move_number;i++) {
+    BDDNode f=image_move(s,&s->moves[i],last);
+    s->roots[ROOT_WORK]=orBDD(s->B,s->roots[ROOT_WORK],f);
+    collectBDD(s->B,s->roots,s->root_number);
+  }
+  return diffBDD(s->B,s->roots[ROOT_WORK],s->roots[ROOT_REACHED]);
+}
+
+
+static unsigned int pebbles_in(const SymbolicSearch *s,const uint8_t *values) {
+
+  unsigned int c=0;
+  for(uint32_t i=0;i<s->touched;i++) c+=values[i];
+  return c;
+}
+
+/**
+   The pebbling through the levels to the final configuration at the
+   last one, finalized as in bfs.c (see finalize_pebbling,
+   finalize_reversible_pebbling and finalize_persistent_pebbling).
+*/
+static Pebbling *solution_SymbolicSearch(SymbolicSearch *s) {
+
+  BDD *B=s->B;
+  const DAG *g=s->g;
+  size_t d=s->level_number-1;       /* Moves along the path */
+  size_t nvars=B->variables;
+
+  uint8_t *states=(uint8_t*)malloc((d+1)*nvars);
+  Vertex  *moves=(Vertex*)malloc((d+1)*sizeof(Vertex));
+  assert(states && moves);
+
+  Boolean found=satoneBDD(B,andBDD(B,LEVEL(s,d),s->roots[ROOT_FINAL]),states+d*nvars);
+  assert(found);
+
+  int cost=(int)pebbles_in(s,states+d*nvars);
+  for(size_t l=d;l-- > 0;) {
+    BDDNode next=cubeBDD(B,states+(l+1)*nvars);
+    found=FALSE;
+    for(size_t i=0;i<s->move_number && !found;i++) {
+      BDDNode f=andBDD(B,preimage_move(s,&s->moves[i],next),LEVEL(s,l));
+      found=satoneBDD(B,f,states+l*nvars);
+      moves[l]=s->moves[i].v;
+    }
+    assert(found);
+    cost=MAX(cost,(int)pebbles_in(s,states+l*nvars));
+  }
+
+  /* Black pebbles left in the final configuration */
+  const uint8_t *last=states+d*nvars;
+  size_t left=0;
+  for(Vertex v=0;v<g->size;v++) if (last[BLACKVAR(v)]) left++;
+
+  Pebbling *solution=NULL;
+  size_t i=0;
+
+  if (s->persistent_pebbling) {
+
+#if BLACK_WHITE_PEBBLING
+    solution=new_Pebbling(d+left);
+    solution->length=d+left;
+    for(Vertex v=0;v<g->size;v++) if (last[BLACKVAR(v)]) solution->steps[i++]=v;
+#else
+    solution=new_Pebbling(d);
+    solution->length=d;
+#endif
+    for(size_t l=d;l-- > 0;) solution->steps[i++]=moves[l];
+    assert(i==solution->length);
+
+  } else {
+
+#if REVERSIBLE_PEBBLING
+    solution=new_Pebbling(2*d);
+    solution->length=2*d;
+    for(size_t l=0;l<d;l++) {
+      solution->steps[l]=moves[l];
+      solution->steps[2*d-1-l]=moves[l];
+    }
+#else
+    solution=new_Pebbling(d+left);
+    solution->length=d+left;
+    for(size_t l=0;l<d;l++) solution->steps[l]=moves[l];
+    i=d+left;
+    for(Vertex v=0;v<g->size;v++) if (last[BLACKVAR(v)]) solution->steps[--i]=v;
+    assert(i==d);
+#endif
+  }
+  solution->cost=cost;
+
+  free(states);
+  free(moves);
+  return solution;
+}
+
+
+/**
+   Same as bfs_pebbling_strategy, with the levels of the search
+   represented by BDDs. The pebbling found is a shortest one within
+   the bound, but it may differ from the one of the search on the
+   configurations, which skips some moves by its heuristics.
+
+   @return a pebbling if exists, NULL otherwise.
+*/
+Pebbling *symbolic_pebbling_strategy(DAG *g,
+                                     unsigned int upper_bound,
+                                     Boolean persistent_pebbling) {
+
+  assert(isconsistent_DAG(g));
+
+  if (upper_bound < 1) { return NULL; } /* No pebbling with zero pebbles */
+
+  check_single_sink(g);
+
+  SymbolicSearch *s=new_SymbolicSearch(g,upper_bound,persistent_pebbling);
+  BDD *B=s->B;
+
+  /* The initial configuration, see init_persistent_pebbling */
+  uint8_t *values=(uint8_t*)calloc(B->variables,sizeof(uint8_t));
+  assert(values);
+  if (persistent_pebbling) {
+#if BLACK_WHITE_PEBBLING
+    values[WHITEVAR(g->sinks[0])]=1;
+#else
+    values[BLACKVAR(g->sinks[0])]=1;
+#endif
+    values[s->touched]=1;
+  }
+  add_level(s,cubeBDD(B,values));
+  free(values);
+
+  BDDNode level=LEVEL(s,0);
+  assert(andBDD(B,level,s->roots[ROOT_FINAL])==BDD_FALSE);
+  while (andBDD(B,level,s->roots[ROOT_FINAL])==BDD_FALSE) {
+    level=next_level(s);
+    if (level==BDD_FALSE) break;
+    add_level(s,level);
+  }
+
+  Pebbling *solution=NULL;
+  if (level!=BDD_FALSE) solution=solution_SymbolicSearch(s);
+
+  printf("c Visited %.0f configurations in %lu levels: "
+         "%lu nodes in the BDD of the visited ones (%lu bytes, at most %lu nodes)\n",
+         satcountBDD(B,s->roots[ROOT_REACHED]),
+         (unsigned long)s->level_number,
+         (unsigned long)nodecountBDD(B,s->roots[ROOT_REACHED]),
+         (unsigned long)memoryBDD(B),
+         (unsigned long)B->peak);
+
+  dispose_SymbolicSearch(s);
+  return solution;
+}
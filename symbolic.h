@@ -0,0 +1,26 @@
+/*
+   Description::
+
+   Symbolic breadth-first search for a pebbling within a bound: each
+   level of the search is a set of configurations, represented by a
+   binary decision diagram (see bdd.h) instead of being listed.
+
+*/
+
+
+/* Preamble */
+#ifndef  SYMBOLIC_H
+#define  SYMBOLIC_H
+
+#include "common.h"
+#include "dag.h"
+#include "pebbling.h"
+
+
+/* Code */
+
+extern Pebbling* symbolic_pebbling_strategy(DAG *digraph,
+                                            unsigned int upper_bound,
+                                            Boolean persistent_pebbling);
+
+#endif /* SYMBOLIC_H */
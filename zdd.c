@@ -0,0 +1,343 @@
+/*
+   Description::
+
+   Zero-suppressed decision diagrams.
+
+   The nodes are kept in a single array, and they are addressed by
+   their index, which never changes: the array may be reallocated
+   when it grows. A node is created only if there is no node with the
+   same item and children (see get_nodeZDD), so two families are equal
+   if and only if they have the same root.
+
+   The nodes are not reference counted. Each insertion creates a new
+   path to the root and leaves the old one behind, so the nodes which
+   are not reachable from the families in use are freed from time to
+   time by a mark and sweep collection (see collectZDD), and they are
+   reused before the array grows.
+
+*/
+
+/* Preamble */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "common.h"
+#include "zdd.h"
+
+
+/* Code */
+
+#define ZDD_TERMINAL  0x7FFFFFFFU    /* Item of the terminal nodes */
+#define ZDD_FREE      0xFFFFFFFFU    /* Item of the free nodes */
+#define ZDD_MARK      0x80000000U    /* Nodes reached by a collection */
+
+/* End of a bucket and of the free list: the empty family is never
+   in either. */
+#define ZDD_NONE      ZDD_EMPTY
+
+static inline size_t hashZDD(uint32_t item,ZDDNode lo,ZDDNode hi) {
+  uint64_t h = (uint64_t)item * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)lo * 0xC2B2AE3D27D4EB4FULL;
+  h ^= (uint64_t)hi * 0x165667B19E3779F9ULL;
+  return (size_t)(h ^ (h >> 29));
+}
+
+static inline Boolean isterminalZDD(ZDDNode f) {
+  return f==ZDD_EMPTY || f==ZDD_BASE;
+}
+
+
+/* Put all the nodes in use in the unique table again, e.g. after it
+   has been resized. */
+static void rehashZDD(ZDD *z) {
+
+  for(size_t i=0;i<z->bucket_number;i++) z->buckets[i]=ZDD_NONE;
+
+  for(size_t i=2;i<z->used;i++) {
+    ZDDEntry *e=&z->nodes[i];
+    if (e->item==ZDD_FREE) continue;
+    size_t b=hashZDD(e->item,e->lo,e->hi) & (z->bucket_number-1);
+    e->next = z->buckets[b];
+    z->buckets[b] = (ZDDNode)i;
+  }
+}
+
+
+ZDD *newZDD(void) {
+
+  ZDD *z=(ZDD*)malloc(sizeof(ZDD));
+  assert(z);
+
+  z->allocation = ZDD_MIN_ALLOCATION;
+  z->nodes = (ZDDEntry*)malloc(z->allocation*sizeof(ZDDEntry));
+  assert(z->nodes);
+
+  /* The two terminals */
+  for(size_t i=0;i<2;i++) {
+    z->nodes[i].item = ZDD_TERMINAL;
+    z->nodes[i].lo   = ZDD_EMPTY;
+    z->nodes[i].hi   = ZDD_EMPTY;
+    z->nodes[i].next = ZDD_NONE;
+  }
+  z->used = 2;
+  z->size = 2;
+  z->peak = 2;
+  z->free_list = ZDD_NONE;
+
+  z->bucket_number = ZDD_MIN_ALLOCATION;
+  z->buckets = (ZDDNode*)malloc(z->bucket_number*sizeof(ZDDNode));
+  assert(z->buckets);
+  rehashZDD(z);
+
+  z->cache = (ZDDCacheEntry*)calloc(z->bucket_number,sizeof(ZDDCacheEntry));
+  assert(z->cache);
+
+  z->collect_threshold = ZDD_MIN_ALLOCATION;
+
+  return z;
+}
+
+
+void disposeZDD(ZDD *z) {
+
+  assert(z);
+  free(z->cache);
+  free(z->buckets);
+  free(z->nodes);
+  free(z);
+}
+
+
+Boolean isconsistentZDD(const ZDD *z) {
+
+  assert(z);
+  assert(z->nodes);
+  assert(z->buckets);
+  assert(z->size <= z->used);
+  assert(z->used <= z->allocation);
+  assert((z->bucket_number & (z->bucket_number-1))==0);
+
+#ifdef ZDD_DEBUG
+  size_t counter=2;
+  for(size_t i=2;i<z->used;i++) {
+    const ZDDEntry *e=&z->nodes[i];
+    if (e->item==ZDD_FREE) continue;
+    counter++;
+    /* No zero-suppressed node, and the items grow from the root */
+    if (e->hi==ZDD_EMPTY) return FALSE;
+    if (e->item >= z->nodes[e->lo].item) return FALSE;
+    if (e->item >= z->nodes[e->hi].item) return FALSE;
+  }
+  if (counter!=z->size) return FALSE;
+#endif
+  return TRUE;
+}
+
+
+/* The node with the given item and children, which is created if
+   there is none. The array of nodes may move. */
+static ZDDNode get_nodeZDD(ZDD *z,uint32_t item,ZDDNode lo,ZDDNode hi) {
+
+  assert(item < ZDD_TERMINAL);
+  assert(item < z->nodes[lo].item);
+  assert(item < z->nodes[hi].item);
+
+  /* Zero suppression: the item is in no set */
+  if (hi==ZDD_EMPTY) return lo;
+
+  size_t b=hashZDD(item,lo,hi) & (z->bucket_number-1);
+  for(ZDDNode f=z->buckets[b]; f!=ZDD_NONE; f=z->nodes[f].next) {
+    const ZDDEntry *e=&z->nodes[f];
+    if (e->item==item && e->lo==lo && e->hi==hi) return f;
+  }
+
+  ZDDNode f;
+  if (z->free_list!=ZDD_NONE) {
+    f = z->free_list;
+    z->free_list = z->nodes[f].next;
+  } else {
+    if (z->used == z->allocation) {
+      if (z->allocation >= ZDD_TERMINAL) {
+        fprintf(stderr,
+                "Error in search procedure: too many nodes "
+                "for the decision diagram.");
+        exit(EXIT_FAILURE);
+      }
+      z->allocation *= 2;
+      z->nodes = (ZDDEntry*)realloc(z->nodes,z->allocation*sizeof(ZDDEntry));
+      assert(z->nodes);
+    }
+    f = (ZDDNode)(z->used++);
+  }
+
+  z->nodes[f].item = item;
+  z->nodes[f].lo   = lo;
+  z->nodes[f].hi   = hi;
+  z->nodes[f].next = z->buckets[b];
+  z->buckets[b] = f;
+
+  z->size++;
+  z->peak = MAX(z->peak,z->size);
+
+  /* Keep the buckets short, and the cache as large */
+  if (z->size > 2*z->bucket_number) {
+    z->bucket_number *= 2;
+    z->buckets = (ZDDNode*)realloc(z->buckets,z->bucket_number*sizeof(ZDDNode));
+    assert(z->buckets);
+    rehashZDD(z);
+    free(z->cache);
+    z->cache = (ZDDCacheEntry*)calloc(z->bucket_number,sizeof(ZDDCacheEntry));
+    assert(z->cache);
+  }
+
+  return f;
+}
+
+
+/* The sets are added one at a time, so the path of the new set is
+   followed from the root, and the nodes along it are replaced. */
+ZDDNode insertZDD(ZDD *z,ZDDNode f,const uint32_t *items,size_t n) {
+
+  assert(isconsistentZDD(z));
+  assert(n==0 || items[0] < ZDD_TERMINAL);
+  assert(n<2 || items[0] < items[1]);
+
+  ZDDEntry e=z->nodes[f];   /* A copy, since the array may move */
+
+  if (n==0) {
+    /* The empty set is at the end of the `lo' path */
+    if (isterminalZDD(f)) return ZDD_BASE;
+    return get_nodeZDD(z,e.item,insertZDD(z,e.lo,items,0),e.hi);
+  }
+
+  if (items[0] < e.item) {
+    return get_nodeZDD(z,items[0],f,insertZDD(z,ZDD_EMPTY,items+1,n-1));
+  }
+  if (items[0] == e.item) {
+    return get_nodeZDD(z,e.item,e.lo,insertZDD(z,e.hi,items+1,n-1));
+  }
+  return get_nodeZDD(z,e.item,insertZDD(z,e.lo,items,n),e.hi);
+}
+
+
+Boolean memberZDD(const ZDD *z,ZDDNode f,const uint32_t *items,size_t n) {
+
+  assert(isconsistentZDD(z));
+
+  size_t i=0;
+  while(!isterminalZDD(f)) {
+    const ZDDEntry *e=&z->nodes[f];
+    if (i<n && items[i]==e->item) { f=e->hi; i++; continue; }
+    if (i<n && items[i] <e->item) return FALSE;
+    f=e->lo;
+  }
+  return (i==n && f==ZDD_BASE);
+}
+
+
+ZDDNode unionZDD(ZDD *z,ZDDNode f,ZDDNode g) {
+
+  assert(isconsistentZDD(z));
+
+  if (f==ZDD_EMPTY) return g;
+  if (g==ZDD_EMPTY || f==g) return f;
+
+  /* The union commutes */
+  if (f > g) { ZDDNode t=f; f=g; g=t; }
+
+  ZDDCacheEntry *c=&z->cache[hashZDD(0,f,g) & (z->bucket_number-1)];
+  if (c->a==f && c->b==g) return c->result;
+
+  ZDDEntry ef=z->nodes[f];
+  ZDDEntry eg=z->nodes[g];
+  ZDDNode  r;
+
+  if (ef.item < eg.item) {
+    r=get_nodeZDD(z,ef.item,unionZDD(z,ef.lo,g),ef.hi);
+  } else if (ef.item > eg.item) {
+    r=get_nodeZDD(z,eg.item,unionZDD(z,f,eg.lo),eg.hi);
+  } else {
+    ZDDNode lo=unionZDD(z,ef.lo,eg.lo);
+    ZDDNode hi=unionZDD(z,ef.hi,eg.hi);
+    r=get_nodeZDD(z,ef.item,lo,hi);
+  }
+
+  /* The recursive calls may have replaced the entry */
+  c=&z->cache[hashZDD(0,f,g) & (z->bucket_number-1)];
+  c->a=f;
+  c->b=g;
+  c->result=r;
+  return r;
+}
+
+
+/* Mark the nodes of the diagram of `f', and count the new ones */
+static size_t markZDD(ZDD *z,ZDDNode f) {
+
+  if (isterminalZDD(f)) return 0;
+  if (z->nodes[f].item & ZDD_MARK) return 0;
+  z->nodes[f].item |= ZDD_MARK;
+  return 1 + markZDD(z,z->nodes[f].lo) + markZDD(z,z->nodes[f].hi);
+}
+
+static void unmarkZDD(ZDD *z,ZDDNode f) {
+
+  if (isterminalZDD(f)) return;
+  if (!(z->nodes[f].item & ZDD_MARK)) return;
+  z->nodes[f].item &= ~ZDD_MARK;
+  unmarkZDD(z,z->nodes[f].lo);
+  unmarkZDD(z,z->nodes[f].hi);
+}
+
+
+size_t nodecountZDD(ZDD *z,ZDDNode f) {
+
+  assert(isconsistentZDD(z));
+
+  size_t count=markZDD(z,f);
+  unmarkZDD(z,f);
+  return count+2;
+}
+
+
+void collectZDD(ZDD *z,const ZDDNode *roots,size_t n) {
+
+  assert(isconsistentZDD(z));
+
+  if (z->size < z->collect_threshold) return;
+
+  for(size_t i=0;i<n;i++) markZDD(z,roots[i]);
+
+  /* Sweep: the free nodes have the mark as well, but their item is
+     ZDD_FREE */
+  z->free_list = ZDD_NONE;
+  z->size = 2;
+  for(size_t i=z->used;i-- > 2;) {
+    ZDDEntry *e=&z->nodes[i];
+    if (e->item!=ZDD_FREE && (e->item & ZDD_MARK)) {
+      e->item &= ~ZDD_MARK;
+      z->size++;
+    } else {
+      e->item = ZDD_FREE;
+      e->next = z->free_list;
+      z->free_list = (ZDDNode)i;
+    }
+  }
+  rehashZDD(z);
+
+  /* The cached results may have been freed */
+  memset(z->cache,0,z->bucket_number*sizeof(ZDDCacheEntry));
+
+  z->collect_threshold = MAX(2*z->size,ZDD_MIN_ALLOCATION);
+  assert(isconsistentZDD(z));
+}
+
+
+size_t memoryZDD(const ZDD *z) {
+
+  assert(z);
+  return z->allocation*sizeof(ZDDEntry)
+    + z->bucket_number*(sizeof(ZDDNode)+sizeof(ZDDCacheEntry));
+}
@@ -0,0 +1,100 @@
+/*
+   Description::
+
+   Zero-suppressed decision diagrams, for families of sets of
+   items. A family of pebble configurations with few pebbles shares
+   most of its structure, and its diagram may be much smaller than a
+   dictionary of the configurations.
+
+*/
+
+
+/* Preamble */
+#ifndef  ZDD_H
+#define  ZDD_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "common.h"
+
+
+/* Code */
+
+/* A family is given by the index of the root of its diagram. The
+   two terminal nodes are the empty family and the family of the
+   empty set. The items are numbered from 0, and they are tested
+   from the root in increasing order. */
+typedef uint32_t ZDDNode;
+
+#define ZDD_EMPTY  ((ZDDNode)0)
+#define ZDD_BASE   ((ZDDNode)1)
+
+/* Each node tests an item: the sets without it are in `lo', the
+   sets with it (with the item removed) are in `hi', which is never
+   the empty family. Nodes are shared through a unique table of
+   chained buckets. */
+typedef struct {
+
+  uint32_t item;      /* Or a mark of the terminal and free nodes */
+  ZDDNode  lo;
+  ZDDNode  hi;
+  ZDDNode  next;      /* Next node of the bucket, or of the free list */
+
+} ZDDEntry;
+
+/* The unions already computed are kept in a cache, which may forget
+   them. It has as many entries as the unique table has buckets. */
+typedef struct {
+  ZDDNode a,b,result;
+} ZDDCacheEntry;
+
+typedef struct {
+
+  ZDDEntry *nodes;
+  size_t    allocation;     /* Room in the array of nodes */
+  size_t    used;           /* Nodes ever allocated in the array */
+  size_t    size;           /* Nodes in use, terminals included */
+  size_t    peak;           /* Largest size so far */
+  ZDDNode   free_list;
+
+  ZDDNode  *buckets;        /* Unique table */
+  size_t    bucket_number;  /* A power of two */
+
+  ZDDCacheEntry *cache;     /* Cache of the unions */
+
+  size_t    collect_threshold;
+
+} ZDD;
+
+/* The arrays of the diagram start at ZDD_MIN_ALLOCATION nodes. The
+   unused nodes are freed once there are twice as many nodes as the
+   ones left by the last collection, and at least ZDD_MIN_ALLOCATION. */
+#define ZDD_MIN_ALLOCATION  (0x1UL << 12)
+
+extern ZDD *newZDD(void);
+extern void disposeZDD(ZDD *z);
+
+extern Boolean isconsistentZDD(const ZDD *z);
+
+/* The family `f' with the set of `n' items, given in increasing
+   order, added to it */
+extern ZDDNode insertZDD(ZDD *z,ZDDNode f,const uint32_t *items,size_t n);
+
+/* Is the set of `n' items, given in increasing order, in the family
+   `f'? */
+extern Boolean memberZDD(const ZDD *z,ZDDNode f,const uint32_t *items,size_t n);
+
+extern ZDDNode unionZDD(ZDD *z,ZDDNode f,ZDDNode g);
+
+/* Number of nodes of the diagram of `f', terminals included */
+extern size_t nodecountZDD(ZDD *z,ZDDNode f);
+
+/* Free the nodes which are not in the diagrams of the `n' families
+   in `roots', if the diagram has grown enough since the last
+   collection. Other families must not be used afterwards. */
+extern void collectZDD(ZDD *z,const ZDDNode *roots,size_t n);
+
+/* Bytes of memory held by the diagrams */
+extern size_t memoryZDD(const ZDD *z);
+
+#endif /* ZDD_H */